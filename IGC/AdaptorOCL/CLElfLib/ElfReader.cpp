@@ -27,6 +27,15 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ElfReader.h"
 #include <string.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace CLElfLib
 {
 
@@ -56,6 +65,9 @@ CElfReader::CElfReader(
     m_nameTableSize = 0;
     m_pElfHeader = (SElf64Header*)pElfBinary;
     m_pBinary = pElfBinary;
+    m_pMapping = NULL;
+    m_mappingSize = 0;
+    m_sectionNameIndexBuilt = false;
 
     // get a pointer to the string table
     if( m_pElfHeader )
@@ -71,6 +83,15 @@ CElfReader::CElfReader(
 \******************************************************************************/
 CElfReader::~CElfReader()
 {
+    if( m_pMapping )
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile( m_pMapping );
+#else
+        munmap( m_pMapping, m_mappingSize );
+#endif
+        m_pMapping = NULL;
+    }
 }
 
 /******************************************************************************\
@@ -90,6 +111,81 @@ CElfReader* CElfReader::Create(
     return pNewReader;
 }
 
+/******************************************************************************\
+ Member Function: CElfReader::CreateFromFile
+\******************************************************************************/
+CElfReader* CElfReader::CreateFromFile(
+    const char* pFileName )
+{
+    CElfReader* pNewReader = NULL;
+    void* pMapping = NULL;
+    size_t mappingSize = 0;
+
+    if( pFileName == NULL )
+    {
+        return NULL;
+    }
+
+#if defined(_WIN32)
+    HANDLE hFile = CreateFileA( pFileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( hFile != INVALID_HANDLE_VALUE )
+    {
+        LARGE_INTEGER fileSize;
+        if( GetFileSizeEx( hFile, &fileSize ) && fileSize.QuadPart > 0 )
+        {
+            HANDLE hMapping = CreateFileMappingA( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+            if( hMapping != NULL )
+            {
+                pMapping = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+                mappingSize = (size_t)fileSize.QuadPart;
+                // the view keeps the mapping object alive
+                CloseHandle( hMapping );
+            }
+        }
+        CloseHandle( hFile );
+    }
+#else
+    int fd = open( pFileName, O_RDONLY );
+    if( fd >= 0 )
+    {
+        struct stat fileStat;
+        if( fstat( fd, &fileStat ) == 0 && fileStat.st_size > 0 )
+        {
+            mappingSize = (size_t)fileStat.st_size;
+            pMapping = mmap( NULL, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if( pMapping == MAP_FAILED )
+            {
+                pMapping = NULL;
+            }
+        }
+        // the mapping stays valid after the descriptor is closed
+        close( fd );
+    }
+#endif
+
+    if( pMapping )
+    {
+        pNewReader = Create( (const char*)pMapping, mappingSize );
+
+        if( pNewReader )
+        {
+            pNewReader->m_pMapping = pMapping;
+            pNewReader->m_mappingSize = mappingSize;
+        }
+        else
+        {
+#if defined(_WIN32)
+            UnmapViewOfFile( pMapping );
+#else
+            munmap( pMapping, mappingSize );
+#endif
+        }
+    }
+
+    return pNewReader;
+}
+
 /******************************************************************************\
  Member Function: CElfReader::Delete
 \******************************************************************************/
@@ -268,23 +364,156 @@ E_RETVAL CElfReader::GetSectionData(
     size_t &dataSize )
 {
     E_RETVAL retVal = FAILURE;
-    const char* pSectionName = NULL;
+    unsigned int sectionIndex = 0;
+
+    if( GetSectionIndex( pName, sectionIndex ) == SUCCESS )
+    {
+        retVal = GetSectionData( sectionIndex, pData, dataSize );
+    }
+
+    return retVal;
+}
+
+/******************************************************************************\
+ Member Function: BuildSectionNameIndex
+ Description:     Hashes all section names once so that lookups by name do
+                  not walk the section headers
+\******************************************************************************/
+void CElfReader::BuildSectionNameIndex()
+{
+    m_sectionNameIndexBuilt = true;
+
+    if( m_pElfHeader == NULL )
+    {
+        return;
+    }
+
+    m_sectionNameIndex.reserve( m_pElfHeader->NumSectionHeaderEntries );
 
     for( unsigned int i = 1; i < m_pElfHeader->NumSectionHeaderEntries; i++ )
     {
-        pSectionName = GetSectionName( i );
+        const char* pSectionName = GetSectionName( i );
 
-        if( pSectionName && ( strcmp( pName, pSectionName ) == 0 ) )
+        if( pSectionName )
         {
-            GetSectionData( i, pData, dataSize );
-            retVal = SUCCESS;
-            break;
+            // keep the first section with a given name, matching the
+            // previous linear search
+            m_sectionNameIndex.insert( std::make_pair( std::string( pSectionName ), i ) );
         }
     }
+}
+
+/******************************************************************************\
+ Member Function: GetSectionIndex
+ Description:     Returns the index of the section with the given name
+\******************************************************************************/
+E_RETVAL CElfReader::GetSectionIndex(
+    const char* pName,
+    unsigned int &sectionIndex )
+{
+    E_RETVAL retVal = FAILURE;
+
+    if( pName == NULL )
+    {
+        return retVal;
+    }
+
+    if( !m_sectionNameIndexBuilt )
+    {
+        BuildSectionNameIndex();
+    }
+
+    auto it = m_sectionNameIndex.find( pName );
+    if( it != m_sectionNameIndex.end() )
+    {
+        sectionIndex = it->second;
+        retVal = SUCCESS;
+    }
 
     return retVal;
 }
 
+/******************************************************************************\
+ Member Function: GetSectionView
+ Description:     Returns a non-owning view of the requested section's data
+\******************************************************************************/
+SElfSectionView CElfReader::GetSectionView(
+    unsigned int sectionIndex )
+{
+    const SElf64SectionHeader* pSectionHeader = GetSectionHeader( sectionIndex );
+
+    if( pSectionHeader )
+    {
+        return SElfSectionView(
+            m_pBinary + pSectionHeader->DataOffset,
+            (size_t)pSectionHeader->DataSize );
+    }
+
+    return SElfSectionView();
+}
+
+/******************************************************************************\
+ Member Function: IndexSymbolSection
+ Description:     Adds the records of a symbol section to symbolIndex
+\******************************************************************************/
+E_RETVAL CElfReader::IndexSymbolSection(
+    unsigned int sectionIndex,
+    std::unordered_map<std::string, unsigned int> &symbolIndex )
+{
+    SElfSectionView view = GetSectionView( sectionIndex );
+
+    if( view.pData == NULL )
+    {
+        return FAILURE;
+    }
+
+    const unsigned char* pData = (const unsigned char*)view.pData;
+    size_t i = 0;
+
+    while( i + 2 <= view.DataSize )
+    {
+        size_t nameSize = (size_t)pData[i] | ( (size_t)pData[i + 1] << 8 );
+
+        if( i + 4 + nameSize > view.DataSize )
+        {
+            return FAILURE;
+        }
+
+        unsigned int symbolSection =
+            (unsigned int)pData[i + 2 + nameSize] |
+            ( (unsigned int)pData[i + 3 + nameSize] << 8 );
+
+        symbolIndex[std::string( view.pData + i + 2, nameSize )] = symbolSection;
+
+        i += 4 + nameSize;
+    }
+
+    return SUCCESS;
+}
+
+/******************************************************************************\
+ Member Function: GetSymbolSectionIndex
+ Description:     Returns the section holding the symbol or 0 if unknown
+\******************************************************************************/
+unsigned int CElfReader::GetSymbolSectionIndex(
+    unsigned int symbolSection,
+    const char* pSymbolName,
+    size_t symbolNameSize )
+{
+    auto indexIt = m_symbolIndices.find( symbolSection );
+
+    if( indexIt == m_symbolIndices.end() )
+    {
+        indexIt = m_symbolIndices.emplace( symbolSection,
+            std::unordered_map<std::string, unsigned int>() ).first;
+        IndexSymbolSection( symbolSection, indexIt->second );
+    }
+
+    auto it = indexIt->second.find( std::string( pSymbolName, symbolNameSize ) );
+
+    return ( it != indexIt->second.end() ) ? it->second : 0;
+}
+
 /******************************************************************************\
  Member Function: GetSectionName
  Description:     Returns a pointer to a NULL terminated string
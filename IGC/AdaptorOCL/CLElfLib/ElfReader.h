@@ -26,6 +26,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 #include "CLElfTypes.h"
+#include <string>
+#include <unordered_map>
 
 #if defined(_WIN32) && (__KLOCWORK__ == 0)
   #define ELF_CALL __stdcall
@@ -35,6 +37,24 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace CLElfLib
 {
+/******************************************************************************\
+
+ Struct:        SElfSectionView
+
+ Description:   Non-owning view of a section's contents inside the ELF image.
+
+\******************************************************************************/
+struct SElfSectionView
+{
+    const char* pData;
+    size_t      DataSize;
+
+    SElfSectionView() : pData( NULL ), DataSize( 0 ) {}
+    SElfSectionView( const char* data, size_t size ) : pData( data ), DataSize( size ) {}
+
+    bool empty() const { return DataSize == 0; }
+};
+
 /******************************************************************************\
 
  Class:         CElfReader
@@ -47,10 +67,17 @@ namespace CLElfLib
 class CElfReader
 {
 public:
+    // Borrows pElfBinary without copying it; the buffer must outlive the
+    // reader.
     static CElfReader* ELF_CALL Create(
         const char* pElfBinary,
         const size_t elfBinarySize );
 
+    // Maps the file read-only into memory and reads the ELF from the
+    // mapping. The mapping is released when the reader is deleted.
+    static CElfReader* ELF_CALL CreateFromFile(
+        const char* pFileName );
+
     static void ELF_CALL Delete(
         CElfReader* &pElfObject );
 
@@ -76,6 +103,24 @@ public:
         char* &pData,
         size_t &dataSize );
 
+    // Looks a section up by name through a hash index built on first use.
+    E_RETVAL ELF_CALL GetSectionIndex(
+        const char* sectionName,
+        unsigned int &sectionIndex );
+
+    SElfSectionView ELF_CALL GetSectionView(
+        unsigned int sectionIndex );
+
+    // Returns the section index the symbol section `symbolSection` records
+    // for the symbol, or 0 if it has none. A symbol section is a sequence of
+    // { uint16 nameSize, char name[nameSize], uint16 sectionIndex } records,
+    // as emitted by ElfPackager for the builtin libraries. Each symbol
+    // section is hashed on its first query and kept for the reader's life.
+    unsigned int ELF_CALL GetSymbolSectionIndex(
+        unsigned int symbolSection,
+        const char* pSymbolName,
+        size_t symbolNameSize );
+
 protected:
     ELF_CALL CElfReader(
         const char* pElfBinary,
@@ -83,10 +128,24 @@ protected:
 
     ELF_CALL ~CElfReader();
 
+    void ELF_CALL BuildSectionNameIndex();
+
+    E_RETVAL ELF_CALL IndexSymbolSection(
+        unsigned int sectionIndex,
+        std::unordered_map<std::string, unsigned int> &symbolIndex );
+
     SElf64Header*  m_pElfHeader;    // pointer to the ELF header
     const char*    m_pBinary;       // portable ELF binary
     char*          m_pNameTable;    // pointer to the string table
     size_t         m_nameTableSize; // size of string table in bytes
+
+    void*          m_pMapping;      // file mapping owned by the reader, if any
+    size_t         m_mappingSize;   // size of the file mapping in bytes
+
+    bool                                          m_sectionNameIndexBuilt;
+    std::unordered_map<std::string, unsigned int> m_sectionNameIndex;
+    std::unordered_map<unsigned int,
+        std::unordered_map<std::string, unsigned int>> m_symbolIndices;
 };
 
 /******************************************************************************\
@@ -60,16 +60,25 @@ CElfWriter::~CElfWriter()
         m_nodeQueue.pop();
 
         // delete the node and it's data
-        if( pNode )
-        {
-            if( pNode->pData )
-            {
-                delete[] pNode->pData;
-                pNode->pData = NULL;
-            }
+        DeleteNode( pNode );
+    }
+}
 
-            delete pNode;
+/******************************************************************************\
+ Member Function: CElfWriter::DeleteNode
+\******************************************************************************/
+void CElfWriter::DeleteNode(
+    SSectionNode* pNode )
+{
+    if( pNode )
+    {
+        if( pNode->pData && pNode->OwnsData )
+        {
+            delete[] pNode->pData;
         }
+        pNode->pData = NULL;
+
+        delete pNode;
     }
 }
 
@@ -110,6 +119,25 @@ void CElfWriter::Delete(
 \******************************************************************************/
 E_RETVAL CElfWriter::AddSection(
     SSectionNode* pSectionNode )
+{
+    return AddSectionNode( pSectionNode, true );
+}
+
+/******************************************************************************\
+ Member Function: CElfWriter::AddSectionReference
+\******************************************************************************/
+E_RETVAL CElfWriter::AddSectionReference(
+    SSectionNode* pSectionNode )
+{
+    return AddSectionNode( pSectionNode, false );
+}
+
+/******************************************************************************\
+ Member Function: CElfWriter::AddSectionNode
+\******************************************************************************/
+E_RETVAL CElfWriter::AddSectionNode(
+    SSectionNode* pSectionNode,
+    bool copyData )
 {
     E_RETVAL retVal = SUCCESS;
     SSectionNode* pNode = NULL;
@@ -135,6 +163,7 @@ E_RETVAL CElfWriter::AddSection(
     {
         pNode->Flags = pSectionNode->Flags;
         pNode->Type  = pSectionNode->Type;
+        pNode->OwnsData = copyData;
 
         nameSize = pSectionNode->Name.size() + 1;
         dataSize = pSectionNode->DataSize;
@@ -144,16 +173,31 @@ E_RETVAL CElfWriter::AddSection(
         // ok to have NULL data
         if( dataSize > 0 )
         {
-            pNode->pData = new char[dataSize];
+            if( copyData )
+            {
+                pNode->pData = new char[dataSize];
 
-            if( pNode->pData )
+                if( pNode->pData )
+                {
+                    memcpy_s( pNode->pData, dataSize, pSectionNode->pData, dataSize );
+                }
+                else
+                {
+                    retVal = OUT_OF_MEMORY;
+                }
+            }
+            else if( pSectionNode->pData )
             {
-                memcpy_s( pNode->pData, dataSize, pSectionNode->pData, dataSize );
-                pNode->DataSize = dataSize;
+                pNode->pData = pSectionNode->pData;
             }
             else
             {
-                retVal = OUT_OF_MEMORY;
+                retVal = FAILURE;
+            }
+
+            if( retVal == SUCCESS )
+            {
+                pNode->DataSize = dataSize;
             }
         }
 
@@ -170,22 +214,25 @@ E_RETVAL CElfWriter::AddSection(
         else
         {
             // cleanup allocations
-            if( pNode )
-            {
-                if( pNode->pData )
-                {
-                    delete[] pNode->pData;
-                    pNode->pData = NULL;
-                }
-
-                delete pNode;
-            }
+            DeleteNode( pNode );
         }
     }
 
     return retVal;
 }
 
+/******************************************************************************\
+ Member Function: CElfWriter::GetBinarySize
+\******************************************************************************/
+size_t CElfWriter::GetBinarySize() const
+{
+    return
+        sizeof( SElf64Header ) +
+        ( ( m_numSections + 1 ) * sizeof( SElf64SectionHeader ) ) + // +1 to account for string table entry
+        m_dataSize +
+        m_stringTableSize;
+}
+
 /******************************************************************************\
  Member Function: CElfWriter::ResolveBinary
 \******************************************************************************/
@@ -200,11 +247,7 @@ E_RETVAL CElfWriter::ResolveBinary(
     char* pStringTable = NULL;
     char* pCurString = NULL;
 
-    m_totalBinarySize =
-        sizeof( SElf64Header ) +
-        ( ( m_numSections + 1 ) * sizeof( SElf64SectionHeader ) ) + // +1 to account for string table entry
-        m_dataSize +
-        m_stringTableSize;
+    m_totalBinarySize = GetBinarySize();
 
     if( pBinary )
     {
@@ -244,8 +287,11 @@ E_RETVAL CElfWriter::ResolveBinary(
                     (unsigned char*)pCurSectionHeader + sizeof( SElf64SectionHeader ) );
 
                 // copy the data, move the data pointer
-                memcpy_s( pData, pNode->DataSize, pNode->pData, pNode->DataSize );
-                pData += pNode->DataSize;
+                if( pNode->DataSize > 0 )
+                {
+                    memcpy_s( pData, pNode->DataSize, pNode->pData, pNode->DataSize );
+                    pData += pNode->DataSize;
+                }
 
                 // copy the name into the string table, move the string pointer
                 if ( pNode->Name.size() > 0 )
@@ -256,16 +302,7 @@ E_RETVAL CElfWriter::ResolveBinary(
                 *(pCurString++) = '\0';
 
                 // delete the node and it's data
-                if( pNode )
-                {
-                    if( pNode->pData )
-                    {
-                        delete[] pNode->pData;
-                        pNode->pData = NULL;
-                    }
-
-                    delete pNode;
-                }
+                DeleteNode( pNode );
             }
         }
 
@@ -50,6 +50,7 @@ struct SSectionNode
     string Name;
     char* pData;
     unsigned int DataSize;
+    bool OwnsData;   // set by CElfWriter; false for sections added by reference
 
     SSectionNode()
     {
@@ -57,6 +58,7 @@ struct SSectionNode
         Flags    = 0;
         pData    = NULL;
         DataSize = 0;
+        OwnsData = true;
     }
 
     ~SSectionNode()
@@ -86,6 +88,16 @@ public:
     E_RETVAL ELF_CALL AddSection(
         SSectionNode* pSectionNode );
 
+    // Adds a section without copying its data. The data pointed to by
+    // pSectionNode->pData must stay valid until ResolveBinary() has written
+    // the final binary; it is then copied exactly once, directly into place.
+    E_RETVAL ELF_CALL AddSectionReference(
+        SSectionNode* pSectionNode );
+
+    // Returns the size of the binary ResolveBinary() will produce, so the
+    // caller can allocate the final buffer up front.
+    size_t ELF_CALL GetBinarySize() const;
+
     E_RETVAL ELF_CALL ResolveBinary(
         char* const pBinary,
         size_t& dataSize );
@@ -101,6 +113,12 @@ protected:
 
     ELF_CALL ~CElfWriter();
 
+    E_RETVAL ELF_CALL AddSectionNode(
+        SSectionNode* pSectionNode,
+        bool copyData );
+
+    static void ELF_CALL DeleteNode( SSectionNode* pNode );
+
     E_EH_TYPE m_type;
     E_EH_MACHINE m_machine;
     Elf64_Xword m_flags;
@@ -0,0 +1,166 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Round-trip test for CElfReader: writes a small ELF with CElfWriter and
+// reads it back from the caller's buffer and from a mapped file, checking
+// section lookup by name, section views and the symbol section index.
+
+#include "../ElfReader.h"
+#include "../ElfWriter.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace CLElfLib;
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if( !( cond ) )                                                     \
+        {                                                                   \
+            fprintf( stderr, "%s:%d: check failed: %s\n",                   \
+                __FILE__, __LINE__, #cond );                                \
+            g_failures++;                                                   \
+        }                                                                   \
+    } while( 0 )
+
+static void AddSection( CElfWriter* pWriter, const char* pName, const std::string& data )
+{
+    SSectionNode node;
+    node.Name = pName;
+    node.Type = SH_TYPE_PROG_BITS;
+    node.pData = (char*)data.data();
+    node.DataSize = (unsigned int)data.size();
+    pWriter->AddSection( &node );
+}
+
+// Appends a { uint16 nameSize, name, uint16 sectionIndex } record.
+static void AddSymbol( std::string& symbols, const std::string& name, unsigned short section )
+{
+    unsigned short size = (unsigned short)name.size();
+    symbols.push_back( (char)( size & 0xff ) );
+    symbols.push_back( (char)( size >> 8 ) );
+    symbols += name;
+    symbols.push_back( (char)( section & 0xff ) );
+    symbols.push_back( (char)( section >> 8 ) );
+}
+
+static void CheckReader( CElfReader* pReader )
+{
+    CHECK( pReader != NULL );
+    if( pReader == NULL )
+    {
+        return;
+    }
+
+    CHECK( pReader->GetElfHeader()->NumSectionHeaderEntries == 6 ); // null, 4 sections, string table
+
+    unsigned int index = 0;
+    CHECK( pReader->GetSectionIndex( "symbols", index ) == SUCCESS && index == 1 );
+    CHECK( pReader->GetSectionIndex( "bar", index ) == SUCCESS && index == 3 );
+    CHECK( pReader->GetSectionIndex( "missing", index ) == FAILURE );
+
+    SElfSectionView view = pReader->GetSectionView( 2 );
+    CHECK( view.DataSize == 4 && memcmp( view.pData, "foo!", 4 ) == 0 );
+    view = pReader->GetSectionView( 3 );
+    CHECK( view.DataSize == 6 && memcmp( view.pData, "barbaz", 6 ) == 0 );
+    CHECK( pReader->GetSectionView( 100 ).empty() );
+
+    // GetSectionData by name goes through the same index
+    char* pData = NULL;
+    size_t dataSize = 0;
+    CHECK( pReader->GetSectionData( "foo", pData, dataSize ) == SUCCESS );
+    CHECK( dataSize == 4 && memcmp( pData, "foo!", 4 ) == 0 );
+
+    // repeated queries reuse the index built by the first one
+    for( int i = 0; i < 2; i++ )
+    {
+        CHECK( pReader->GetSymbolSectionIndex( 1, "foo", 3 ) == 2 );
+        CHECK( pReader->GetSymbolSectionIndex( 1, "bar", 3 ) == 3 );
+        CHECK( pReader->GetSymbolSectionIndex( 1, "baz", 3 ) == 0 );
+        CHECK( pReader->GetSymbolSectionIndex( 4, "foo", 3 ) == 3 );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    std::string symbols;
+    AddSymbol( symbols, "foo", 2 );
+    AddSymbol( symbols, "bar", 3 );
+    std::string otherSymbols;
+    AddSymbol( otherSymbols, "foo", 3 );
+    std::string foo = "foo!";
+    std::string bar = "barbaz";
+
+    CElfWriter* pWriter = CElfWriter::Create( EH_TYPE_NONE, EH_MACHINE_NONE, 0 );
+    CHECK( pWriter != NULL );
+    if( pWriter == NULL )
+    {
+        return 1;
+    }
+    AddSection( pWriter, "symbols", symbols );
+    AddSection( pWriter, "foo", foo );
+    AddSection( pWriter, "bar", bar );
+    AddSection( pWriter, "other_symbols", otherSymbols );
+
+    size_t binarySize = pWriter->GetBinarySize();
+    std::vector<char> binary( binarySize );
+    CHECK( pWriter->ResolveBinary( binary.data(), binarySize ) == SUCCESS );
+    CElfWriter::Delete( pWriter );
+
+    CElfReader* pReader = CElfReader::Create( binary.data(), binarySize );
+    CheckReader( pReader );
+    // the reader borrows the buffer
+    CHECK( pReader && pReader->GetSectionView( 2 ).pData > binary.data() &&
+           pReader->GetSectionView( 2 ).pData < binary.data() + binarySize );
+    CElfReader::Delete( pReader );
+
+    std::string fileName = std::string( argc > 1 ? argv[1] : "." ) + "/ElfReaderTest.elf";
+    FILE* pFile = fopen( fileName.c_str(), "wb" );
+    CHECK( pFile != NULL );
+    if( pFile )
+    {
+        fwrite( binary.data(), 1, binarySize, pFile );
+        fclose( pFile );
+
+        pReader = CElfReader::CreateFromFile( fileName.c_str() );
+        CheckReader( pReader );
+        CElfReader::Delete( pReader );
+        remove( fileName.c_str() );
+    }
+
+    CHECK( CElfReader::CreateFromFile( "this/file/does/not/exist.elf" ) == NULL );
+
+    if( g_failures )
+    {
+        fprintf( stderr, "%d check(s) failed\n", g_failures );
+        return 1;
+    }
+    return 0;
+}
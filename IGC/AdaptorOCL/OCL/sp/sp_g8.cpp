@@ -2492,6 +2492,16 @@ RETVAL CGen8OpenCLStateProcessor::CombineKernelBinary(
     ICBE_DPF_STR( m_oclStateDebugMessagePrintOut,
         GFXDBG_HARDWARE, "Kernel Name: %s\n", annotations.m_kernelName.c_str() );
 
+    kernelBinary.Reserve(
+        kernelBinary.Size() +
+        sizeof( header ) +
+        header.KernelNameSize +
+        header.KernelHeapSize +
+        header.GeneralStateHeapSize +
+        header.DynamicStateHeapSize +
+        header.SurfaceStateHeapSize +
+        header.PatchListSize );
+
     kernelBinary.Write( header );
     kernelBinary.Write( annotations.m_kernelName.c_str(), annotations.m_kernelName.size() + 1 );
     kernelBinary.Align( 4 );
@@ -85,6 +85,16 @@ RETVAL CGen8OpenCLProgramBase::GetProgramBinary(
         DebugProgramBinaryHeader(&header, m_StateProcessor.m_oclStateDebugMessagePrintOut);
     }
 
+    // Size the output once so that appending kernel binaries does not
+    // reallocate and copy what was already written.
+    std::streamsize programBinarySize =
+        programBinary.Size() + sizeof( header ) + m_ProgramScopePatchStream->Size();
+    for( auto data : m_KernelBinaries )
+    {
+        programBinarySize += data.kernelBinary->Size();
+    }
+    programBinary.Reserve( programBinarySize );
+
     programBinary.Write( header );
 
     programBinary.Write( *m_ProgramScopePatchStream );
@@ -143,6 +153,16 @@ RETVAL CGen8OpenCLProgramBase::GetProgramDebugData(Util::BinaryStream& programDe
         header.NumberOfKernels = numDebugBinaries;
         header.SteppingId = m_Platform.usRevId;
 
+        std::streamsize programDebugDataSize = programDebugData.Size() + sizeof( header );
+        for (auto data : m_KernelBinaries)
+        {
+            if (data.kernelDebugData)
+            {
+                programDebugDataSize += data.kernelDebugData->Size();
+            }
+        }
+        programDebugData.Reserve( programDebugDataSize );
+
         programDebugData.Write( header );
 
         for (auto data : m_KernelBinaries)
@@ -25,11 +25,12 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 
 #include "BinaryStream.h"
+#include <cstring>
 
 namespace Util
 {
 
-BinaryStream::BinaryStream() : m_membuf( std::ios::in | std::ios::out | std::ios::binary )
+BinaryStream::BinaryStream()
 {
     // Nothing!
 }
@@ -41,52 +42,29 @@ BinaryStream::~BinaryStream()
 
 bool BinaryStream::Write( const char* s, std::streamsize n )
 {
-    bool retValue = false;
-
-    std::streamsize prevSize = Size();
-
-    m_membuf.write( s, n );
-
-    if( ( Size() - prevSize ) == n )
-    {
-        retValue = true;
-    }
-
-    if( m_membuf.fail() )
+    if( n < 0 || ( n > 0 && s == nullptr ) )
     {
-        retValue = false;
+        return false;
     }
 
-#if defined(_DEBUG)
-    GetLinearPointer();
-#endif
+    m_membuf.insert( m_membuf.end(), s, s + n );
 
-    return retValue;
+    return true;
 }
 
 bool BinaryStream::Write( const BinaryStream& in )
 {
-    bool retValue = false;
-
-    std::streamsize prevSize = Size();
-
-    m_membuf << in.m_membuf.str();
-
-    if( ( Size() - prevSize ) == in.Size() )
+    if( &in == this )
     {
-        retValue = true;
+        // Inserting a range of the vector into itself is not allowed.
+        std::vector<char> copy( m_membuf );
+        m_membuf.insert( m_membuf.end(), copy.begin(), copy.end() );
+        return true;
     }
 
-    if( m_membuf.fail() )
-    {
-        retValue = false;
-    }
-
-#if defined(_DEBUG)
-    GetLinearPointer();
-#endif
+    m_membuf.insert( m_membuf.end(), in.m_membuf.begin(), in.m_membuf.end() );
 
-    return retValue;
+    return true;
 }
 
 
@@ -94,12 +72,12 @@ bool BinaryStream::WriteAt( const char* s, std::streamsize n, std::streamsize lo
 {
     bool retValue = true;
 
-    // Give this function name it seems like this function should enlarge the stream if needed. Discuss.
-    if( ( n + loc ) < Size() )
+    if( loc >= 0 && n >= 0 && ( n + loc ) <= Size() )
     {
-        m_membuf.seekp( loc, std::ios_base::beg );
-        Write( s, n );
-        m_membuf.seekp( 0, std::ios_base::end );
+        if( n > 0 )
+        {
+            memmove( m_membuf.data() + loc, s, (size_t)n );
+        }
     }
     else
     {
@@ -109,10 +87,9 @@ bool BinaryStream::WriteAt( const char* s, std::streamsize n, std::streamsize lo
     return retValue;
 }
 
-const char* BinaryStream::GetLinearPointer()
+const char* BinaryStream::GetLinearPointer() const
 {
-    m_LinearPointer = m_membuf.str();
-    return m_LinearPointer.c_str();
+    return m_membuf.data();
 }
 
 bool BinaryStream::Align( std::streamsize alignment )
@@ -137,28 +114,27 @@ bool BinaryStream::Align( std::streamsize alignment )
 
 bool BinaryStream::AddPadding( std::streamsize padding )
 {
-    bool retValue = true;
-
-    while( padding-- )
+    if( padding > 0 )
     {
         // Always pad with 0x0 to make external tools that parse
         // OpenCL program binaries easier to maintain
-        retValue &= Write( (char)0x0 );
+        m_membuf.resize( m_membuf.size() + (size_t)padding, 0x0 );
     }
 
-    return retValue;
+    return padding >= 0;
 }
 
-std::streamsize BinaryStream::Size() const
+void BinaryStream::Reserve( std::streamsize size )
 {
-    // tellp is a non const function
-    // TODO: Is there a better way to do this?
-    return const_cast<BinaryStream*>(this)->Size();
+    if( size > 0 )
+    {
+        m_membuf.reserve( (size_t)size );
+    }
 }
 
-std::streamsize BinaryStream::Size()
+std::streamsize BinaryStream::Size() const
 {
-    return m_membuf.tellp();
+    return (std::streamsize)m_membuf.size();
 }
 
 }
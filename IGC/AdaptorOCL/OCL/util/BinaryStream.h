@@ -26,11 +26,15 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-#include <sstream>
+#include <ios>
+#include <vector>
 
 namespace Util
 {
 
+// Growable, contiguous byte buffer used to assemble program and kernel
+// binaries. Data is kept linear at all times so GetLinearPointer() and
+// WriteAt() work in place without copying the stream contents.
 class BinaryStream
 {
 public:
@@ -44,6 +48,7 @@ public:
     template< class T >
     bool Write( const T& in );
 
+    // Overwrites n bytes at offset loc. The range must already be written.
     bool WriteAt( const char* s, std::streamsize n, std::streamsize loc );
 
     template< class T >
@@ -52,15 +57,16 @@ public:
     bool Align( std::streamsize alignment );
     bool AddPadding( std::streamsize padding );
 
-    const char* GetLinearPointer();
+    // Pre-sizes the underlying allocation so that subsequent writes of up to
+    // 'size' bytes in total do not reallocate.
+    void Reserve( std::streamsize size );
+
+    const char* GetLinearPointer() const;
 
     std::streamsize Size() const;
-    std::streamsize Size();
 
 private:
-    std::stringstream m_membuf;
-
-    std::string m_LinearPointer;
+    std::vector<char> m_membuf;
 };
 
 template< class T >
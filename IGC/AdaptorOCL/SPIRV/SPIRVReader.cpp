@@ -90,6 +90,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <fstream>
 
 #include "Probe.h"
+#include "common/igc_regkeys.hpp"
+
+#include <unordered_set>
 
 using namespace llvm;
 
@@ -1066,6 +1069,13 @@ public:
   std::vector<Type *> transTypeVector(const std::vector<SPIRVType *>&);
   bool translate();
   bool transAddressingModel();
+  /// Collects the functions reachable from the module roots (kernel entry
+  /// points, exported or imported functions and functions referenced
+  /// indirectly) by walking OpFunctionCall/OpFunctionPointerINTEL.
+  void collectReachableFunctions();
+  bool isReachableFunction(SPIRVFunction *BF) const {
+    return ReachableFuncs.count(BF) != 0;
+  }
 
   enum class BoolAction
   {
@@ -1144,6 +1154,11 @@ private:
   GlobalVariable *m_NamedBarrierVar;
   GlobalVariable *m_named_barrier_id;
   DICompileUnit* compileUnit = nullptr;
+  // When set, only functions in ReachableFuncs are translated eagerly.
+  // Module-scope variables, types and constants are then translated on
+  // demand from the function bodies that use them.
+  bool TranslateReachableOnly = false;
+  std::unordered_set<SPIRVFunction *> ReachableFuncs;
 
   Type *mapType(SPIRVType *BT, Type *T) {
     TypeMap[BT] = T;
@@ -3384,14 +3399,27 @@ SPIRVToLLVM::translate() {
 
   compileUnit = DbgTran.createCompileUnit();
 
+  TranslateReachableOnly = IGC_IS_FLAG_ENABLED(EnableSPIRVLazyTranslation);
+  if (TranslateReachableOnly)
+    collectReachableFunctions();
+
   for (unsigned I = 0, E = BM->getNumVariables(); I != E; ++I) {
     auto BV = BM->getVariable(I);
-    if (BV->getStorageClass() != StorageClassFunction)
-      transValue(BV, nullptr, nullptr, true, BoolAction::Noop);
+    if (BV->getStorageClass() == StorageClassFunction)
+      continue;
+    // Variables which are not visible outside of the module are translated
+    // when the first reachable function refers to them.
+    if (TranslateReachableOnly &&
+        BV->getLinkageType() == LinkageTypeInternal)
+      continue;
+    transValue(BV, nullptr, nullptr, true, BoolAction::Noop);
   }
 
   for (unsigned I = 0, E = BM->getNumFunctions(); I != E; ++I) {
-    transFunction(BM->getFunction(I));
+    SPIRVFunction *BF = BM->getFunction(I);
+    if (TranslateReachableOnly && !isReachableFunction(BF))
+      continue;
+    transFunction(BF);
   }
   for(auto& funcs : FuncMap)
   {
@@ -3418,6 +3446,45 @@ SPIRVToLLVM::translate() {
   return true;
 }
 
+void
+SPIRVToLLVM::collectReachableFunctions() {
+  std::vector<SPIRVFunction *> Worklist;
+  auto addFunction = [&](SPIRVFunction *BF) {
+    if (BF && ReachableFuncs.insert(BF).second)
+      Worklist.push_back(BF);
+  };
+
+  for (unsigned I = 0, E = BM->getNumFunctions(); I != E; ++I) {
+    SPIRVFunction *BF = BM->getFunction(I);
+    if (isOpenCLKernel(BF) ||
+        BF->getLinkageType() != LinkageTypeInternal ||
+        BF->hasDecorate(DecorationReferencedIndirectlyINTEL))
+      addFunction(BF);
+  }
+
+  while (!Worklist.empty()) {
+    SPIRVFunction *BF = Worklist.back();
+    Worklist.pop_back();
+    for (size_t I = 0, E = BF->getNumBasicBlock(); I != E; ++I) {
+      SPIRVBasicBlock *BBB = BF->getBasicBlock(I);
+      for (size_t BI = 0, BE = BBB->getNumInst(); BI != BE; ++BI) {
+        SPIRVInstruction *BInst = BBB->getInst(BI);
+        switch (BInst->getOpCode()) {
+        case OpFunctionCall:
+          addFunction(static_cast<SPIRVFunctionCall *>(BInst)->getFunction());
+          break;
+        case OpFunctionPointerINTEL:
+          addFunction(
+              static_cast<SPIRVFunctionPointerINTEL *>(BInst)->getFunction());
+          break;
+        default:
+          break;
+        }
+      }
+    }
+  }
+}
+
 bool
 SPIRVToLLVM::transAddressingModel() {
   switch (BM->getAddressingModel()) {
@@ -3548,6 +3615,8 @@ SPIRVToLLVM::transKernelMetadata()
     {
         SPIRVFunction *BF = BM->getFunction(I);
         Function *F = static_cast<Function *>(getTranslatedValue(BF));
+        if (!F && TranslateReachableOnly)
+            continue;
         IGC_ASSERT(F && "Invalid translated function");
 
         // __attribute__((annotate("some_user_annotation"))) are passed via
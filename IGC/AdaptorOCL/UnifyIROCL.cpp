@@ -126,6 +126,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/DebugInfo/VISADebugEmitter.hpp"
 #include "Compiler/CISACodeGen/DebugInfo.hpp"
 #include "Compiler/CISACodeGen/TimeStatsCounter.h"
+#include "Compiler/CISACodeGen/ProfileGuided.h"
 
 #include <string>
 #include <algorithm>
@@ -249,6 +250,9 @@ static void CommonOCLBasedPasses(
     CompilerOpts.HasBufferOffsetArg =
         pContext->m_InternalOptions.IntelHasBufferOffsetArg;
 
+    CompilerOpts.FastCompilation =
+        pContext->m_InternalOptions.IntelOptTier0;
+
     CompilerOpts.PreferBindlessImages =
         pContext->m_InternalOptions.PreferBindlessImages;
 
@@ -401,6 +405,17 @@ static void CommonOCLBasedPasses(
     mpm.add(new ImageFuncsAnalysis());
     mpm.add(new OpenCLPrintfAnalysis());
     mpm.add(createDeadCodeEliminationPass());
+    // The counters are program-scope buffers, so they must exist before the
+    // program-scope analysis. The profile is applied at the same point so that
+    // the block numbering matches the instrumented compile.
+    if (IGC_IS_FLAG_ENABLED(EnablePGOInstrumentation))
+    {
+        mpm.add(createPGOInstrumentationPass());
+    }
+    else if (IGC_IS_FLAG_ENABLED(PGOFeedbackFile))
+    {
+        mpm.add(createPGOAnnotationPass());
+    }
     mpm.add(new ProgramScopeConstantAnalysis());
     mpm.add(new PrivateMemoryUsageAnalysis());
     mpm.add(new AggregateArgumentsAnalysis());
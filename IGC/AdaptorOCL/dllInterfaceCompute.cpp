@@ -354,29 +354,26 @@ bool ProcessElfInput(
         const CLElfLib::SElf64SectionHeader* pSectionHeader = pElfReader->GetSectionHeader(i);
         IGC_ASSERT(pSectionHeader != NULL);
 
-        char* pData = NULL;
-        size_t dataSize = 0;
-
         if (pSectionHeader->Type == CLElfLib::SH_TYPE_SPIRV_SC_IDS)
         {
-            pElfReader->GetSectionData(i, pData, dataSize);
-            InputArgs.pSpecConstantsIds = reinterpret_cast<const uint32_t*>(pData);
+            CLElfLib::SElfSectionView section = pElfReader->GetSectionView(i);
+            InputArgs.pSpecConstantsIds = reinterpret_cast<const uint32_t*>(section.pData);
         }
 
         if (pSectionHeader->Type == CLElfLib::SH_TYPE_SPIRV_SC_VALUES)
         {
-            pElfReader->GetSectionData(i, pData, dataSize);
-            InputArgs.pSpecConstantsValues = reinterpret_cast<const uint64_t*>(pData);
+            CLElfLib::SElfSectionView section = pElfReader->GetSectionView(i);
+            InputArgs.pSpecConstantsValues = reinterpret_cast<const uint64_t*>(section.pData);
         }
 
         if ((pSectionHeader->Type == CLElfLib::SH_TYPE_OPENCL_LLVM_BINARY)  ||
             (pSectionHeader->Type == CLElfLib::SH_TYPE_OPENCL_LLVM_ARCHIVE) ||
             (pSectionHeader->Type == CLElfLib::SH_TYPE_SPIRV))
         {
-          pElfReader->GetSectionData(i, pData, dataSize);
+          CLElfLib::SElfSectionView section = pElfReader->GetSectionView(i);
 
-          // Create input module from the buffer
-          llvm::StringRef buf(pData, dataSize);
+          // Create input module from the section, without copying it
+          llvm::StringRef buf(section.pData, section.DataSize);
 
           std::unique_ptr<llvm::Module> InputModule = nullptr;
 
@@ -1061,6 +1058,20 @@ bool TranslateBuild(
                 return false;
             }
             oclContext.setModule(pKernelModule);
+            if (oclContext.isSPIRV())
+            {
+                // Only the kernels picked for retry are compiled again, so only
+                // their metadata written by the SPIR-V reader is decoded.
+                for (const std::string& kernelName : oclContext.m_retryManager.kernelSet)
+                {
+                    llvm::Function* pFunc = pKernelModule->getFunction(kernelName);
+                    FunctionMetaData funcMD;
+                    if (pFunc && deserializeFunctionMD(funcMD, pFunc, pKernelModule))
+                    {
+                        oclContext.getModuleMetaData()->FuncMD[pFunc] = std::move(funcMD);
+                    }
+                }
+            }
         }
     } while (retry);
 
@@ -1126,6 +1137,8 @@ bool TranslateBuild(
 
     COMPILER_TIME_END(&oclContext, TIME_TOTAL);
 
+    CompileTrace::flush();
+
     COMPILER_TIME_PRINT(&oclContext, ShaderType::OPENCL_SHADER, oclContext.hash);
 
     COMPILER_TIME_DEL(&oclContext, m_compilerTimeStats);
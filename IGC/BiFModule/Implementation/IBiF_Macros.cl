@@ -39,11 +39,25 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
         sizeof(_type));
 
 // Macro for async work copy implementation.
-#define ASYNC_WORK_GROUP_COPY(dst, src, num_elements, evt, __num_elements_type)                  \
+// When both ends are 16-byte aligned the bulk of the copy is done in 16-byte
+// chunks, so every work-item moves a uint4 per iteration and the loads and
+// stores become wide messages instead of one element per work-item. The
+// alignment test folds away when the alignment of the pointers is known. The
+// remaining tail elements are copied one by one.
+#define ASYNC_WORK_GROUP_COPY(dst, src, num_elements, evt, __num_elements_type, __dst_as, __src_as)  \
     {                                                                       \
         __num_elements_type uiNumElements = num_elements;                                  \
         __num_elements_type index = __spirv_BuiltInLocalInvocationIndex();            \
         __num_elements_type step = __spirv_WorkgroupSize();                               \
+        if (((ulong)dst & 15) == 0 && ((ulong)src & 15) == 0) {             \
+            __num_elements_type uiNumChunks = (uiNumElements * sizeof(*dst)) / 16;  \
+            __dst_as uint4* dstChunks = (__dst_as uint4*)dst;               \
+            const __src_as uint4* srcChunks = (const __src_as uint4*)src;   \
+            for( __num_elements_type chunk = index; chunk < uiNumChunks; chunk += step ) {  \
+                dstChunks[chunk] = srcChunks[chunk];                        \
+            }                                                               \
+            index += uiNumChunks * 16 / sizeof(*dst);                       \
+        }                                                                   \
         for( ; index < uiNumElements; index += step ) {                     \
             dst[index] = src[index];                                        \
         }                                                                   \
@@ -55,9 +55,10 @@ double OVERLOADABLE intel_sub_group_shuffle_up( double identity, double X, uint
 
 #define ASYNC_COPY_L2G(Destination, Source, NumElements, Stride, Event, type)                         \
 {                                                                                                    \
-    if ( Stride == 0 )                                                                                \
+    /* a unit stride is a plain contiguous copy */                                                    \
+    if ( Stride == 0 || Stride == 1 )                                                                 \
     {                                                                                                \
-        ASYNC_WORK_GROUP_COPY(Destination, Source, NumElements, Event, type)                        \
+        ASYNC_WORK_GROUP_COPY(Destination, Source, NumElements, Event, type, global, local)         \
         return Event;                                                                                \
     }                                                                                                \
     else                                                                                            \
@@ -69,9 +70,10 @@ double OVERLOADABLE intel_sub_group_shuffle_up( double identity, double X, uint
 
 #define ASYNC_COPY_G2L(Destination, Source, NumElements, Stride, Event, type)                         \
 {                                                                                                    \
-    if ( Stride == 0 )                                                                                \
+    /* a unit stride is a plain contiguous copy */                                                    \
+    if ( Stride == 0 || Stride == 1 )                                                                 \
     {                                                                                                \
-        ASYNC_WORK_GROUP_COPY(Destination, Source, NumElements, Event, type)                        \
+        ASYNC_WORK_GROUP_COPY(Destination, Source, NumElements, Event, type, local, global)         \
         return Event;                                                                                \
     }                                                                                                \
     else                                                                                            \
@@ -1786,75 +1788,91 @@ DEFN_ARITH_OPERATIONS(double)
 DEFN_ARITH_OPERATIONS(half)
 #endif // defined(cl_khr_fp16)
 
-#define DEFN_WORK_GROUP_REDUCE(type, op, identity, X)                                       \
-{                                                                                          \
-    GET_MEMPOOL_PTR(data, type, true, 0)                                                     \
-    uint lid = __spirv_BuiltInLocalInvocationIndex();                                        \
-    uint lsize = __spirv_WorkgroupSize();                                                 \
-    data[lid] = X;                                                                       \
-    __builtin_spirv_OpControlBarrier_i32_i32_i32(Execution, 0, AcquireRelease | WorkgroupMemory);         \
-    uint mask = 1 << ( ((8 * sizeof(uint)) - __builtin_spirv_OpenCL_clz_i32(lsize - 1)) - 1) ;  \
-    while( mask > 0 )                                                                    \
-    {                                                                                    \
-        uint c = lid ^ mask;                                                             \
-        type other = ( c < lsize ) ? data[ c ] : identity;                                  \
-        X = op( other, X );                                                                 \
-        __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);     \
-        data[lid] = X;                                                              \
-        __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);     \
-        mask >>= 1;                                                                      \
-    }                                                                                    \
-    type ret = data[0];                                                                  \
-    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);         \
-    return ret;                                                                           \
-}
-
-
-#define DEFN_WORK_GROUP_SCAN_INCL(type, op, identity, X)                                   \
-{                                                                                          \
-    GET_MEMPOOL_PTR(data, type, true, 0)                                                     \
-    uint lid = __spirv_BuiltInLocalInvocationIndex();                                         \
-    uint lsize = __spirv_WorkgroupSize();                                                 \
-    data[lid] = X;                                                                       \
-    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0,AcquireRelease |  WorkgroupMemory);         \
-    uint offset = 1;                                                                      \
-    while( offset < lsize )                                                              \
-    {                                                                                    \
-        type other = ( lid >= offset ) ?                                                  \
-                     data[ lid - offset ] :                                               \
-                     identity;                                                            \
-        X = op( X, other );                                                              \
-        __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);     \
-        data[lid] = X;                                                                   \
-        __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);     \
-        offset <<= 1;                                                                     \
-    }                                                                                    \
-    return X;                                                                            \
-}
-
-
-#define DEFN_WORK_GROUP_SCAN_EXCL(type, op, identity, X)                                   \
-{                                                                                         \
-    GET_MEMPOOL_PTR(data, type, true, 1)                                                 \
-    uint lid = __spirv_BuiltInLocalInvocationIndex();                                         \
-    uint lsize = __spirv_WorkgroupSize();                                                 \
-    data[0] = identity;                                                                  \
-    data[lid + 1] = X;                                                                   \
-    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);         \
-    X = data[lid];                                                                       \
-    uint offset = 1;                                                                      \
-    while( offset < lsize )                                                              \
-    {                                                                                    \
-        type other = ( lid >= offset ) ?                                                  \
-                     data[ lid - offset ] :                                               \
-                     identity;                                                            \
-        X = op( X, other );                                                              \
-        __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);       \
-        data[lid] = X;                                                                   \
-        __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);       \
-        offset <<= 1;                                                                    \
-    }                                                                                    \
-    return X;                                                                            \
+// Work-group functions are done in two levels: each subgroup reduces or scans
+// in registers, then one partial per subgroup is exchanged through SLM. This
+// needs two barriers in total instead of two per log2(local_size) round, and
+// none at all when the whole work-group fits in a single subgroup.
+#define DEFN_WORK_GROUP_REDUCE(func, type, type_abbr, op, identity, X)                      \
+{                                                                                           \
+    type sgResult = __intel_sub_group_##func##_##type_abbr(GroupOperationReduce, X);        \
+    uint numSubgroups = __builtin_spirv_BuiltInNumSubgroups();                              \
+    if (numSubgroups == 1)                                                                  \
+    {                                                                                       \
+        return sgResult;                                                                    \
+    }                                                                                       \
+    GET_MEMPOOL_PTR(data, type, true, 0)                                                    \
+    uint sgid = __builtin_spirv_BuiltInSubgroupId();                                        \
+    uint sglid = __builtin_spirv_BuiltInSubgroupLocalInvocationId();                        \
+    uint sgsize = __builtin_spirv_BuiltInSubgroupSize();                                    \
+    if (sglid == 0)                                                                         \
+    {                                                                                       \
+        data[sgid] = sgResult;                                                              \
+    }                                                                                       \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);\
+    type partial = identity;                                                                \
+    for (uint i = sglid; i < numSubgroups; i += sgsize)                                     \
+    {                                                                                       \
+        partial = op(partial, data[i]);                                                     \
+    }                                                                                       \
+    type ret = __intel_sub_group_##func##_##type_abbr(GroupOperationReduce, partial);       \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);\
+    return ret;                                                                             \
+}
+
+
+#define DEFN_WORK_GROUP_SCAN_INCL(func, type, type_abbr, op, identity, X)                   \
+{                                                                                           \
+    type sgResult = __intel_sub_group_##func##_##type_abbr(GroupOperationInclusiveScan, X); \
+    uint numSubgroups = __builtin_spirv_BuiltInNumSubgroups();                              \
+    if (numSubgroups == 1)                                                                  \
+    {                                                                                       \
+        return sgResult;                                                                    \
+    }                                                                                       \
+    GET_MEMPOOL_PTR(data, type, true, 0)                                                    \
+    uint sgid = __builtin_spirv_BuiltInSubgroupId();                                        \
+    uint sglid = __builtin_spirv_BuiltInSubgroupLocalInvocationId();                        \
+    uint sgsize = __builtin_spirv_BuiltInSubgroupSize();                                    \
+    if (sglid == sgsize - 1)                                                                \
+    {                                                                                       \
+        data[sgid] = sgResult;                                                              \
+    }                                                                                       \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);\
+    type prefix = identity;                                                                 \
+    for (uint i = sglid; i < sgid; i += sgsize)                                             \
+    {                                                                                       \
+        prefix = op(prefix, data[i]);                                                       \
+    }                                                                                       \
+    prefix = __intel_sub_group_##func##_##type_abbr(GroupOperationReduce, prefix);          \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);\
+    return op(prefix, sgResult);                                                            \
+}
+
+
+#define DEFN_WORK_GROUP_SCAN_EXCL(func, type, type_abbr, op, identity, X)                   \
+{                                                                                           \
+    type sgResult = __intel_sub_group_##func##_##type_abbr(GroupOperationExclusiveScan, X); \
+    uint numSubgroups = __builtin_spirv_BuiltInNumSubgroups();                              \
+    if (numSubgroups == 1)                                                                  \
+    {                                                                                       \
+        return sgResult;                                                                    \
+    }                                                                                       \
+    GET_MEMPOOL_PTR(data, type, true, 0)                                                    \
+    uint sgid = __builtin_spirv_BuiltInSubgroupId();                                        \
+    uint sglid = __builtin_spirv_BuiltInSubgroupLocalInvocationId();                        \
+    uint sgsize = __builtin_spirv_BuiltInSubgroupSize();                                    \
+    if (sglid == sgsize - 1)                                                                \
+    {                                                                                       \
+        data[sgid] = op(sgResult, X);                                                       \
+    }                                                                                       \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);\
+    type prefix = identity;                                                                 \
+    for (uint i = sglid; i < sgid; i += sgsize)                                             \
+    {                                                                                       \
+        prefix = op(prefix, data[i]);                                                       \
+    }                                                                                       \
+    prefix = __intel_sub_group_##func##_##type_abbr(GroupOperationReduce, prefix);          \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);\
+    return op(prefix, sgResult);                                                            \
 }
 
 #define DEFN_SUB_GROUP_REDUCE(type, type_abbr, op, identity, X)                             \
@@ -1972,17 +1990,17 @@ DEFN_ARITH_OPERATIONS(half)
     return X;                                                                            \
 }
 
-#define WORK_GROUP_SWITCH(type, op, identity, X, Operation)                                 \
+#define WORK_GROUP_SWITCH(func, type, type_abbr, op, identity, X, Operation)               \
 {                                                                                         \
     switch(Operation){                                                                     \
         case GroupOperationReduce:                                                         \
-            DEFN_WORK_GROUP_REDUCE(type, op, identity, X)                                 \
+            DEFN_WORK_GROUP_REDUCE(func, type, type_abbr, op, identity, X)                \
             break;                                                                         \
         case GroupOperationInclusiveScan:                                                 \
-            DEFN_WORK_GROUP_SCAN_INCL(type, op, identity, X)                             \
+            DEFN_WORK_GROUP_SCAN_INCL(func, type, type_abbr, op, identity, X)            \
             break;                                                                         \
         case GroupOperationExclusiveScan:                                                 \
-            DEFN_WORK_GROUP_SCAN_EXCL(type, op, identity, X)                             \
+            DEFN_WORK_GROUP_SCAN_EXCL(func, type, type_abbr, op, identity, X)            \
             break;                                                                         \
         default:                                                                         \
             return 0;                                                                    \
@@ -2008,39 +2026,43 @@ DEFN_ARITH_OPERATIONS(half)
     }                                                                                     \
 }
 
-#define DEFN_UNIFORM_GROUP_FUNC(func, type, type_abbr, op, identity)                             \
-type  __builtin_spirv_OpGroup##func##_i32_i32_##type_abbr(uint Execution, uint Operation, type X)       \
-{                                                                                                \
-    if (Execution == Workgroup)                                                                  \
-    {                                                                                            \
-        WORK_GROUP_SWITCH(type, op, identity, X, Operation)                                      \
-    }                                                                                            \
-    else if (Execution == Subgroup)                                                              \
-    {                                                                                             \
-        if (sizeof(X) < 8 || __UseNative64BitSubgroupBuiltin)                                            \
-        {                                                                                        \
-            if (Operation == GroupOperationReduce)                                                     \
-            {                                                                                         \
-                return __builtin_IB_sub_group_reduce_##func##_##type_abbr(X);                         \
-            }                                                                                         \
-            else if (Operation == GroupOperationInclusiveScan)                                         \
-            {                                                                                         \
-                return op(X, __builtin_IB_sub_group_scan_##func##_##type_abbr(X));                     \
-            }                                                                                         \
-            else if (Operation == GroupOperationExclusiveScan)                                         \
-            {                                                                                         \
-                return __builtin_IB_sub_group_scan_##func##_##type_abbr(X);                           \
-            }                                                                                         \
-        }                                                                                         \
-        else {                                                                                     \
-            SUB_GROUP_SWITCH(type, type_abbr, op, identity, X, Operation)                         \
-        }                                                                                         \
-        return 0;                                                                                 \
-    }                                                                                            \
-    else                                                                                         \
-    {                                                                                            \
-        return 0;                                                                                \
-    }                                                                                            \
+#define DEFN_UNIFORM_GROUP_FUNC(func, type, type_abbr, op, identity)                            \
+static type __intel_sub_group_##func##_##type_abbr(uint Operation, type X)                      \
+{                                                                                               \
+    if (sizeof(X) < 8 || __UseNative64BitSubgroupBuiltin)                                       \
+    {                                                                                           \
+        if (Operation == GroupOperationReduce)                                                  \
+        {                                                                                       \
+            return __builtin_IB_sub_group_reduce_##func##_##type_abbr(X);                       \
+        }                                                                                       \
+        else if (Operation == GroupOperationInclusiveScan)                                      \
+        {                                                                                       \
+            return op(X, __builtin_IB_sub_group_scan_##func##_##type_abbr(X));                  \
+        }                                                                                       \
+        else if (Operation == GroupOperationExclusiveScan)                                      \
+        {                                                                                       \
+            return __builtin_IB_sub_group_scan_##func##_##type_abbr(X);                         \
+        }                                                                                       \
+    }                                                                                           \
+    else {                                                                                      \
+        SUB_GROUP_SWITCH(type, type_abbr, op, identity, X, Operation)                           \
+    }                                                                                           \
+    return 0;                                                                                   \
+}                                                                                               \
+type  __builtin_spirv_OpGroup##func##_i32_i32_##type_abbr(uint Execution, uint Operation, type X)\
+{                                                                                               \
+    if (Execution == Workgroup)                                                                 \
+    {                                                                                           \
+        WORK_GROUP_SWITCH(func, type, type_abbr, op, identity, X, Operation)                    \
+    }                                                                                           \
+    else if (Execution == Subgroup)                                                             \
+    {                                                                                           \
+        return __intel_sub_group_##func##_##type_abbr(Operation, X);                            \
+    }                                                                                           \
+    else                                                                                        \
+    {                                                                                           \
+        return 0;                                                                               \
+    }                                                                                           \
 }
 
 // ---- Add ----
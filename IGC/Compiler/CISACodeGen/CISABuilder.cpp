@@ -3805,6 +3805,12 @@ namespace IGC
             {
                 SaveOption(vISA_ReRAPostSchedule, true);
             }
+
+            // Tier-0 compiles use the linear-scan GRF allocator.
+            if (ClContext->m_InternalOptions.IntelOptTier0)
+            {
+                SaveOption(vISA_LinearScanRA, true);
+            }
         }
 
         bool EnableBarrierInstCounterBits = false;
@@ -3895,7 +3901,8 @@ namespace IGC
                 return false;
             if (context->type == ShaderType::OPENCL_SHADER) {
                 auto ClContext = static_cast<OpenCLProgramContext*>(context);
-                if (!ClContext->m_InternalOptions.IntelEnablePreRAScheduling)
+                if (!ClContext->m_InternalOptions.IntelEnablePreRAScheduling ||
+                    ClContext->m_InternalOptions.IntelOptTier0)
                     return false;
             }
 
@@ -4330,6 +4337,7 @@ namespace IGC
         labelMap.resize(m_program->entry->size(), nullptr);
         labelCounter = 0;
         m_hasInlineAsm = context->m_DriverInfo.SupportInlineAssembly() && context->m_instrTypes.hasInlineAsm;
+        m_inlineAsmAsText = m_hasInlineAsm && IGC_IS_FLAG_DISABLED(EnableDirectInlineAsm);
 
         vbuilder = nullptr;
         vAsmTextBuilder = nullptr;
@@ -4339,7 +4347,7 @@ namespace IGC
 
         llvm::SmallVector<const char*, 10> params;
         llvm::SmallVector<std::unique_ptr< char, std::function<void(char*)>>, 10> params2;
-        if (!m_hasInlineAsm)
+        if (!m_inlineAsmAsText)
         {
             // Asm text writer mode doesnt need dump params
             InitBuildParams(params2);
@@ -4351,7 +4359,8 @@ namespace IGC
 
         COMPILER_TIME_START(m_program->GetContext(), TIME_CG_vISACompile);
         bool enableVISADump = IGC_IS_FLAG_ENABLED(EnableVISASlowpath) || IGC_IS_FLAG_ENABLED(ShaderDumpEnable);
-        auto builderMode = m_hasInlineAsm ? vISA_ASM_WRITER : vISA_3D;
+        auto builderMode = m_inlineAsmAsText ? vISA_ASM_WRITER : vISA_3D;
+        // Inline asm fragments refer to vISA variables by name, which needs the vISA variable tables.
         auto builderOpt = (enableVISADump || m_hasInlineAsm) ? VISA_BUILDER_BOTH : VISA_BUILDER_GEN;
         V(CreateVISABuilder(vbuilder, builderMode, builderOpt, VISAPlatform, params.size(), params.data(), &m_WaTable));
 
@@ -4876,10 +4885,10 @@ namespace IGC
         }
 
         // Compile generated VISA text string for inlineAsm
-        if (m_hasInlineAsm || visaAsmOverride)
+        if (m_inlineAsmAsText || visaAsmOverride)
         {
             // Finalize the text builder by writing the header
-            if (m_hasInlineAsm)
+            if (m_inlineAsmAsText)
                 V(vbuilder->WriteVISAHeader());
 
             llvm::SmallVector<const char*, 10> params;
@@ -6117,6 +6126,24 @@ namespace IGC
         }
     }
 
+    /// Appends an inline asm fragment whose operands were already replaced by
+    /// vISA variable names to the current kernel or function.
+    void CEncoder::AppendInlineAsm(const std::string& asmText)
+    {
+        if (m_inlineAsmAsText)
+        {
+            std::stringstream& str = vbuilder->GetAsmTextStream();
+            str << std::endl << "/// Inlined ASM" << std::endl;
+            str << asmText;
+            if (asmText.back() != '\n') str << std::endl;
+            str << "/// End Inlined ASM" << std::endl << std::endl;
+        }
+        else
+        {
+            V(vbuilder->ParseVISAInlineAsm(vKernel, asmText));
+        }
+    }
+
     std::string CEncoder::GetDumpFileName(std::string extension)
     {
         std::string filename = IGC::Debug::GetDumpName(m_program, extension.c_str());
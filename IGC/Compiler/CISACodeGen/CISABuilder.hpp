@@ -382,6 +382,7 @@ namespace IGC
         void AddVISASymbol(std::string& symName, CVariable* cvar);
 
         std::string GetVariableName(CVariable* var);
+        void AppendInlineAsm(const std::string& asmText);
         std::string GetDumpFileName(std::string extension);
 
     private:
@@ -559,6 +560,8 @@ namespace IGC
 
         bool m_enableVISAdump;
         bool m_hasInlineAsm;
+        /// Inline asm is emitted as vISA text and the whole kernel is reparsed
+        bool m_inlineAsmAsText;
         std::vector<VISA_LabelOpnd*> labelMap;
 
         /// Per kernel label counter
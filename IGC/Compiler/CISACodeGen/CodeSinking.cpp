@@ -68,6 +68,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "Compiler/CodeGenPublic.h"
 #include "Compiler/CISACodeGen/CodeSinking.hpp"
+#include "Compiler/CISACodeGen/ProfileGuided.h"
 #include "Compiler/CISACodeGen/helper.h"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
 #include "Compiler/IGCPassSupport.h"
@@ -620,8 +621,13 @@ namespace IGC {
             if (FindLowestSinkTarget(inst, tgtBlk, usesInBlk, outerLoop, ForceToReducePressure))
             {
                 // heuristic, avoid code-motion that does not reduce execution frequency but may increase register usage
+                // (the profile, if any, tells when the target runs as often as the source)
+                uint64_t srcCount = 0, tgtCount = 0;
+                bool noGainByProfile = tgtBlk &&
+                    getPGOBlockCount(inst->getParent(), srcCount) &&
+                    getPGOBlockCount(tgtBlk, tgtCount) && tgtCount >= srcCount;
                 if (reducePressure ||
-                    (tgtBlk && (outerLoop || !PDT->dominates(tgtBlk, inst->getParent()))))
+                    (tgtBlk && !noGainByProfile && (outerLoop || !PDT->dominates(tgtBlk, inst->getParent()))))
                 {
                     succToSinkTo = tgtBlk;
                 }
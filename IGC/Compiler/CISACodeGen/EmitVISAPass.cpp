@@ -370,6 +370,12 @@ bool EmitPass::runOnFunction(llvm::Function& F)
 
     CreateKernelShaderMap(m_pCtx, pMdUtils, F);
 
+    // spans recorded by vISA while compiling this kernel are tagged with it
+    CompileTrace::KernelScope traceKernel(
+        CompileTrace::isEnabled() ? F.getName().str().c_str() : nullptr,
+        numLanes(m_SimdMode),
+        m_pCtx->m_retryManager.GetRetryId());
+
     m_FGA = getAnalysisIfAvailable<GenXFunctionGroupAnalysis>();
 
     if ((IsStage1BestPerf(m_pCtx->m_CgFlag, m_pCtx->m_StagingCtx)) && m_SimdMode == SIMDMode::SIMD8)
@@ -8042,7 +8048,6 @@ bool EmitPass::validateInlineAsmConstraints(llvm::CallInst* inst, SmallVector<St
 // Example: "mul (M1, 16) $0(0, 0)<1> $1(0, 0)<1;1,0> $2(0, 0)<1;1,0>", "=r,r,r"(float %6, float %7)
 void EmitPass::EmitInlineAsm(llvm::CallInst* inst)
 {
-    std::stringstream& str = m_encoder->GetVISABuilder()->GetAsmTextStream();
     InlineAsm* IA = cast<InlineAsm>(inst->getCalledValue());
     string asmStr = IA->getAsmString();
     smallvector<CVariable*, 8> opnds;
@@ -8121,7 +8126,6 @@ void EmitPass::EmitInlineAsm(llvm::CallInst* inst)
         }
     }
 
-    str << endl << "/// Inlined ASM" << endl;
     // Look for variables to replace with the VISA variable
     size_t startPos = 0;
     while (startPos < asmStr.size())
@@ -8153,9 +8157,7 @@ void EmitPass::EmitInlineAsm(llvm::CallInst* inst)
         startPos = varPos + varName.size();
     }
 
-    str << asmStr;
-    if (asmStr.back() != '\n') str << endl;
-    str << "/// End Inlined ASM" << endl << endl;
+    m_encoder->AppendInlineAsm(asmStr);
 }
 
 CVariable* EmitPass::Mul(CVariable* Src0, CVariable* Src1, const CVariable* DstPrototype)
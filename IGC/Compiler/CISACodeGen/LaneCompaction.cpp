@@ -0,0 +1,583 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/SetVector.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/PostDominators.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/Pass.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Transforms/Utils/LoopUtils.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "AdaptorCommon/ImplicitArgs.hpp"
+#include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
+#include "Compiler/CISACodeGen/WIAnalysis.hpp"
+#include "Compiler/IGCPassSupport.h"
+#include "Compiler/MetaDataUtilsWrapper.h"
+#include "Compiler/CISACodeGen/LaneCompaction.h"
+#include "GenISAIntrinsics/GenIntrinsicInst.h"
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+namespace {
+    // Max SLM available to a work-group.
+    const unsigned MaxSLMSize = 64 * 1024;
+
+    // This pass compacts the work of divergent loops onto fewer hardware
+    // threads. When only a few work-items of a work-group keep iterating, each
+    // hardware thread still runs the whole loop body for its few active lanes.
+    // Every `K` iterations the work-items still running push their loop state
+    // (header PHIs, the owner's local id and the values defined before the
+    // loop that it reads) to SLM. The state is then reloaded by the work-items
+    // with the lowest local ids, so the remaining work is packed into as few
+    // threads as possible. Threads left without work only spin on the loop
+    // latch until the next compaction. A work-item whose work finishes stores
+    // the loop's live-out values to its owner's slot, which reloads them after
+    // the loop.
+    //
+    //   preheader:                       lc.header:
+    //     br %header                       %active = phi [true, %preheader], ...
+    //                                      br %active, %header, %lc.latch
+    //   header:          ==>             header:
+    //     ...                              ...
+    //   latch:                           latch:
+    //     br %c, %header, %exit            br %c, %lc.latch, %lc.finish
+    //                                    lc.latch:
+    //                                      br (iter % K == 0), %lc.compact, %lc.header
+    //                                    lc.compact: ...
+    //                                      br (count == 0), %lc.exit, %lc.header
+    //
+    // Since the compaction uses barriers, the loop must be reached by every
+    // work-item of the work-group, and the work-group size must be known.
+    //
+    class LaneCompaction : public FunctionPass {
+        const DataLayout* DL;
+        DominatorTree* DT;
+        PostDominatorTree* PDT;
+        LoopInfo* LI;
+        WIAnalysis* WI;
+        Function* Func;
+        unsigned NumExplicitArgs;
+
+    public:
+        static char ID;
+
+        LaneCompaction() : FunctionPass(ID), DL(nullptr), DT(nullptr),
+            PDT(nullptr), LI(nullptr), WI(nullptr), Func(nullptr),
+            NumExplicitArgs(0) {
+            initializeLaneCompactionPass(*PassRegistry::getPassRegistry());
+        }
+
+        bool runOnFunction(Function& F) override;
+
+        StringRef getPassName() const override { return "Lane Compaction"; }
+
+    private:
+        void getAnalysisUsage(AnalysisUsage& AU) const override {
+            AU.addRequired<CodeGenContextWrapper>();
+            AU.addRequired<MetaDataUtilsWrapper>();
+            AU.addRequired<DominatorTreeWrapperPass>();
+            AU.addRequired<PostDominatorTreeWrapperPass>();
+            AU.addRequired<LoopInfoWrapperPass>();
+            AU.addRequired<WIAnalysis>();
+        }
+
+        /// State of one work-item moved through SLM.
+        struct Field {
+            Value* V;
+            unsigned Offset;
+        };
+
+        bool isCandidate(Loop* L) const;
+        bool isMigratedLiveIn(Value* V, Loop* L) const;
+        static bool isSupportedType(Type* Ty);
+        unsigned layoutFields(ArrayRef<Value*> Vals, unsigned Offset,
+            SmallVectorImpl<Field>& Fields) const;
+        void compactLoop(Loop* L, Value* LocalId, unsigned GroupSize,
+            unsigned& SLMBase);
+
+        void emitBarrier(IRBuilder<>& IRB) const;
+        void storeSLM(IRBuilder<>& IRB, Value* V, Value* Addr) const;
+        Value* loadSLM(IRBuilder<>& IRB, Type* Ty, Value* Addr) const;
+    };
+
+    char LaneCompaction::ID = 0;
+
+} // End anonymous namespace
+
+FunctionPass* IGC::createLaneCompactionPass() {
+    return new LaneCompaction();
+}
+
+#define PASS_FLAG     "igc-lane-compaction"
+#define PASS_DESC     "Compact divergent loop work through SLM"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+namespace IGC {
+    IGC_INITIALIZE_PASS_BEGIN(LaneCompaction, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+        IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+        IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
+        IGC_INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+        IGC_INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
+        IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+        IGC_INITIALIZE_PASS_DEPENDENCY(WIAnalysis);
+    IGC_INITIALIZE_PASS_END(LaneCompaction, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+} // End namespace IGC
+
+bool LaneCompaction::runOnFunction(Function& F) {
+    // Skip non-kernel function.
+    MetaDataUtils* MDU = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+    auto FII = MDU->findFunctionsInfoItem(&F);
+    if (FII == MDU->end_FunctionsInfo())
+        return false;
+
+    // Compaction slots are indexed by the local id and the number of slots is
+    // the work-group size, so it must be known at compile time.
+    ThreadGroupSizeMetaDataHandle TGSize = FII->second->getThreadGroupSize();
+    if (!TGSize->hasValue())
+        return false;
+    unsigned GroupSize =
+        TGSize->getXDim() * TGSize->getYDim() * TGSize->getZDim();
+    if (GroupSize <= 1 ||
+        GroupSize > IGC_GET_FLAG_VALUE(LaneCompactionMaxGroupSize))
+        return false;
+
+    ImplicitArgs IAS(F, MDU);
+    if (!IAS.isImplicitArgExist(ImplicitArg::LOCAL_ID_X) ||
+        !IAS.isImplicitArgExist(ImplicitArg::LOCAL_ID_Y) ||
+        !IAS.isImplicitArgExist(ImplicitArg::LOCAL_ID_Z))
+        return false;
+
+    DL = &F.getParent()->getDataLayout();
+    DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    PDT = &getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+    LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    WI = &getAnalysis<WIAnalysis>();
+    Func = &F;
+    NumExplicitArgs = unsigned(F.arg_size()) - IAS.size();
+
+    // All checks are done on the original CFG; the transformation below
+    // doesn't keep the dominator trees up to date.
+    SmallVector<Loop*, 4> Candidates;
+    for (Loop* L : *LI)
+        if (isCandidate(L))
+            Candidates.push_back(L);
+    if (Candidates.empty())
+        return false;
+
+    for (Loop* L : Candidates)
+        formLCSSA(*L, *DT, LI, nullptr);
+
+    // Linear local id, computed once in the entry block.
+    IRBuilder<> IRB(&*F.getEntryBlock().getFirstInsertionPt());
+    Value* IdX = IRB.CreateZExt(IAS.getArgInFunc(F, ImplicitArg::LOCAL_ID_X), IRB.getInt32Ty());
+    Value* IdY = IRB.CreateZExt(IAS.getArgInFunc(F, ImplicitArg::LOCAL_ID_Y), IRB.getInt32Ty());
+    Value* IdZ = IRB.CreateZExt(IAS.getArgInFunc(F, ImplicitArg::LOCAL_ID_Z), IRB.getInt32Ty());
+    Value* LocalId = IRB.CreateMul(IdZ, IRB.getInt32(TGSize->getYDim()));
+    LocalId = IRB.CreateAdd(LocalId, IdY);
+    LocalId = IRB.CreateMul(LocalId, IRB.getInt32(TGSize->getXDim()));
+    LocalId = IRB.CreateAdd(LocalId, IdX, "lc.lid");
+
+    // The SLM of each compacted loop is placed after the kernel's own local
+    // memory. Loops run one after the other, but barriers separate them
+    // anyway, so each simply gets its own area.
+    ModuleMetaData* MMD = getAnalysis<MetaDataUtilsWrapper>().getModuleMetaData();
+    unsigned SLMBase = iSTD::Align(MMD->FuncMD[&F].localSize, 32);
+    unsigned SLMEnd = SLMBase;
+    for (Loop* L : Candidates)
+        compactLoop(L, LocalId, GroupSize, SLMEnd);
+    if (SLMEnd != SLMBase)
+        MMD->FuncMD[&F].localSize = iSTD::Align(SLMEnd, 32);
+
+    return true;
+}
+
+/// isSupportedType() - returns true if values of `Ty` can be moved through SLM.
+bool LaneCompaction::isSupportedType(Type* Ty) {
+    if (Ty->isIntegerTy() || Ty->isFloatingPointTy() || Ty->isPointerTy())
+        return Ty->getPrimitiveSizeInBits() <= 64;
+    if (Ty->isVectorTy()) {
+        Type* EltTy = Ty->getVectorElementType();
+        return (EltTy->isIntegerTy() && !EltTy->isIntegerTy(1)) ||
+            EltTy->isFloatingPointTy();
+    }
+    return false;
+}
+
+/// isCandidate() - returns true if `L` is a hot, divergent loop whose state
+/// can be moved between work-items.
+bool LaneCompaction::isCandidate(Loop* L) const {
+    BasicBlock* Preheader = L->getLoopPreheader();
+    BasicBlock* Latch = L->getLoopLatch();
+    BasicBlock* Exit = L->getExitBlock();
+    if (!Preheader || !Latch || !Exit ||
+        L->getExitingBlock() != Latch || Exit->getSinglePredecessor() != Latch)
+        return false;
+
+    // Every work-item of the work-group must reach the loop, otherwise the
+    // barriers of the compaction would hang.
+    if (!PDT->dominates(Preheader, &Func->getEntryBlock()))
+        return false;
+
+    // Only divergent loops benefit.
+    auto* Br = dyn_cast<BranchInst>(Latch->getTerminator());
+    if (!Br || !Br->isConditional() || WI->isUniform(Br->getCondition()))
+        return false;
+
+    // Hot: either big enough or containing nested loops.
+    unsigned NumInsts = 0;
+    for (auto* BB : L->blocks())
+        NumInsts += unsigned(BB->size());
+    if (L->getSubLoops().empty() &&
+        NumInsts < IGC_GET_FLAG_VALUE(LaneCompactionMinLoopSize))
+        return false;
+
+    for (auto* BB : L->blocks())
+        for (auto& I : *BB) {
+            if (auto* CI = dyn_cast<CallInst>(&I)) {
+                // Calls must neither synchronize with other lanes nor depend on
+                // which lane or thread they run on. GenISA intrinsics without
+                // operands read the lane or thread identity (simdLaneId, r0...).
+                Function* Callee = CI->getCalledFunction();
+                if (!Callee || !Callee->isDeclaration() || CI->isConvergent())
+                    return false;
+                if (isa<GenIntrinsicInst>(CI) && CI->getNumArgOperands() == 0)
+                    return false;
+                if (!isa<GenIntrinsicInst>(CI) && !isa<IntrinsicInst>(CI))
+                    return false;
+            }
+            // Scratch-space private memory is addressed per thread.
+            if (auto* LD = dyn_cast<LoadInst>(&I))
+                if (LD->getPointerAddressSpace() == ADDRESS_SPACE_PRIVATE)
+                    return false;
+            if (auto* ST = dyn_cast<StoreInst>(&I))
+                if (ST->getPointerAddressSpace() == ADDRESS_SPACE_PRIVATE)
+                    return false;
+            if (isa<AllocaInst>(&I))
+                return false;
+
+            if (!isSupportedType(I.getType()) && !I.getType()->isVoidTy() &&
+                !I.getType()->isLabelTy()) {
+                // Values of other types are fine as long as they stay inside
+                // the loop; only loop state and live-outs move through SLM.
+                if (isa<PHINode>(&I) && I.getParent() == L->getHeader())
+                    return false;
+                for (auto* U : I.users())
+                    if (!L->contains(cast<Instruction>(U)))
+                        return false;
+            }
+            for (auto& Op : I.operands())
+                if (isMigratedLiveIn(Op, L) && !isSupportedType(Op->getType()))
+                    return false;
+        }
+
+    return true;
+}
+
+/// isMigratedLiveIn() - returns true if `V` is defined before `L` and must
+/// move with the work it belongs to. Only constants and the explicit kernel
+/// arguments are the same for every work-item of the work-group; values
+/// WIAnalysis reports as uniform are only uniform within a hardware thread.
+bool LaneCompaction::isMigratedLiveIn(Value* V, Loop* L) const {
+    if (auto* I = dyn_cast<Instruction>(V))
+        return !L->contains(I);
+    if (auto* A = dyn_cast<Argument>(V))
+        return A->getArgNo() >= NumExplicitArgs;
+    return false;
+}
+
+/// layoutFields() - assigns SLM offsets, relative to the start of a record,
+/// to `Vals` starting at `Offset`. Returns the end offset.
+unsigned LaneCompaction::layoutFields(ArrayRef<Value*> Vals, unsigned Offset,
+    SmallVectorImpl<Field>& Fields) const {
+    for (Value* V : Vals) {
+        unsigned Size = std::max(1U, unsigned(DL->getTypeStoreSize(V->getType())));
+        unsigned Align = std::min(8U, unsigned(PowerOf2Ceil(Size)));
+        Offset = iSTD::Align(Offset, std::max(4U, Align));
+        Fields.push_back({ V, Offset });
+        Offset += Size;
+    }
+    return iSTD::Align(Offset, 8);
+}
+
+void LaneCompaction::emitBarrier(IRBuilder<>& IRB) const {
+    Module* M = Func->getParent();
+    Value* False = IRB.getFalse();
+    Value* Args[] = { IRB.getTrue(), False, False, False, False, False, False };
+    IRB.CreateCall(GenISAIntrinsic::getDeclaration(M, GenISAIntrinsic::GenISA_memoryfence), Args);
+    IRB.CreateCall(GenISAIntrinsic::getDeclaration(M, GenISAIntrinsic::GenISA_threadgroupbarrier));
+}
+
+void LaneCompaction::storeSLM(IRBuilder<>& IRB, Value* V, Value* Addr) const {
+    Type* Ty = V->getType();
+    if (Ty->isIntegerTy(1))
+        V = IRB.CreateZExt(V, IRB.getInt8Ty());
+    else if (Ty->isPointerTy())
+        V = IRB.CreatePtrToInt(V, DL->getIntPtrType(Ty));
+    Type* PtrTy = PointerType::get(V->getType(), ADDRESS_SPACE_LOCAL);
+    IRB.CreateAlignedStore(V, IRB.CreateIntToPtr(Addr, PtrTy), 4);
+}
+
+Value* LaneCompaction::loadSLM(IRBuilder<>& IRB, Type* Ty, Value* Addr) const {
+    Type* MemTy = Ty;
+    if (Ty->isIntegerTy(1))
+        MemTy = IRB.getInt8Ty();
+    else if (Ty->isPointerTy())
+        MemTy = DL->getIntPtrType(Ty);
+    Type* PtrTy = PointerType::get(MemTy, ADDRESS_SPACE_LOCAL);
+    Value* V = IRB.CreateAlignedLoad(IRB.CreateIntToPtr(Addr, PtrTy), 4);
+    if (Ty->isIntegerTy(1))
+        return IRB.CreateTrunc(V, Ty);
+    if (Ty->isPointerTy())
+        return IRB.CreateIntToPtr(V, Ty);
+    return V;
+}
+
+void LaneCompaction::compactLoop(Loop* L, Value* LocalId, unsigned GroupSize,
+    unsigned& SLMBase) {
+    BasicBlock* Preheader = L->getLoopPreheader();
+    BasicBlock* Header = L->getHeader();
+    BasicBlock* Latch = L->getLoopLatch();
+    BasicBlock* Exit = L->getExitBlock();
+    LLVMContext& Ctx = Func->getContext();
+
+    // Loop state: header PHIs and the values defined before the loop and used
+    // in it.
+    SmallVector<PHINode*, 8> HeaderPhis;
+    for (auto II = Header->begin(); auto* PN = dyn_cast<PHINode>(II); ++II)
+        HeaderPhis.push_back(PN);
+    SetVector<Value*> LiveIns;
+    for (auto* BB : L->blocks())
+        for (auto& I : *BB) {
+            // Values entering through the header PHIs are already state.
+            if (isa<PHINode>(&I) && BB == Header)
+                continue;
+            for (auto& Op : I.operands())
+                if (isMigratedLiveIn(Op, L))
+                    LiveIns.insert(Op);
+        }
+    SmallVector<PHINode*, 8> LiveOuts;
+    for (auto II = Exit->begin(); auto* PN = dyn_cast<PHINode>(II); ++II)
+        LiveOuts.push_back(PN);
+
+    // SLM layout: [counter][GroupSize x state record][GroupSize x live-outs]
+    SmallVector<Value*, 16> StateVals(HeaderPhis.begin(), HeaderPhis.end());
+    StateVals.append(LiveIns.begin(), LiveIns.end());
+    SmallVector<Field, 16> StateFields;
+    unsigned RecSize = layoutFields(StateVals, 4, StateFields);
+    SmallVector<Value*, 8> OutVals(LiveOuts.begin(), LiveOuts.end());
+    SmallVector<Field, 8> OutFields;
+    unsigned OutSize = layoutFields(OutVals, 0, OutFields);
+
+    unsigned CounterAddr = SLMBase;
+    unsigned WorkBase = CounterAddr + 8;
+    unsigned OutBase = WorkBase + GroupSize * RecSize;
+    unsigned End = OutBase + GroupSize * OutSize;
+    if (End - SLMBase > IGC_GET_FLAG_VALUE(LaneCompactionMaxSLMSize) ||
+        End > MaxSLMSize)
+        return;
+    SLMBase = End;
+
+    Type* Int32Ty = Type::getInt32Ty(Ctx);
+    Constant* Counter = ConstantExpr::getIntToPtr(
+        ConstantInt::get(Int32Ty, CounterAddr),
+        PointerType::get(Int32Ty, ADDRESS_SPACE_LOCAL));
+
+    BasicBlock* NewHeader = BasicBlock::Create(Ctx, "lc.header", Func, Header);
+    BasicBlock* Tail = BasicBlock::Create(Ctx, "lc.latch", Func, Exit);
+    BasicBlock* Finish = BasicBlock::Create(Ctx, "lc.finish", Func, Tail);
+    BasicBlock* Compact = BasicBlock::Create(Ctx, "lc.compact", Func, Exit);
+    BasicBlock* Push = BasicBlock::Create(Ctx, "lc.push", Func, Exit);
+    BasicBlock* Pushed = BasicBlock::Create(Ctx, "lc.pushed", Func, Exit);
+    BasicBlock* Pull = BasicBlock::Create(Ctx, "lc.pull", Func, Exit);
+    BasicBlock* Pulled = BasicBlock::Create(Ctx, "lc.pulled", Func, Exit);
+    BasicBlock* NewExit = BasicBlock::Create(Ctx, "lc.exit", Func, Exit);
+
+    // Preheader: reset the counter; the first compaction barrier orders it.
+    IRBuilder<> IRB(Preheader->getTerminator());
+    IRB.CreateAlignedStore(IRB.getInt32(0), Counter, 4);
+    Preheader->getTerminator()->replaceUsesOfWith(Header, NewHeader);
+
+    // New header: the state as seen by this work-item's current work.
+    IRB.SetInsertPoint(NewHeader);
+    SmallVector<PHINode*, 16> CurVals;
+    for (Value* V : StateVals) {
+        PHINode* PN = IRB.CreatePHI(V->getType(), 3, V->getName() + ".lc");
+        PN->addIncoming(isa<PHINode>(V) && cast<PHINode>(V)->getParent() == Header ?
+            cast<PHINode>(V)->getIncomingValueForBlock(Preheader) : V, Preheader);
+        CurVals.push_back(PN);
+    }
+    PHINode* Active = IRB.CreatePHI(IRB.getInt1Ty(), 3, "lc.active");
+    Active->addIncoming(IRB.getTrue(), Preheader);
+    PHINode* Owner = IRB.CreatePHI(Int32Ty, 3, "lc.owner");
+    Owner->addIncoming(LocalId, Preheader);
+    PHINode* Iter = IRB.CreatePHI(Int32Ty, 3, "lc.iter");
+    Iter->addIncoming(IRB.getInt32(0), Preheader);
+    IRB.CreateCondBr(Active, Header, Tail);
+
+    // The original header is now only entered from the new one. Live-ins
+    // are read from the migrated copies. The latch value of a PHI may be
+    // another header PHI, so all of them are replaced before the latch values
+    // are read, and erased only after that.
+    for (unsigned i = 0, e = HeaderPhis.size(); i < e; ++i)
+        HeaderPhis[i]->replaceAllUsesWith(CurVals[i]);
+    SmallVector<Value*, 8> NextVals;
+    for (PHINode* PN : HeaderPhis)
+        NextVals.push_back(PN->getIncomingValueForBlock(Latch));
+    for (PHINode* PN : HeaderPhis)
+        PN->eraseFromParent();
+    for (unsigned i = HeaderPhis.size(), e = StateVals.size(); i < e; ++i) {
+        Value* V = StateVals[i];
+        SmallVector<Use*, 8> Uses;
+        for (auto& U : V->uses())
+            if (auto* UI = dyn_cast<Instruction>(U.getUser()))
+                if (L->contains(UI))
+                    Uses.push_back(&U);
+        for (auto* U : Uses)
+            U->set(CurVals[i]);
+        NextVals.push_back(CurVals[i]);
+    }
+
+    // Latch: the back edge continues to the new latch, the exit edge stores
+    // the live-outs for the owner.
+    auto* Br = cast<BranchInst>(Latch->getTerminator());
+    unsigned ContIdx = Br->getSuccessor(0) == Header ? 0 : 1;
+    Br->setSuccessor(ContIdx, Tail);
+    Br->setSuccessor(1 - ContIdx, Finish);
+    Br->setMetadata(LLVMContext::MD_loop, nullptr);
+
+    IRB.SetInsertPoint(Finish);
+    Value* OutAddr = IRB.CreateAdd(IRB.getInt32(OutBase),
+        IRB.CreateMul(Owner, IRB.getInt32(OutSize)));
+    for (auto& F : OutFields) {
+        Value* V = cast<PHINode>(F.V)->getIncomingValueForBlock(Latch);
+        storeSLM(IRB, V, IRB.CreateAdd(OutAddr, IRB.getInt32(F.Offset)));
+    }
+    IRB.CreateBr(Tail);
+
+    // New latch: count iterations and compact every K of them.
+    IRB.SetInsertPoint(Tail);
+    SmallVector<Value*, 16> TailVals;
+    for (unsigned i = 0, e = StateVals.size(); i < e; ++i) {
+        if (i >= HeaderPhis.size()) {
+            TailVals.push_back(CurVals[i]);
+            continue;
+        }
+        PHINode* PN = IRB.CreatePHI(CurVals[i]->getType(), 3);
+        PN->addIncoming(CurVals[i], NewHeader);
+        PN->addIncoming(NextVals[i], Latch);
+        PN->addIncoming(CurVals[i], Finish);
+        TailVals.push_back(PN);
+    }
+    PHINode* TailActive = IRB.CreatePHI(IRB.getInt1Ty(), 3, "lc.active.next");
+    TailActive->addIncoming(IRB.getFalse(), NewHeader);
+    TailActive->addIncoming(IRB.getTrue(), Latch);
+    TailActive->addIncoming(IRB.getFalse(), Finish);
+    Value* NextIter = IRB.CreateAdd(Iter, IRB.getInt32(1), "lc.iter.next");
+    unsigned Interval = std::max(1U, unsigned(IGC_GET_FLAG_VALUE(LaneCompactionInterval)));
+    Value* DoCompact = IRB.CreateICmpEQ(
+        IRB.CreateURem(NextIter, IRB.getInt32(Interval)), IRB.getInt32(0));
+    IRB.CreateCondBr(DoCompact, Compact, NewHeader);
+
+    // Compaction: the work-items still running take consecutive slots.
+    IRB.SetInsertPoint(Compact);
+    emitBarrier(IRB);
+    Type* AtomicTys[] = { Int32Ty, Counter->getType(), Int32Ty };
+    Function* AtomicFn = GenISAIntrinsic::getDeclaration(
+        Func->getParent(), GenISAIntrinsic::GenISA_intatomicraw, AtomicTys);
+    Value* AtomicArgs[] = {
+        Counter, IRB.getInt32(CounterAddr),
+        IRB.CreateZExt(TailActive, Int32Ty), IRB.getInt32(EATOMIC_IADD) };
+    Value* Slot = IRB.CreateCall(AtomicFn, AtomicArgs, "lc.slot");
+    IRB.CreateCondBr(TailActive, Push, Pushed);
+
+    IRB.SetInsertPoint(Push);
+    Value* PushAddr = IRB.CreateAdd(IRB.getInt32(WorkBase),
+        IRB.CreateMul(Slot, IRB.getInt32(RecSize)));
+    storeSLM(IRB, Owner, PushAddr);
+    for (unsigned i = 0, e = StateFields.size(); i < e; ++i)
+        storeSLM(IRB, TailVals[i],
+            IRB.CreateAdd(PushAddr, IRB.getInt32(StateFields[i].Offset)));
+    IRB.CreateBr(Pushed);
+
+    IRB.SetInsertPoint(Pushed);
+    emitBarrier(IRB);
+    Value* Count = IRB.CreateAlignedLoad(Counter, 4, "lc.count");
+    Value* HasWork = IRB.CreateICmpULT(LocalId, Count, "lc.haswork");
+    IRB.CreateCondBr(HasWork, Pull, Pulled);
+
+    IRB.SetInsertPoint(Pull);
+    Value* PullAddr = IRB.CreateAdd(IRB.getInt32(WorkBase),
+        IRB.CreateMul(LocalId, IRB.getInt32(RecSize)));
+    Value* PulledOwner = loadSLM(IRB, Int32Ty, PullAddr);
+    SmallVector<Value*, 16> PulledVals;
+    for (unsigned i = 0, e = StateFields.size(); i < e; ++i)
+        PulledVals.push_back(loadSLM(IRB, StateVals[i]->getType(),
+            IRB.CreateAdd(PullAddr, IRB.getInt32(StateFields[i].Offset))));
+    IRB.CreateBr(Pulled);
+
+    // Work-items without work keep their stale state; it is never used.
+    IRB.SetInsertPoint(Pulled);
+    for (unsigned i = 0, e = StateVals.size(); i < e; ++i) {
+        PHINode* PN = IRB.CreatePHI(StateVals[i]->getType(), 2);
+        PN->addIncoming(PulledVals[i], Pull);
+        PN->addIncoming(TailVals[i], Pushed);
+        CurVals[i]->addIncoming(TailVals[i], Tail);
+        CurVals[i]->addIncoming(PN, Pulled);
+    }
+    PHINode* NewOwner = IRB.CreatePHI(Int32Ty, 2);
+    NewOwner->addIncoming(PulledOwner, Pull);
+    NewOwner->addIncoming(Owner, Pushed);
+    Active->addIncoming(TailActive, Tail);
+    Active->addIncoming(HasWork, Pulled);
+    Owner->addIncoming(Owner, Tail);
+    Owner->addIncoming(NewOwner, Pulled);
+    Iter->addIncoming(NextIter, Tail);
+    Iter->addIncoming(NextIter, Pulled);
+    // Everyone has read the counter, reset it for the next round.
+    emitBarrier(IRB);
+    IRB.CreateAlignedStore(IRB.getInt32(0), Counter, 4);
+    IRB.CreateCondBr(IRB.CreateICmpEQ(Count, IRB.getInt32(0)), NewExit, NewHeader);
+
+    // Exit: read back the live-outs of this work-item's own work.
+    IRB.SetInsertPoint(NewExit);
+    Value* ResAddr = IRB.CreateAdd(IRB.getInt32(OutBase),
+        IRB.CreateMul(LocalId, IRB.getInt32(OutSize)));
+    for (auto& F : OutFields) {
+        PHINode* PN = cast<PHINode>(F.V);
+        Value* V = loadSLM(IRB, PN->getType(),
+            IRB.CreateAdd(ResAddr, IRB.getInt32(F.Offset)));
+        PN->replaceAllUsesWith(V);
+        PN->eraseFromParent();
+    }
+    IRB.CreateBr(Exit);
+}
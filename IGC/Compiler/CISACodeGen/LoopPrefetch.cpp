@@ -0,0 +1,310 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/DepthFirstIterator.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/ScalarEvolution.h>
+#include <llvm/Analysis/ScalarEvolutionExpressions.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/Pass.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvmWrapper/Transforms/Utils/ScalarEvolutionExpander.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
+#include "Compiler/IGCPassSupport.h"
+#include "Compiler/MetaDataUtilsWrapper.h"
+#include "Compiler/CISACodeGen/LoopPrefetch.h"
+#include "common/debug/Debug.hpp"
+#include "common/debug/Dump.hpp"
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+namespace {
+    // Legacy dataport read latency in the vISA latency table.
+    const unsigned SendLatency = 400;
+    // Rough issue cycles per IR instruction for SIMD16.
+    const unsigned CyclesPerInst = 4;
+    const unsigned MaxDistance = 16;
+    const unsigned CacheLineSize = 64;
+
+    // This pass warms the cache for affine, loop-strided global loads in
+    // innermost loops. For each such load, a volatile load of the address the
+    // same load accesses `D` iterations later is issued at the loop latch. Its
+    // result is never used, so the send retires in the background while the
+    // loop keeps running. The prefetched iteration is clamped to the last
+    // iteration so that only addresses the loop itself reads are touched.
+    //
+    // `D` is derived from the dataport read latency used by the vISA
+    // scheduler and the estimated cycles per loop iteration, unless it's
+    // overridden by the LoopPrefetchDistance regkey.
+    //
+    class LoopPrefetch : public FunctionPass {
+        const DataLayout* DL;
+        DominatorTree* DT;
+        LoopInfo* LI;
+        ScalarEvolution* SE;
+        CodeGenContext* CGC;
+
+        unsigned NumPrefetches;
+        std::string Report;
+
+    public:
+        static char ID;
+
+        LoopPrefetch() : FunctionPass(ID), DL(nullptr), DT(nullptr),
+            LI(nullptr), SE(nullptr), CGC(nullptr), NumPrefetches(0) {
+            initializeLoopPrefetchPass(*PassRegistry::getPassRegistry());
+        }
+
+        bool runOnFunction(Function& F) override;
+
+        StringRef getPassName() const override { return "Loop Prefetch"; }
+
+    private:
+        void getAnalysisUsage(AnalysisUsage& AU) const override {
+            AU.setPreservesCFG();
+            AU.addRequired<CodeGenContextWrapper>();
+            AU.addRequired<MetaDataUtilsWrapper>();
+            AU.addRequired<DominatorTreeWrapperPass>();
+            AU.addRequired<LoopInfoWrapperPass>();
+            AU.addRequired<ScalarEvolutionWrapperPass>();
+        }
+
+        unsigned getDistance(const Loop* L) const;
+        const SCEVAddRecExpr* getStream(LoadInst* LD, const Loop* L) const;
+        bool processLoop(Loop* L);
+        void dumpReport(const Function& F) const;
+    };
+
+    char LoopPrefetch::ID = 0;
+
+} // End anonymous namespace
+
+FunctionPass* IGC::createLoopPrefetchPass() {
+    return new LoopPrefetch();
+}
+
+#define PASS_FLAG     "igc-loop-prefetch"
+#define PASS_DESC     "Loop-aware prefetch insertion"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+namespace IGC {
+    IGC_INITIALIZE_PASS_BEGIN(LoopPrefetch, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+        IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+        IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
+        IGC_INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+        IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+        IGC_INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass);
+    IGC_INITIALIZE_PASS_END(LoopPrefetch, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+} // End namespace IGC
+
+bool LoopPrefetch::runOnFunction(Function& F) {
+    // Skip non-kernel function.
+    MetaDataUtils* MDU = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+    auto FII = MDU->findFunctionsInfoItem(&F);
+    if (FII == MDU->end_FunctionsInfo())
+        return false;
+
+    DL = &F.getParent()->getDataLayout();
+    DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    CGC = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    NumPrefetches = 0;
+    Report.clear();
+
+    SmallVector<Loop*, 8> InnermostLoops;
+    for (auto I = LI->begin(), E = LI->end(); I != E; ++I)
+        for (auto DFI = df_begin(*I), DFE = df_end(*I); DFI != DFE; ++DFI) {
+            Loop* L = *DFI;
+            if (L->empty())
+                InnermostLoops.push_back(L);
+        }
+
+    bool Changed = false;
+    for (Loop* L : InnermostLoops)
+        Changed |= processLoop(L);
+
+    if (IGC_IS_FLAG_ENABLED(DumpLoopPrefetch))
+        dumpReport(F);
+
+    return Changed;
+}
+
+/// getDistance() - returns the number of iterations to prefetch ahead so
+/// that the send latency is covered by the work of the iterations in between.
+unsigned LoopPrefetch::getDistance(const Loop* L) const {
+    unsigned Distance = IGC_GET_FLAG_VALUE(LoopPrefetchDistance);
+    if (Distance != 0)
+        return Distance;
+
+    unsigned NumInsts = 0;
+    for (auto* BB : L->blocks())
+        NumInsts += unsigned(BB->size());
+    unsigned CyclesPerIter = std::max(1U, NumInsts * CyclesPerInst);
+    Distance = (SendLatency + CyclesPerIter - 1) / CyclesPerIter;
+    return std::min(Distance, MaxDistance);
+}
+
+/// getStream() - returns the affine recurrence of the load's address in `L`
+/// if it's a global load executed once per iteration with a constant stride.
+const SCEVAddRecExpr* LoopPrefetch::getStream(LoadInst* LD, const Loop* L) const {
+    if (!LD->isSimple() ||
+        LD->getPointerAddressSpace() != ADDRESS_SPACE_GLOBAL)
+        return nullptr;
+
+    // The load must run in every iteration, including the last one, so that
+    // every address we prefetch is one the loop reads anyway.
+    if (!DT->dominates(LD->getParent(), L->getLoopLatch()))
+        return nullptr;
+
+    auto* AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(LD->getPointerOperand()));
+    if (!AR || AR->getLoop() != L || !AR->isAffine())
+        return nullptr;
+
+    auto* Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+    if (!Step || Step->getValue()->isZero())
+        return nullptr;
+
+    if (!isSafeToExpand(AR->getStart(), *SE))
+        return nullptr;
+
+    return AR;
+}
+
+bool LoopPrefetch::processLoop(Loop* L) {
+    // Only bottom-tested loops are handled, where the backedge-taken count is
+    // also the index of the last iteration of every load dominating the latch.
+    BasicBlock* Latch = L->getLoopLatch();
+    if (!Latch || L->getExitingBlock() != Latch)
+        return false;
+
+    const SCEV* BTC = SE->getBackedgeTakenCount(L);
+    if (isa<SCEVCouldNotCompute>(BTC) || !isSafeToExpand(BTC, *SE))
+        return false;
+
+    unsigned Distance = getDistance(L);
+    unsigned MaxStreams = IGC_GET_FLAG_VALUE(LoopPrefetchMaxStreams);
+
+    SmallVector<std::pair<LoadInst*, const SCEVAddRecExpr*>, 4> Streams;
+    for (auto* BB : L->blocks()) {
+        for (auto& I : *BB) {
+            LoadInst* LD = dyn_cast<LoadInst>(&I);
+            if (!LD)
+                continue;
+            const SCEVAddRecExpr* AR = getStream(LD, L);
+            if (!AR)
+                continue;
+
+            // Skip streams hitting the same cache lines as a previous one.
+            bool SameLines = false;
+            for (auto& S : Streams) {
+                if (S.second->getStepRecurrence(*SE) != AR->getStepRecurrence(*SE))
+                    continue;
+                auto* Diff = dyn_cast<SCEVConstant>(
+                    SE->getMinusSCEV(AR->getStart(), S.second->getStart()));
+                if (Diff && Diff->getAPInt().abs().ult(CacheLineSize)) {
+                    SameLines = true;
+                    break;
+                }
+            }
+            if (SameLines)
+                continue;
+
+            Streams.push_back(std::make_pair(LD, AR));
+            if (Streams.size() >= MaxStreams)
+                break;
+        }
+        if (Streams.size() >= MaxStreams)
+            break;
+    }
+
+    if (Streams.empty())
+        return false;
+
+    // The prefetched iteration is min(i + D, BTC), where i is the current
+    // iteration.
+    Type* IterTy = BTC->getType();
+    const SCEV* Ahead = SE->getAddRecExpr(SE->getConstant(IterTy, Distance),
+        SE->getConstant(IterTy, 1), L, SCEV::FlagAnyWrap);
+    const SCEV* Iter = SE->getUMinExpr(Ahead, BTC);
+
+    SCEVExpander Expander(*SE, *DL, "prefetch");
+    Instruction* InsertPt = Latch->getTerminator();
+    IRBuilder<> Builder(InsertPt);
+
+    for (auto& S : Streams) {
+        LoadInst* LD = S.first;
+        const SCEVAddRecExpr* AR = S.second;
+        const SCEV* Step = AR->getStepRecurrence(*SE);
+        const SCEV* Offset = SE->getMulExpr(
+            SE->getTruncateOrZeroExtend(Iter, Step->getType()), Step);
+        const SCEV* Addr = SE->getAddExpr(AR->getStart(), Offset);
+
+        Value* Ptr = Expander.expandCodeFor(Addr,
+            LD->getPointerOperandType(), InsertPt);
+        // Mark it as volatile so that it survives as a dead load.
+        LoadInst* Prefetch =
+            Builder.CreateAlignedLoad(Ptr, LD->getAlignment(), true, "prefetch");
+        Prefetch->setDebugLoc(LD->getDebugLoc());
+        ++NumPrefetches;
+
+        if (IGC_IS_FLAG_ENABLED(DumpLoopPrefetch)) {
+            raw_string_ostream OS(Report);
+            OS << "  loop " << L->getHeader()->getName()
+                << ": stride " << cast<SCEVConstant>(Step)->getAPInt().getSExtValue()
+                << " bytes, distance " << Distance << " iterations, load";
+            LD->print(OS);
+            OS << "\n";
+        }
+    }
+
+    return true;
+}
+
+void LoopPrefetch::dumpReport(const Function& F) const {
+    using namespace IGC::Debug;
+    auto name =
+        DumpName(GetShaderOutputName())
+        .Hash(CGC->hash)
+        .Type(CGC->type)
+        .Pass("loopprefetch")
+        .PostFix(F.getName().str())
+        .Retry(CGC->m_retryManager.GetRetryId())
+        .Extension("txt");
+
+    Dump prefetchDump(name, DumpType::DBG_MSG_TEXT);
+
+    DumpLock();
+    prefetchDump.stream() << "Kernel " << F.getName() << ": "
+        << NumPrefetches << " prefetches inserted\n" << Report;
+    DumpUnlock();
+}
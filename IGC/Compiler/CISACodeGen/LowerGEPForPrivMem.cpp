@@ -45,7 +45,6 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/LLVMWarningsPop.hpp"
 
 #define MAX_ALLOCA_PROMOTE_GRF_NUM      48
-#define MAX_PRESSURE_GRF_NUM            64
 
 using namespace llvm;
 using namespace IGC;
@@ -251,10 +250,12 @@ bool LowerGEPForPrivMem::CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca)
     }
     unsigned int allocaSize = extractAllocaSize(pAlloca);
     unsigned int allowedAllocaSizeInBytes = MAX_ALLOCA_PROMOTE_GRF_NUM * 4;
+    uint32_t maxGRFPressure = IGC_GET_FLAG_VALUE(PromotePrivArrayGRFBudget) * 4;
 
     // scale alloc size based on the number of GRFs we have
     float grfRatio = m_ctx->getNumGRFPerThread() / 128.0f;
     allowedAllocaSizeInBytes = (uint32_t)(allowedAllocaSizeInBytes * grfRatio);
+    maxGRFPressure = (uint32_t)(maxGRFPressure * grfRatio);
 
     if (m_ctx->type == ShaderType::COMPUTE_SHADER)
     {
@@ -263,6 +264,7 @@ bool LowerGEPForPrivMem::CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca)
         unsigned d = simdMode == SIMDMode::SIMD32 ? 4 : 1;
 
         allowedAllocaSizeInBytes = allowedAllocaSizeInBytes / d;
+        maxGRFPressure = maxGRFPressure / d;
     }
     Type* baseType = nullptr;
     if (!CanUseSOALayout(pAlloca, baseType))
@@ -285,15 +287,12 @@ bool LowerGEPForPrivMem::CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca)
         return true;
     }
 
-    // if alloca size exceeds alloc size threshold, return false
-    if (allocaSize > allowedAllocaSizeInBytes)
-    {
-        return false;
-    }
-    // if no live range info
+    // if no live range info, fall back to the fixed alloca size threshold.
+    // Otherwise the register pressure budget below is the only limit, so
+    // larger dynamically indexed arrays get promoted where registers allow.
     if (!m_pRegisterPressureEstimate->isAvailable())
     {
-        return true;
+        return allocaSize <= allowedAllocaSizeInBytes;
     }
 
     // get all the basic blocks that contain the uses of the alloca
@@ -303,8 +302,6 @@ bool LowerGEPForPrivMem::CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca)
 
     GetAllocaLiverange(pAlloca, lowestAssignedNumber, highestAssignedNumber, m_pRegisterPressureEstimate);
 
-    uint32_t maxGRFPressure = (uint32_t)(grfRatio * MAX_PRESSURE_GRF_NUM * 4);
-
     unsigned int pressure = 0;
     for (unsigned int i = lowestAssignedNumber; i <= highestAssignedNumber; i++)
     {
@@ -315,8 +312,7 @@ bool LowerGEPForPrivMem::CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca)
     for (auto it : m_promotedLiveranges)
     {
         // check interval intersection
-        if ((it.lowId < lowestAssignedNumber && it.highId > lowestAssignedNumber) ||
-            (it.lowId > lowestAssignedNumber && it.lowId < highestAssignedNumber))
+        if (it.lowId <= highestAssignedNumber && it.highId >= lowestAssignedNumber)
         {
             pressure += it.varSize;
         }
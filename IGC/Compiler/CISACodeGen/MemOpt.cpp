@@ -24,15 +24,19 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ======================= end_copyright_notice ==================================*/
 #include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/MapVector.h>
 #include <llvm/ADT/STLExtras.h>
 #include <llvmWrapper/Analysis/MemoryLocation.h>
 #include <llvmWrapper/Analysis/TargetLibraryInfo.h>
 #include <llvm/Analysis/AliasAnalysis.h>
 #include <llvm/Analysis/InstructionSimplify.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/PostDominators.h>
 #include <llvm/Analysis/ScalarEvolution.h>
 #include <llvm/Analysis/ScalarEvolutionExpressions.h>
 #include <llvm/Analysis/ValueTracking.h>
 #include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Dominators.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/GlobalAlias.h>
 #include <llvm/IR/IRBuilder.h>
@@ -59,6 +63,9 @@ DEBUG_COUNTER(MergeLoadCounter, "memopt-merge-load",
 DEBUG_COUNTER(MergeStoreCounter, "memopt-merge-store",
     "Controls count of merged stores");
 
+DEBUG_COUNTER(CrossBBMoveCounter, "memopt-cross-bb",
+    "Controls count of loads/stores moved across blocks");
+
 namespace {
     // This pass merge consecutive loads/stores within a BB when it's safe:
     // - Two loads (one of them is denoted as the leading load if it happens
@@ -71,11 +78,20 @@ namespace {
     //   the non-tailing store is merged into the tailing one, iff there's no
     //   memory dependency between them which may results in different result.
     //
+    // Before merging within each BB, loads/stores in control-equivalent blocks
+    // are paired through an index keyed by their symbolic base pointer. If two
+    // of them access adjacent locations and nothing in between may alias, the
+    // later load is hoisted next to the earlier one (or the earlier store is
+    // sunk next to the later one) so that the per-BB merging picks them up.
+    //
     class MemOpt : public FunctionPass {
         const DataLayout* DL;
         AliasAnalysis* AA;
         ScalarEvolution* SE;
         WIAnalysis* WI;
+        DominatorTree* DT;
+        PostDominatorTree* PDT;
+        LoopInfo* LI;
 
         CodeGenContext* CGC;
         TargetLibraryInfo* TLI;
@@ -98,7 +114,7 @@ namespace {
 
         MemOpt(bool AllowNegativeSymPtrsForLoad = false) :
             FunctionPass(ID), DL(nullptr), AA(nullptr), SE(nullptr), WI(nullptr),
-            CGC(nullptr), AllowNegativeSymPtrsForLoad(AllowNegativeSymPtrsForLoad) {
+            DT(nullptr), PDT(nullptr), LI(nullptr), CGC(nullptr), AllowNegativeSymPtrsForLoad(AllowNegativeSymPtrsForLoad) {
             initializeMemOptPass(*PassRegistry::getPassRegistry());
         }
 
@@ -113,10 +129,21 @@ namespace {
             AU.addRequired<TargetLibraryInfoWrapperPass>();
             AU.addRequired<ScalarEvolutionWrapperPass>();
             AU.addRequired<WIAnalysis>();
+            AU.addRequired<DominatorTreeWrapperPass>();
+            AU.addRequired<PostDominatorTreeWrapperPass>();
+            AU.addRequired<LoopInfoWrapperPass>();
         }
 
         void buildProfitVectorLengths(Function& F);
 
+        bool moveAcrossBlocks(Function& F);
+        bool isControlEquivalent(const BasicBlock* Dom,
+            const BasicBlock* BB) const;
+        bool collectInstsBetween(Instruction* From, Instruction* To,
+            SmallVectorImpl<Instruction*>& CheckList) const;
+        bool collectHoistablePtr(Value* V, const Instruction* InsertPt,
+            SmallVectorImpl<Instruction*>& ToHoist, unsigned Depth) const;
+
         bool mergeLoad(LoadInst* LeadingLoad, MemRefListTy::iterator MI,
             MemRefListTy& MemRefs, TrivialMemRefListTy& ToOpt);
         bool mergeStore(StoreInst* LeadingStore, MemRefListTy::iterator MI,
@@ -176,6 +203,8 @@ namespace {
         bool isSafeToMergeStores(
             const SmallVectorImpl<std::tuple<StoreInst*, int64_t, MemRefListTy::iterator>>& Stores,
             const SmallVectorImpl<Instruction*>& checkList) const;
+        bool isSafeToSinkStore(const StoreInst* St,
+            const SmallVectorImpl<Instruction*>& checkList) const;
 
         bool shouldSkip(const Value* Ptr) const {
             PointerType* PtrTy = cast<PointerType>(Ptr->getType());
@@ -371,6 +400,9 @@ IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
 IGC_INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 IGC_INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 IGC_INITIALIZE_PASS_DEPENDENCY(WIAnalysis)
+IGC_INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 IGC_INITIALIZE_PASS_END(MemOpt, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
 
 char MemOpt::ID = 0;
@@ -411,6 +443,9 @@ bool MemOpt::runOnFunction(Function& F) {
     AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
     SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
     WI = &getAnalysis<WIAnalysis>();
+    DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    PDT = &getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+    LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
 
     CGC = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
     TLI = &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
@@ -420,6 +455,9 @@ bool MemOpt::runOnFunction(Function& F) {
 
     bool Changed = false;
 
+    if (IGC_IS_FLAG_ENABLED(EnableMemOptCrossBB))
+        Changed |= moveAcrossBlocks(F);
+
     for (Function::iterator BB = F.begin(), BBE = F.end(); BB != BBE; ++BB) {
         // Find all instructions with memory reference. Remember the distance one
         // by one.
@@ -469,6 +507,212 @@ bool MemOpt::runOnFunction(Function& F) {
     DL = nullptr;
     AA = nullptr;
     SE = nullptr;
+    DT = nullptr;
+    PDT = nullptr;
+    LI = nullptr;
+
+    return Changed;
+}
+
+/// isControlEquivalent() - checks whether `BB` is executed exactly once each
+/// time `Dom` is executed, i.e. `Dom` dominates `BB`, `BB` post-dominates
+/// `Dom` and both are in the same loop.
+bool MemOpt::isControlEquivalent(const BasicBlock* Dom,
+    const BasicBlock* BB) const {
+    if (Dom == BB)
+        return false;
+    if (LI->getLoopFor(Dom) != LI->getLoopFor(BB))
+        return false;
+    return DT->dominates(Dom, BB) && PDT->dominates(BB, Dom);
+}
+
+/// collectInstsBetween() - collects all memory references which may execute
+/// between `From` and `To`, where `To`'s block is control-equivalent to
+/// `From`'s block. Returns false if the region is larger than the memopt
+/// window, as moving across it would create long live ranges.
+bool MemOpt::collectInstsBetween(Instruction* From, Instruction* To,
+    SmallVectorImpl<Instruction*>& CheckList) const {
+    BasicBlock* FromBB = From->getParent();
+    BasicBlock* ToBB = To->getParent();
+    unsigned Limit = IGC_GET_FLAG_VALUE(MemOptWindowSize);
+    unsigned Count = 0;
+
+    auto visit = [&](BasicBlock::iterator BI, BasicBlock::iterator BE) {
+        for (; BI != BE; ++BI) {
+            if (++Count > Limit)
+                return false;
+            if (BI->mayReadOrWriteMemory())
+                CheckList.push_back(&*BI);
+        }
+        return true;
+    };
+
+    if (!visit(std::next(From->getIterator()), FromBB->end()) ||
+        !visit(ToBB->begin(), To->getIterator()))
+        return false;
+
+    // Walk backward from `To` until `From`'s block is reached. As `FromBB`
+    // dominates `ToBB`, that covers all blocks on paths in between.
+    SmallPtrSet<BasicBlock*, 8> Visited;
+    SmallVector<BasicBlock*, 8> Worklist(pred_begin(ToBB), pred_end(ToBB));
+    Visited.insert(FromBB);
+    Visited.insert(ToBB);
+    while (!Worklist.empty()) {
+        BasicBlock* BB = Worklist.pop_back_val();
+        if (!Visited.insert(BB).second)
+            continue;
+        if (BB == &BB->getParent()->getEntryBlock())
+            return false;
+        if (!visit(BB->begin(), BB->end()))
+            return false;
+        Worklist.append(pred_begin(BB), pred_end(BB));
+    }
+
+    return true;
+}
+
+/// collectHoistablePtr() - checks whether the pointer `V` is available at
+/// `InsertPt` or could be made available by hoisting its side-effect-free
+/// computation. Instructions to be hoisted are collected in def-before-use
+/// order.
+bool MemOpt::collectHoistablePtr(Value* V, const Instruction* InsertPt,
+    SmallVectorImpl<Instruction*>& ToHoist, unsigned Depth) const {
+    Instruction* I = dyn_cast<Instruction>(V);
+    if (!I || DT->dominates(I, InsertPt) || is_contained(ToHoist, I))
+        return true;
+
+    if (Depth == 0 || isa<PHINode>(I) || I->mayReadOrWriteMemory() ||
+        !isSafeToSpeculativelyExecute(I))
+        return false;
+
+    for (Value* Op : I->operands())
+        if (!collectHoistablePtr(Op, InsertPt, ToHoist, Depth - 1))
+            return false;
+
+    ToHoist.push_back(I);
+    return true;
+}
+
+/// moveAcrossBlocks() - indexes simple loads/stores by their symbolic base
+/// pointer and, for each pair in control-equivalent blocks accessing adjacent
+/// locations, moves one next to the other so they could be merged later.
+bool MemOpt::moveAcrossBlocks(Function& F) {
+    typedef std::pair<Instruction*, SymbolicPointer> IndexEntry;
+    typedef std::pair<const Value*, unsigned> IndexKey;
+    MapVector<IndexKey, SmallVector<IndexEntry, 8> > Index;
+
+    for (auto& BB : F) {
+        for (auto& I : BB) {
+            Value* Ptr = nullptr;
+            if (LoadInst * LD = dyn_cast<LoadInst>(&I)) {
+                if (LD->isSimple() && !LD->getType()->isPointerTy())
+                    Ptr = LD->getPointerOperand();
+            }
+            else if (StoreInst * ST = dyn_cast<StoreInst>(&I)) {
+                if (ST->isSimple() &&
+                    !ST->getValueOperand()->getType()->isPointerTy())
+                    Ptr = ST->getPointerOperand();
+            }
+            if (!Ptr || shouldSkip(&I))
+                continue;
+
+            SymbolicPointer SymPtr;
+            if (SymbolicPointer::decomposePointer(Ptr, SymPtr, CGC) ||
+                !SymPtr.BasePtr)
+                continue;
+
+            IndexKey Key(SymPtr.BasePtr, Ptr->getType()->getPointerAddressSpace());
+            Index[Key].push_back(std::make_pair(&I, SymPtr));
+        }
+    }
+
+    // Bound the quadratic pairing below on pathological buckets.
+    const unsigned MaxBucketSize = 64;
+
+    bool Changed = false;
+    SmallPtrSet<Instruction*, 16> Moved;
+    for (auto& Bucket : Index) {
+        auto& Entries = Bucket.second;
+        if (Entries.size() < 2 || Entries.size() > MaxBucketSize)
+            continue;
+
+        for (auto& X : Entries) {
+            for (auto& Y : Entries) {
+                Instruction* First = X.first;
+                Instruction* Second = Y.first;
+                if (Moved.count(First) || Moved.count(Second))
+                    continue;
+                if (isa<LoadInst>(First) != isa<LoadInst>(Second))
+                    continue;
+                if (!isControlEquivalent(First->getParent(), Second->getParent()))
+                    continue;
+
+                bool IsLoad = isa<LoadInst>(First);
+                Type* FirstTy = IsLoad ? First->getType() :
+                    cast<StoreInst>(First)->getValueOperand()->getType();
+                Type* SecondTy = IsLoad ? Second->getType() :
+                    cast<StoreInst>(Second)->getValueOperand()->getType();
+                Type* ScalarTy = FirstTy->getScalarType();
+                if (!hasSameSize(ScalarTy, SecondTy->getScalarType()))
+                    continue;
+
+                // Offset of `Second` relative to `First`.
+                int64_t Off = 0;
+                if (Y.second.getConstantOffset(X.second, Off))
+                    continue;
+
+                // Only move adjacent accesses forming a profitable vector;
+                // otherwise the move just extends live ranges.
+                int64_t FirstSize = int64_t(DL->getTypeStoreSize(FirstTy));
+                int64_t SecondSize = int64_t(DL->getTypeStoreSize(SecondTy));
+                if (Off != FirstSize && Off != -SecondSize)
+                    continue;
+
+                unsigned ScalarBits = unsigned(DL->getTypeSizeInBits(ScalarTy));
+                if (!ProfitVectorLengths.count(ScalarBits))
+                    continue;
+                unsigned NumElts =
+                    getNumElements(FirstTy) + getNumElements(SecondTy);
+                if (!is_contained(ProfitVectorLengths[ScalarBits], NumElts))
+                    continue;
+
+                SmallVector<Instruction*, 8> CheckList;
+                if (!collectInstsBetween(First, Second, CheckList))
+                    continue;
+
+                if (IsLoad) {
+                    // Hoist `Second` right after `First`.
+                    LoadInst* LD = cast<LoadInst>(Second);
+                    Instruction* InsertPt = First->getNextNode();
+                    SmallVector<Instruction*, 4> ToHoist;
+                    if (!collectHoistablePtr(LD->getPointerOperand(), InsertPt,
+                        ToHoist, SymbolicPointer::MaxLookupSearchDepth))
+                        continue;
+                    if (!isSafeToMergeLoad(LD, CheckList))
+                        continue;
+                    if (!DebugCounter::shouldExecute(CrossBBMoveCounter))
+                        continue;
+                    for (auto* I : ToHoist)
+                        I->moveBefore(InsertPt);
+                    LD->moveBefore(InsertPt);
+                }
+                else {
+                    // Sink `First` right before `Second`. Its operands are
+                    // defined in a dominating block and remain available.
+                    StoreInst* ST = cast<StoreInst>(First);
+                    if (!isSafeToSinkStore(ST, CheckList))
+                        continue;
+                    if (!DebugCounter::shouldExecute(CrossBBMoveCounter))
+                        continue;
+                    ST->moveBefore(Second);
+                }
+
+                Moved.insert(First);
+                Moved.insert(Second);
+                Changed = true;
+            }
+        }
+    }
 
     return Changed;
 }
@@ -1176,6 +1420,25 @@ bool MemOpt::isSafeToMergeStores(
     return true;
 }
 
+/// isSafeToSinkStore() - checks whether there is any alias from the specified
+/// store to any one in the check list, which may read/write to that location.
+bool MemOpt::isSafeToSinkStore(const StoreInst* St,
+    const SmallVectorImpl<Instruction*>& CheckList) const {
+    MemoryLocation B = MemoryLocation::get(St);
+
+    for (auto* I : CheckList) {
+        if (I->getMetadata(LLVMContext::MD_invariant_load))
+            continue;
+
+        MemoryLocation A = getLocation(I);
+
+        if (!A.Ptr || !B.Ptr || AA->alias(A, B))
+            return false;
+    }
+
+    return true;
+}
+
 class ExtOperator : public Operator {
 public:
     static inline bool classof(const Instruction* I) {
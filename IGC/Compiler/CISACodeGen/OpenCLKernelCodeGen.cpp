@@ -38,6 +38,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/Optimizer/OpenCLPasses/LocalBuffers/InlineLocalsResolution.hpp"
 #include "Compiler/Optimizer/OpenCLPasses/KernelArgs.hpp"
 #include "Compiler/CISACodeGen/EmitVISAPass.hpp"
+#include "Compiler/CISACodeGen/ProfileGuided.h"
 #include "Compiler/Optimizer/OCLBIUtils.h"
 #include "AdaptorOCL/OCL/KernelAnnotations.hpp"
 #include "common/allocator.h"
@@ -2228,6 +2229,15 @@ namespace IGC
                 }
             }
 
+            // A profile that timed this kernel at several SIMD widths overrides
+            // the static profitability heuristics below.
+            unsigned pgoSIMDSize = getPGOPreferredSIMDSize(m_FGA ? *m_FGA->getGroup(&F)->getHead() : F);
+            if (pgoSIMDSize != 0 && numLanes(simdMode) > pgoSIMDSize)
+            {
+                return SIMDStatus::SIMD_PERF_FAIL;
+            }
+            bool pgoPrefersSIMD = pgoSIMDSize == numLanes(simdMode);
+
             // Here we check profitablility, etc.
             if (simdMode == SIMDMode::SIMD16)
             {
@@ -2245,13 +2255,18 @@ namespace IGC
 
                 // bail out of SIMD16 if it's not profitable.
                 Simd32ProfitabilityAnalysis& PA = EP.getAnalysis<Simd32ProfitabilityAnalysis>();
-                if (!PA.isSimd16Profitable())
+                if (!pgoPrefersSIMD && !PA.isSimd16Profitable())
                 {
                     return SIMDStatus::SIMD_PERF_FAIL;
                 }
             }
             if (simdMode == SIMDMode::SIMD32)
             {
+                // Tier-0 compiles never attempt SIMD32.
+                if (modMD->compOpt.FastCompilation)
+                {
+                    return SIMDStatus::SIMD_PERF_FAIL;
+                }
                 if (pCtx->m_instrTypes.hasDebugInfo)
                 {
                     bool hasFullDebugInfo = false;
@@ -2265,7 +2280,7 @@ namespace IGC
                 }
                 // bail out of SIMD32 if it's not profitable.
                 Simd32ProfitabilityAnalysis& PA = EP.getAnalysis<Simd32ProfitabilityAnalysis>();
-                if (!PA.isSimd32Profitable())
+                if (!pgoPrefersSIMD && !PA.isSimd32Profitable())
                 {
                     return SIMDStatus::SIMD_PERF_FAIL;
                 }
@@ -0,0 +1,494 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Pass.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/LineIterator.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
+#include "Compiler/CISACodeGen/helper.h"
+#include "Compiler/IGCPassSupport.h"
+#include "Compiler/MetaDataUtilsWrapper.h"
+#include "Compiler/CISACodeGen/ProfileGuided.h"
+#include "common/debug/Debug.hpp"
+#include "common/debug/Dump.hpp"
+#include "common/igc_regkeys.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+static cl::opt<std::string> PGOFeedbackFileOpt(
+    "igc-pgo-feedback-file", cl::init(""), cl::Hidden,
+    cl::desc("Feedback file to annotate kernels with (overrides the PGOFeedbackFile regkey)"));
+
+// Profile-guided compilation of OpenCL kernels works in two steps.
+//
+// With EnablePGOInstrumentation, every basic block of a kernel atomically
+// increments its own 32-bit counter in a program-scope global buffer named
+// `__igc_pgo_counters_<kernel>`. The counters are laid out in the order of
+// the blocks in the function at the point the instrumentation runs. A map of
+// the counters is written to the dump directory as `*_pgomap.txt`; it is in
+// the feedback file format, with all counts set to zero.
+//
+// With PGOFeedbackFile pointing to such a file, filled in by whatever runtime
+// collected the counters, the blocks of matching kernels are annotated:
+//
+//   shader <asm hash>                   selects the shader the lines below
+//                                       apply to (16 hex digits)
+//   kernel <name> <cfg checksum>        selects a kernel of that shader
+//   block <index> <count>               executions of the block `index`
+//   simd <width> <time>                 observed execution time of the
+//                                       kernel compiled for that SIMD width
+//
+// Lines starting with '#' and lines with unknown keywords are ignored. A
+// kernel whose CFG checksum doesn't match the IR is left alone, so a stale
+// profile can't be applied to a changed kernel. A preferred SIMD width is
+// only derived when at least two widths were timed.
+//
+// The annotation only records the profile in the IR. Each block count is
+// attached to the block terminator as !igc.pgo.count, edge counts derived
+// from the block counts become !prof branch weights, and the fastest SIMD
+// width becomes the "igc-pgo-simd" function attribute. The consumers (block
+// layout, SIMD selection, loop unrolling and code sinking) query them through
+// the helpers at the end of this file.
+
+namespace {
+    const char* const CounterPrefix = "__igc_pgo_counters_";
+    const char* const CountMDName = "igc.pgo.count";
+    const char* const ProfileAttr = "igc-pgo";
+    const char* const SIMDAttr = "igc-pgo-simd";
+
+    /// Numbers the blocks of F in layout order.
+    void numberBlocks(Function& F, DenseMap<const BasicBlock*, unsigned>& Index) {
+        unsigned N = 0;
+        for (auto& BB : F)
+            Index[&BB] = N++;
+    }
+
+    /// getCFGChecksum() - returns an FNV-1a hash of the block count and of the
+    /// successor indices of each block.
+    uint64_t getCFGChecksum(Function& F) {
+        DenseMap<const BasicBlock*, unsigned> Index;
+        numberBlocks(F, Index);
+
+        uint64_t Hash = 0xcbf29ce484222325ULL;
+        auto mix = [&Hash](uint64_t V) {
+            for (unsigned i = 0; i < 8; ++i) {
+                Hash ^= (V >> (i * 8)) & 0xff;
+                Hash *= 0x100000001b3ULL;
+            }
+        };
+        mix(F.size());
+        for (auto& BB : F) {
+            mix(std::distance(succ_begin(&BB), succ_end(&BB)));
+            for (auto SI = succ_begin(&BB), SE = succ_end(&BB); SI != SE; ++SI)
+                mix(Index[*SI]);
+        }
+        return Hash;
+    }
+
+    std::string getHashString(const CodeGenContext* Ctx) {
+        char Hash[17];
+        snprintf(Hash, sizeof(Hash), "%016llx", (unsigned long long)Ctx->hash.getAsmHash());
+        return Hash;
+    }
+
+    class PGOInstrumentation : public ModulePass {
+    public:
+        static char ID;
+
+        PGOInstrumentation() : ModulePass(ID) {
+            initializePGOInstrumentationPass(*PassRegistry::getPassRegistry());
+        }
+
+        bool runOnModule(Module& M) override;
+
+        StringRef getPassName() const override { return "PGO Instrumentation"; }
+
+    private:
+        void getAnalysisUsage(AnalysisUsage& AU) const override {
+            AU.addRequired<CodeGenContextWrapper>();
+            AU.addRequired<MetaDataUtilsWrapper>();
+        }
+    };
+
+    class PGOAnnotation : public ModulePass {
+        // Profile of a single kernel as read from the feedback file.
+        struct KernelProfile {
+            uint64_t Checksum = 0;
+            std::map<unsigned, uint64_t> BlockCounts;
+            std::map<unsigned, double> SIMDTimes;
+        };
+
+        std::map<std::string, KernelProfile> Profiles;
+
+    public:
+        static char ID;
+
+        PGOAnnotation() : ModulePass(ID) {
+            initializePGOAnnotationPass(*PassRegistry::getPassRegistry());
+        }
+
+        bool runOnModule(Module& M) override;
+
+        StringRef getPassName() const override { return "PGO Annotation"; }
+
+    private:
+        void getAnalysisUsage(AnalysisUsage& AU) const override {
+            AU.addRequired<CodeGenContextWrapper>();
+            AU.addRequired<MetaDataUtilsWrapper>();
+        }
+
+        bool readProfile(StringRef Path, StringRef ShaderHash);
+        void annotate(Function& F, const KernelProfile& P);
+    };
+
+    char PGOInstrumentation::ID = 0;
+    char PGOAnnotation::ID = 0;
+
+} // End anonymous namespace
+
+ModulePass* IGC::createPGOInstrumentationPass() {
+    return new PGOInstrumentation();
+}
+
+ModulePass* IGC::createPGOAnnotationPass() {
+    return new PGOAnnotation();
+}
+
+namespace IGC {
+#define PASS_FLAG     "igc-pgo-instrumentation"
+#define PASS_DESC     "Insert basic block counters for profile-guided compilation"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+    IGC_INITIALIZE_PASS_BEGIN(PGOInstrumentation, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+        IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+        IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
+    IGC_INITIALIZE_PASS_END(PGOInstrumentation, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+#undef PASS_FLAG
+#undef PASS_DESC
+
+#define PASS_FLAG     "igc-pgo-annotation"
+#define PASS_DESC     "Annotate kernels with a block count profile"
+    IGC_INITIALIZE_PASS_BEGIN(PGOAnnotation, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+        IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+        IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
+    IGC_INITIALIZE_PASS_END(PGOAnnotation, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+} // End namespace IGC
+
+bool PGOInstrumentation::runOnModule(Module& M) {
+    MetaDataUtils* MDU = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+    CodeGenContext* Ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    LLVMContext& C = M.getContext();
+    Type* Int32Ty = Type::getInt32Ty(C);
+    Type* CounterPtrTy = PointerType::get(Int32Ty, ADDRESS_SPACE_GLOBAL);
+
+    // Counters are incremented through the OCL builtin so that the atomic
+    // resolution later in the pipeline picks the right message for the
+    // pointer size.
+    const char* AddName = "__builtin_IB_atomic_add_global_i32";
+    Function* AtomicAdd = M.getFunction(AddName);
+    if (!AtomicAdd) {
+        Type* ArgTys[] = { CounterPtrTy, Int32Ty };
+        AtomicAdd = Function::Create(FunctionType::get(Int32Ty, ArgTys, false),
+            GlobalValue::ExternalLinkage, AddName, &M);
+    }
+
+    std::string Map;
+    raw_string_ostream OS(Map);
+    OS << "shader " << getHashString(Ctx) << "\n";
+
+    bool Changed = false;
+    for (auto& F : M) {
+        if (F.isDeclaration() || !isEntryFunc(MDU, &F))
+            continue;
+
+        unsigned NumBlocks = unsigned(F.size());
+        ArrayType* CountersTy = ArrayType::get(Int32Ty, NumBlocks);
+        GlobalVariable* Counters = new GlobalVariable(M, CountersTy, false,
+            GlobalValue::ExternalLinkage, ConstantAggregateZero::get(CountersTy),
+            CounterPrefix + F.getName().str(), nullptr,
+            GlobalValue::NotThreadLocal, ADDRESS_SPACE_GLOBAL);
+        Counters->setAlignment(MaybeAlign(4));
+
+        OS << "kernel " << F.getName() << " " << utohexstr(getCFGChecksum(F)) << "\n";
+
+        unsigned Idx = 0;
+        for (auto& BB : F) {
+            Instruction* InsertPt = &*BB.getFirstInsertionPt();
+            Value* Indices[] = {
+                ConstantInt::get(Int32Ty, 0), ConstantInt::get(Int32Ty, Idx) };
+            // Keep the address an instruction, program scope resolution
+            // doesn't look through constant expressions.
+            Value* Ptr = GetElementPtrInst::CreateInBounds(
+                Counters, Indices, "pgo.counter", InsertPt);
+            Value* Args[] = { Ptr, ConstantInt::get(Int32Ty, 1) };
+            CallInst::Create(AtomicAdd, Args, "", InsertPt);
+
+            OS << "block " << Idx << " 0";
+            if (BB.hasName())
+                OS << "    # " << BB.getName();
+            OS << "\n";
+            ++Idx;
+        }
+        Changed = true;
+    }
+
+    if (Changed) {
+        using namespace IGC::Debug;
+        auto Name =
+            DumpName(GetShaderOutputName())
+            .Hash(Ctx->hash)
+            .Type(Ctx->type)
+            .Pass("pgomap")
+            .Retry(Ctx->m_retryManager.GetRetryId())
+            .Extension("txt");
+
+        Dump MapDump(Name, DumpType::DBG_MSG_TEXT);
+
+        DumpLock();
+        MapDump.stream() << OS.str();
+        DumpUnlock();
+    }
+
+    return Changed;
+}
+
+/// readProfile() - reads the kernels of shader `ShaderHash` from the feedback
+/// file. Returns false when the file can't be read or has no such shader.
+bool PGOAnnotation::readProfile(StringRef Path, StringRef ShaderHash) {
+    auto BufOrErr = MemoryBuffer::getFile(Path);
+    if (!BufOrErr)
+        return false;
+
+    bool InShader = false;
+    KernelProfile* Kernel = nullptr;
+    for (line_iterator LI(**BufOrErr, true, '#'); !LI.is_at_eof(); ++LI) {
+        SmallVector<StringRef, 4> Tokens;
+        SplitString(*LI, Tokens);
+        if (Tokens.size() < 2)
+            continue;
+
+        if (Tokens[0] == "shader") {
+            InShader = Tokens[1].equals_lower(ShaderHash);
+            Kernel = nullptr;
+            continue;
+        }
+        if (!InShader || Tokens.size() < 3)
+            continue;
+
+        if (Tokens[0] == "kernel") {
+            Kernel = &Profiles[Tokens[1].str()];
+            if (Tokens[2].getAsInteger(16, Kernel->Checksum))
+                Kernel->Checksum = 0;
+        }
+        else if (Kernel && Tokens[0] == "block") {
+            unsigned Idx = 0;
+            uint64_t Count = 0;
+            if (!Tokens[1].getAsInteger(10, Idx) && !Tokens[2].getAsInteger(10, Count))
+                Kernel->BlockCounts[Idx] = Count;
+        }
+        else if (Kernel && Tokens[0] == "simd") {
+            unsigned Width = 0;
+            double Time = 0.0;
+            if (!Tokens[1].getAsInteger(10, Width) && !Tokens[2].getAsDouble(Time) &&
+                (Width == 8 || Width == 16 || Width == 32))
+                Kernel->SIMDTimes[Width] = Time;
+        }
+    }
+    return !Profiles.empty();
+}
+
+bool PGOAnnotation::runOnModule(Module& M) {
+    MetaDataUtils* MDU = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+    CodeGenContext* Ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+
+    Profiles.clear();
+    StringRef Path = PGOFeedbackFileOpt.empty() ?
+        StringRef(IGC_GET_REGKEYSTRING(PGOFeedbackFile)) : StringRef(PGOFeedbackFileOpt);
+    if (!readProfile(Path, getHashString(Ctx)))
+        return false;
+
+    bool Changed = false;
+    for (auto& F : M) {
+        if (F.isDeclaration() || !isEntryFunc(MDU, &F))
+            continue;
+        auto PI = Profiles.find(F.getName().str());
+        if (PI == Profiles.end() || PI->second.Checksum != getCFGChecksum(F))
+            continue;
+        annotate(F, PI->second);
+        Changed = true;
+    }
+    return Changed;
+}
+
+void PGOAnnotation::annotate(Function& F, const KernelProfile& P) {
+    LLVMContext& C = F.getContext();
+    DenseMap<const BasicBlock*, unsigned> Index;
+    numberBlocks(F, Index);
+
+    auto getCount = [&](const BasicBlock* BB) -> uint64_t {
+        auto CI = P.BlockCounts.find(Index[BB]);
+        return CI == P.BlockCounts.end() ? 0 : CI->second;
+    };
+
+    for (auto& BB : F) {
+        Instruction* TI = BB.getTerminator();
+        uint64_t Count = getCount(&BB);
+        TI->setMetadata(CountMDName, MDNode::get(C,
+            ConstantAsMetadata::get(ConstantInt::get(Type::getInt64Ty(C), Count))));
+
+        if (!isa<BranchInst>(TI) && !isa<SwitchInst>(TI))
+            continue;
+        SmallVector<BasicBlock*, 4> Succs(succ_begin(&BB), succ_end(&BB));
+        if (Succs.size() < 2)
+            continue;
+
+        // Only block counts are collected. An edge into a block with a single
+        // predecessor carries the count of that block; for a two-way branch
+        // the other edge gets the rest. Otherwise the count of the successor
+        // bounded by the count of this block is the best estimate.
+        SmallVector<uint64_t, 4> Edges;
+        for (auto* S : Succs) {
+            uint64_t E = std::min(getCount(S), Count);
+            Edges.push_back(E);
+        }
+        if (Succs.size() == 2 && Succs[0] != Succs[1]) {
+            bool Single0 = Succs[0]->getSinglePredecessor() == &BB;
+            bool Single1 = Succs[1]->getSinglePredecessor() == &BB;
+            if (Single0 && !Single1)
+                Edges[1] = Count - Edges[0];
+            else if (Single1 && !Single0)
+                Edges[0] = Count - Edges[1];
+        }
+
+        uint64_t Max = *std::max_element(Edges.begin(), Edges.end());
+        if (Max == 0)
+            continue;
+        uint64_t Scale = Max / UINT32_MAX + 1;
+        SmallVector<uint32_t, 4> Weights;
+        for (uint64_t E : Edges)
+            Weights.push_back(uint32_t(E / Scale));
+        TI->setMetadata(LLVMContext::MD_prof, MDBuilder(C).createBranchWeights(Weights));
+    }
+
+    // A single timing can't tell which width is faster.
+    if (P.SIMDTimes.size() >= 2) {
+        auto Fastest = std::min_element(P.SIMDTimes.begin(), P.SIMDTimes.end(),
+            [](const std::pair<const unsigned, double>& A,
+               const std::pair<const unsigned, double>& B) {
+                return A.second < B.second;
+            });
+        F.addFnAttr(SIMDAttr, utostr(Fastest->first));
+    }
+    F.addFnAttr(ProfileAttr);
+}
+
+bool IGC::hasPGOProfile(const Function& F) {
+    return F.hasFnAttribute(ProfileAttr);
+}
+
+unsigned IGC::getPGOPreferredSIMDSize(const Function& F) {
+    if (!F.hasFnAttribute(SIMDAttr))
+        return 0;
+    unsigned Width = 0;
+    if (F.getFnAttribute(SIMDAttr).getValueAsString().getAsInteger(10, Width))
+        return 0;
+    return Width;
+}
+
+bool IGC::getPGOBlockCount(const BasicBlock* BB, uint64_t& Count) {
+    const Instruction* TI = BB->getTerminator();
+    MDNode* MD = TI ? TI->getMetadata(CountMDName) : nullptr;
+    if (!MD || MD->getNumOperands() != 1)
+        return false;
+    auto* CI = mdconst::dyn_extract<ConstantInt>(MD->getOperand(0));
+    if (!CI)
+        return false;
+    Count = CI->getZExtValue();
+    return true;
+}
+
+bool IGC::getPGOBranchWeights(const Instruction* TI, SmallVectorImpl<uint64_t>& Weights) {
+    Weights.clear();
+    MDNode* MD = TI ? TI->getMetadata(LLVMContext::MD_prof) : nullptr;
+    if (!MD || MD->getNumOperands() < 2)
+        return false;
+    auto* Tag = dyn_cast<MDString>(MD->getOperand(0));
+    if (!Tag || Tag->getString() != "branch_weights")
+        return false;
+    for (unsigned i = 1, e = MD->getNumOperands(); i != e; ++i) {
+        auto* CI = mdconst::dyn_extract<ConstantInt>(MD->getOperand(i));
+        if (!CI) {
+            Weights.clear();
+            return false;
+        }
+        Weights.push_back(CI->getZExtValue());
+    }
+    return true;
+}
+
+/// getPGOLoopTripCount() - estimates the average number of iterations per
+/// entry of loop L from the branch weights of its latch.
+bool IGC::getPGOLoopTripCount(const Loop* L, uint64_t& AvgTrips) {
+    BasicBlock* Latch = L->getLoopLatch();
+    if (!Latch || !hasPGOProfile(*Latch->getParent()))
+        return false;
+    SmallVector<uint64_t, 2> Weights;
+    if (!getPGOBranchWeights(Latch->getTerminator(), Weights) ||
+        Weights.size() != Latch->getTerminator()->getNumSuccessors())
+        return false;
+
+    uint64_t Back = 0, Exit = 0;
+    unsigned i = 0;
+    for (auto SI = succ_begin(Latch), SE = succ_end(Latch); SI != SE; ++SI, ++i) {
+        if (*SI == L->getHeader())
+            Back += Weights[i];
+        else
+            Exit += Weights[i];
+    }
+    if (Exit == 0)
+        return false;
+    AvgTrips = (Back + Exit) / Exit;
+    return true;
+}
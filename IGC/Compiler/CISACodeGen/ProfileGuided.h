@@ -0,0 +1,64 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#ifndef _CISA_PROFILEGUIDED_H_
+#define _CISA_PROFILEGUIDED_H_
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Pass.h>
+#include <llvm/PassRegistry.h>
+#include "common/LLVMWarningsPop.hpp"
+
+namespace llvm {
+    class BasicBlock;
+    class Function;
+    class Instruction;
+    class Loop;
+}
+
+namespace IGC {
+    // Inserts one execution counter per basic block into each OpenCL kernel.
+    void initializePGOInstrumentationPass(llvm::PassRegistry&);
+    llvm::ModulePass* createPGOInstrumentationPass();
+
+    // Annotates kernels with the block counts and SIMD timings read from the
+    // PGOFeedbackFile regkey.
+    void initializePGOAnnotationPass(llvm::PassRegistry&);
+    llvm::ModulePass* createPGOAnnotationPass();
+
+    // Queries used by the passes consuming the profile. They return false (or
+    // 0) when no profile was applied to the function or the information was
+    // lost by earlier transformations.
+    bool hasPGOProfile(const llvm::Function& F);
+    unsigned getPGOPreferredSIMDSize(const llvm::Function& F);
+    bool getPGOBlockCount(const llvm::BasicBlock* BB, uint64_t& Count);
+    bool getPGOBranchWeights(const llvm::Instruction* TI,
+        llvm::SmallVectorImpl<uint64_t>& Weights);
+    bool getPGOLoopTripCount(const llvm::Loop* L, uint64_t& AvgTrips);
+} // End namespace IGC
+
+#endif // _CISA_PROFILEGUIDED_H_
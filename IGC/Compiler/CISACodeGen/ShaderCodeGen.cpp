@@ -38,6 +38,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "Compiler/CISACodeGen/AdvCodeMotion.h"
 #include "Compiler/CISACodeGen/AdvMemOpt.h"
+#include "Compiler/CISACodeGen/LoopPrefetch.h"
+#include "Compiler/CISACodeGen/LaneCompaction.h"
 #include "Compiler/CISACodeGen/Emu64OpsPass.h"
 #include "Compiler/CISACodeGen/PullConstantHeuristics.hpp"
 #include "Compiler/CISACodeGen/PushAnalysis.hpp"
@@ -518,6 +520,27 @@ namespace IGC
             mpm.add(createIGCInstructionCombiningPass());
         }
 
+        // Prefetch loop-strided global loads. This must run before stateless
+        // to stateful promotion, which hides the address recurrences from SCEV.
+        if (!isOptDisabled && !fastCompile &&
+            ctx.type == ShaderType::OPENCL_SHADER &&
+            ctx.m_instrTypes.hasLoop && ctx.m_instrTypes.hasLoadStore &&
+            IGC_IS_FLAG_ENABLED(EnableLoopPrefetch))
+        {
+            mpm.add(createLoopPrefetchPass());
+        }
+
+        // Optional: pack the remaining work of divergent loops onto fewer
+        // threads through SLM. Runs after private memory resolution, as that
+        // may place private memory in SLM too.
+        if (!isOptDisabled && !fastCompile &&
+            ctx.type == ShaderType::OPENCL_SHADER &&
+            ctx.m_instrTypes.hasLoop &&
+            IGC_IS_FLAG_ENABLED(EnableLaneCompaction))
+        {
+            mpm.add(createLaneCompactionPass());
+        }
+
         if (ctx.type == ShaderType::OPENCL_SHADER &&
             static_cast<OpenCLProgramContext&>(ctx).
                 m_InternalOptions.PromoteStatelessToBindless)
@@ -1312,6 +1335,8 @@ namespace IGC
     {
         MetaDataUtils* pMdUtils = pContext->getMetaDataUtils();
         bool NoOpt = pContext->getModuleMetaData()->compOpt.OptDisable;
+        // Tier-0 compiles skip LICM, loop unrolling and GVN.
+        bool fastCompile = pContext->getModuleMetaData()->compOpt.FastCompilation;
         pContext->m_highPsRegisterPressure =
             (pContext->type == ShaderType::PIXEL_SHADER &&
             ((pContext->m_inputCount + pContext->m_ConstantBufferCount/8 + pContext->m_tempCount) > 60));
@@ -1459,7 +1484,7 @@ namespace IGC
                     mpm.add(llvm::createLCSSAPass());
                     mpm.add(llvm::createLoopSimplifyPass());
 
-                    if (pContext->m_retryManager.AllowLICM() && IGC_IS_FLAG_ENABLED(allowLICM))
+                    if (!fastCompile && pContext->m_retryManager.AllowLICM() && IGC_IS_FLAG_ENABLED(allowLICM))
                     {
                         mpm.add(llvm::createLICMPass());
                         mpm.add(llvm::createLICMPass());
@@ -1495,7 +1520,7 @@ namespace IGC
                         LoopUnrollThreshold = IGC_GET_FLAG_VALUE(SetLoopUnrollThreshold);
                     }
 
-                    if (LoopUnrollThreshold > 0 && !IGC_IS_FLAG_ENABLED(DisableLoopUnroll))
+                    if (!fastCompile && LoopUnrollThreshold > 0 && !IGC_IS_FLAG_ENABLED(DisableLoopUnroll))
                     {
                         mpm.add(IGCLLVM::createLoopUnrollPass());
                     }
@@ -1504,13 +1529,13 @@ namespace IGC
                     // LoopUnroll and LICM.
                     mpm.add(createBarrierNoopPass());
 
-                    if (pContext->m_retryManager.AllowLICM() && IGC_IS_FLAG_ENABLED(allowLICM))
+                    if (!fastCompile && pContext->m_retryManager.AllowLICM() && IGC_IS_FLAG_ENABLED(allowLICM))
                     {
                         mpm.add(llvm::createLICMPass());
                     }
 
                     // Second unrolling with the same threshold.
-                    if (LoopUnrollThreshold > 0 && !IGC_IS_FLAG_ENABLED(DisableLoopUnroll))
+                    if (!fastCompile && LoopUnrollThreshold > 0 && !IGC_IS_FLAG_ENABLED(DisableLoopUnroll))
                     {
                         mpm.add(IGCLLVM::createLoopUnrollPass());
                     }
@@ -1549,7 +1574,7 @@ namespace IGC
                     mpm.add(createReassociatePass());
                 }
 
-                if (IGC_IS_FLAG_ENABLED(EnableGVN))
+                if (!fastCompile && IGC_IS_FLAG_ENABLED(EnableGVN))
                 {
                     mpm.add(llvm::createGVNPass());
                 }
@@ -1692,7 +1717,7 @@ namespace IGC
                 //  = foo / (2*x + 1)
                 //  = foo % (2*x + 1)
                 // can be reduced as well
-                if (IGC_IS_FLAG_ENABLED(EnableGVN)) {
+                if (!fastCompile && IGC_IS_FLAG_ENABLED(EnableGVN)) {
                     mpm.add(llvm::createGVNPass());
                 }
                 //
@@ -81,7 +81,77 @@ ModulePass* IGC::createTimeStatsIGCPass(CodeGenContext* _ctx, std::string _igcPa
     return new TimeStatsCounter(_ctx, _igcPass, _mode);
 }
 
+namespace {
+    // Brackets a pass added by IGCPassManager with a compile trace span.
+    class CompileTraceSpan : public ModulePass {
+        CodeGenContext* ctx;
+        std::string name;
+        TimeStatsCounterStartEndMode mode;
+
+    public:
+        static char ID;
+
+        CompileTraceSpan() : ModulePass(ID), ctx(nullptr), mode(STATS_COUNTER_START) {
+            initializeCompileTraceSpanPass(*PassRegistry::getPassRegistry());
+        }
+
+        CompileTraceSpan(CodeGenContext* _ctx, std::string _name, TimeStatsCounterStartEndMode _mode) :
+            ModulePass(ID), ctx(_ctx), name(std::move(_name)), mode(_mode) {
+            initializeCompileTraceSpanPass(*PassRegistry::getPassRegistry());
+        }
+
+        void getAnalysisUsage(AnalysisUsage& AU) const override {
+            AU.setPreservesAll();
+        }
+
+        bool runOnModule(Module&) override;
+    };
+} // End anonymous namespace
+
+ModulePass* IGC::createCompileTraceSpanPass(CodeGenContext* _ctx, std::string _name, TimeStatsCounterStartEndMode _mode)
+{
+    return new CompileTraceSpan(_ctx, std::move(_name), _mode);
+}
+
+namespace {
+    // Records LLVM IR size and heap high-water mark around a pass added by
+    // IGCPassManager into the context compiler stats.
+    class PassStatsCounter : public ModulePass {
+        CodeGenContext* ctx;
+        std::string name;
+        std::shared_ptr<PassStatsSnapshot> snapshot;
+        TimeStatsCounterStartEndMode mode;
+
+    public:
+        static char ID;
+
+        PassStatsCounter() : ModulePass(ID), ctx(nullptr), mode(STATS_COUNTER_START) {
+            initializePassStatsCounterPass(*PassRegistry::getPassRegistry());
+        }
+
+        PassStatsCounter(CodeGenContext* _ctx, std::string _name,
+            std::shared_ptr<PassStatsSnapshot> _snapshot, TimeStatsCounterStartEndMode _mode) :
+            ModulePass(ID), ctx(_ctx), name(std::move(_name)), snapshot(std::move(_snapshot)), mode(_mode) {
+            initializePassStatsCounterPass(*PassRegistry::getPassRegistry());
+        }
+
+        void getAnalysisUsage(AnalysisUsage& AU) const override {
+            AU.setPreservesAll();
+        }
+
+        bool runOnModule(Module&) override;
+    };
+} // End anonymous namespace
+
+ModulePass* IGC::createPassStatsCounterPass(CodeGenContext* _ctx, std::string _name,
+    std::shared_ptr<PassStatsSnapshot> _snapshot, TimeStatsCounterStartEndMode _mode)
+{
+    return new PassStatsCounter(_ctx, std::move(_name), std::move(_snapshot), _mode);
+}
+
 char TimeStatsCounter::ID = 0;
+char CompileTraceSpan::ID = 0;
+char PassStatsCounter::ID = 0;
 
 #define PASS_FLAG     "time-stats-counter"
 #define PASS_DESC     "TimeStatsCounter Start/Stop"
@@ -92,6 +162,24 @@ namespace IGC {
         IGC_INITIALIZE_PASS_END(TimeStatsCounter, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
 }
 
+#undef PASS_FLAG
+#undef PASS_DESC
+#define PASS_FLAG     "compile-trace-span"
+#define PASS_DESC     "CompileTrace span Begin/End"
+namespace IGC {
+    IGC_INITIALIZE_PASS_BEGIN(CompileTraceSpan, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+        IGC_INITIALIZE_PASS_END(CompileTraceSpan, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+}
+
+#undef PASS_FLAG
+#undef PASS_DESC
+#define PASS_FLAG     "pass-stats-counter"
+#define PASS_DESC     "PassStatsCounter Start/Stop"
+namespace IGC {
+    IGC_INITIALIZE_PASS_BEGIN(PassStatsCounter, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+        IGC_INITIALIZE_PASS_END(PassStatsCounter, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+}
+
 bool TimeStatsCounter::runOnModule(Module& F) {
     if (type == STATS_COUNTER_ENUM_TYPE)
     {
@@ -118,3 +206,56 @@ bool TimeStatsCounter::runOnModule(Module& F) {
     return true;
 }
 
+bool CompileTraceSpan::runOnModule(Module&) {
+    if (mode == STATS_COUNTER_START)
+    {
+        // LLVM passes run on the whole module: tag them with the shader hash
+        char hash[24];
+        snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)ctx->hash.getAsmHash());
+        CompileTrace::setKernel(hash);
+        CompileTrace::setSimd(0);
+        CompileTrace::setRetry(ctx->m_retryManager.GetRetryId());
+        CompileTrace::begin("IGC", name.c_str());
+    }
+    else
+    {
+        CompileTrace::end(name.c_str());
+    }
+    return false;
+}
+
+bool PassStatsCounter::runOnModule(Module& M) {
+    int64_t numInsts = 0;
+    int64_t numBlocks = 0;
+    for (auto& F : M)
+    {
+        numBlocks += F.size();
+        for (auto& BB : F)
+        {
+            numInsts += BB.size();
+        }
+    }
+
+    if (mode == STATS_COUNTER_START)
+    {
+        snapshot->numInsts = numInsts;
+        snapshot->numBlocks = numBlocks;
+#if GET_MEM_STATS
+        // Restart the per-pass peak from the current heap usage
+        g_MemoryReport.m_Stat.PassHeapUsedPeak =
+            g_MemoryReport.m_Stat.HeapUsed > 0 ? g_MemoryReport.m_Stat.HeapUsed : 0;
+#endif
+    }
+    else
+    {
+        CompilerStats& stats = ctx->Stats();
+        stats.SetI64(name + ".InstBefore", snapshot->numInsts);
+        stats.SetI64(name + ".InstAfter", numInsts);
+        stats.SetI64(name + ".BBBefore", snapshot->numBlocks);
+        stats.SetI64(name + ".BBAfter", numBlocks);
+#if GET_MEM_STATS
+        stats.SetI64(name + ".HeapPeak", g_MemoryReport.m_Stat.PassHeapUsedPeak);
+#endif
+    }
+    return false;
+}
@@ -32,6 +32,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/CodeGenPublic.h"
 #include "common/Stats.hpp"
 #include <string>
+#include <memory>
 
 namespace IGC {
     enum TimeStatsCounterStartEndMode
@@ -49,4 +50,17 @@ namespace IGC {
     llvm::ModulePass* createTimeStatsCounterPass(CodeGenContext* _ctx, COMPILE_TIME_INTERVALS _interval, TimeStatsCounterStartEndMode _mode);
     llvm::ModulePass* createTimeStatsIGCPass(CodeGenContext* _ctx, std::string _igcPass, TimeStatsCounterStartEndMode _mode);
     void initializeTimeStatsCounterPass(llvm::PassRegistry&);
+    // IR size and heap usage captured by the start marker of a pass and
+    // consumed by the matching end marker.
+    struct PassStatsSnapshot
+    {
+        int64_t numInsts = 0;
+        int64_t numBlocks = 0;
+    };
+
+    llvm::ModulePass* createPassStatsCounterPass(CodeGenContext* _ctx, std::string _name,
+        std::shared_ptr<PassStatsSnapshot> _snapshot, TimeStatsCounterStartEndMode _mode);
+    void initializePassStatsCounterPass(llvm::PassRegistry&);
+    llvm::ModulePass* createCompileTraceSpanPass(CodeGenContext* _ctx, std::string _name, TimeStatsCounterStartEndMode _mode);
+    void initializeCompileTraceSpanPass(llvm::PassRegistry&);
 } // End namespace IGC
@@ -26,6 +26,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "Compiler/CISACodeGen/layout.hpp"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
+#include "Compiler/CISACodeGen/ProfileGuided.h"
 #include "Compiler/IGCPassSupport.h"
 
 #include "common/debug/Debug.hpp"
@@ -33,6 +34,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/MemStats.h"
 #include "common/LLVMUtils.h"
 
+#include <algorithm>
+#include <numeric>
 #include <vector>
 #include <set>
 
@@ -45,9 +48,7 @@ using namespace IGC;
 #define SUCCANYLOOP   (true)
 
 #define PUSHSUCC(BLK, C1, C2) \
-        for(succ_iterator succIter = succ_begin(BLK), succEnd = succ_end(BLK); \
-            succIter!=succEnd; ++succIter) {                                   \
-            llvm::BasicBlock *succ = *succIter;                                \
+        for(llvm::BasicBlock *succ : getSuccsInVisitOrder(BLK)) {              \
             if (!visitSet.count(succ) && C1 && C2) {                           \
                 visitVec.push_back(succ);                                      \
                 visitSet.insert(succ);                                         \
@@ -55,6 +56,31 @@ using namespace IGC;
             }                                                                  \
         }
 
+// Returns the successors of BB in the order the layout visits them. The
+// successor visited last ends up right after BB, so when the function has a
+// profile the successors are sorted by increasing branch weight to make the
+// hottest edge the fall-through.
+static SmallVector<BasicBlock*, 4> getSuccsInVisitOrder(BasicBlock* BB)
+{
+    SmallVector<BasicBlock*, 4> Succs(succ_begin(BB), succ_end(BB));
+    SmallVector<uint64_t, 4> Weights;
+    if (Succs.size() < 2 || !hasPGOProfile(*BB->getParent()) ||
+        !getPGOBranchWeights(BB->getTerminator(), Weights) ||
+        Weights.size() != Succs.size())
+    {
+        return Succs;
+    }
+
+    SmallVector<unsigned, 4> Order(Succs.size());
+    std::iota(Order.begin(), Order.end(), 0);
+    std::stable_sort(Order.begin(), Order.end(),
+        [&Weights](unsigned A, unsigned B) { return Weights[A] < Weights[B]; });
+    SmallVector<BasicBlock*, 4> Sorted;
+    for (unsigned Idx : Order)
+        Sorted.push_back(Succs[Idx]);
+    return Sorted;
+}
+
 // Register pass to igc-opt
 #define PASS_FLAG "igc-layout"
 #define PASS_DESCRIPTION "Layout blocks"
@@ -733,6 +733,11 @@ namespace IGC
                 IGC_SET_FLAG_VALUE(EnableDeSSAAlias, m_DriverInfo.DessaAliasLevel());
             }
         }
+
+        if (IGC_IS_FLAG_ENABLED(DumpCompilerStats))
+        {
+            m_Stats.Enable(false);
+        }
     }
 
 
@@ -1086,6 +1086,14 @@ namespace IGC
                 {
                     IntelEnablePreRAScheduling = false;
                 }
+                // matches both -intel-opt-tier0 and -ze-opt-tier0
+                if (strstr(options, "-opt-tier0"))
+                {
+                    // Tier-0 compile: trade code quality for compile latency. The
+                    // runtime is expected to rebuild the same program without this
+                    // option in the background and swap in the optimized binary.
+                    IntelOptTier0 = true;
+                }
                 if (strstr(options, "-intel-use-bindless-buffers"))
                 {
                     PromoteStatelessToBindless = true;
@@ -1130,6 +1138,7 @@ namespace IGC
             bool IntelHasBufferOffsetArg;
             bool replaceGlobalOffsetsByZero = false;
             bool IntelEnablePreRAScheduling = true;
+            bool IntelOptTier0 = false;
             bool PromoteStatelessToBindless = false;
             bool PreferBindlessImages = false;
             bool IntelForceGlobalMemoryAllocation = false;
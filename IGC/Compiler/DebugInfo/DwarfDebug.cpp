@@ -2533,8 +2533,7 @@ void DwarfDebug::writeCIE()
         Asm->EmitInt32(0xffffffff);
     Asm->EmitIntValue(data.size(), ptrSize);
 
-    for (auto& byte : data)
-        Asm->EmitInt8(byte);
+    Asm->EmitBytes(llvm::StringRef((const char*)data.data(), data.size()));
 }
 
 void DwarfDebug::writeFDE(DbgDecoder::SubroutineInfo& sub)
@@ -2612,8 +2611,7 @@ void DwarfDebug::writeFDE(DbgDecoder::SubroutineInfo& sub)
         Asm->EmitInt32(0xffffffff);
     Asm->EmitIntValue(data.size(), ptrSize);
 
-    for (auto& byte : data)
-        Asm->EmitInt8(byte);
+    Asm->EmitBytes(llvm::StringRef((const char*)data.data(), data.size()));
 }
 
 // Emit debug_frame section to allow stack traversal
@@ -0,0 +1,107 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace IGC
+{
+    /// @brief OffsetTable is a flat, sorted replacement for std::map/std::multimap
+    ///        keyed by VISA index or Gen ISA offset. Entries are appended while
+    ///        decoding debug info, then sorted once by finalize(), after which
+    ///        all lookups are binary searches over contiguous memory.
+    template <typename ValueT>
+    class OffsetTable
+    {
+    public:
+        typedef std::pair<uint32_t, ValueT> Entry;
+        typedef typename std::vector<Entry>::const_iterator const_iterator;
+
+        void clear()
+        {
+            entries.clear();
+            sorted = true;
+        }
+
+        void reserve(size_t n) { entries.reserve(n); }
+
+        void append(uint32_t key, const ValueT& value)
+        {
+            if (!entries.empty() && key < entries.back().first)
+                sorted = false;
+            entries.emplace_back(key, value);
+        }
+
+        /// @brief Sorts the table by key. Entries with equal keys keep their
+        ///        insertion order.
+        void finalize()
+        {
+            if (!sorted)
+            {
+                std::stable_sort(entries.begin(), entries.end(),
+                    [](const Entry& a, const Entry& b) { return a.first < b.first; });
+                sorted = true;
+            }
+        }
+
+        /// @brief Returns the first value inserted for key, or nullptr.
+        const ValueT* find(uint32_t key) const
+        {
+            auto it = lowerBound(key);
+            if (it != entries.end() && it->first == key)
+                return &it->second;
+            return nullptr;
+        }
+
+        /// @brief Returns the range of all values inserted for key.
+        std::pair<const_iterator, const_iterator> equalRange(uint32_t key) const
+        {
+            auto first = lowerBound(key);
+            auto last = first;
+            while (last != entries.end() && last->first == key)
+                ++last;
+            return std::make_pair(first, last);
+        }
+
+        const_iterator lowerBound(uint32_t key) const
+        {
+            return std::lower_bound(entries.begin(), entries.end(), key,
+                [](const Entry& e, uint32_t k) { return e.first < k; });
+        }
+
+        const_iterator begin() const { return entries.begin(); }
+        const_iterator end() const { return entries.end(); }
+        size_t size() const { return entries.size(); }
+        bool empty() const { return entries.empty(); }
+
+    private:
+        std::vector<Entry> entries;
+        bool sorted = true;
+    };
+} // namespace IGC
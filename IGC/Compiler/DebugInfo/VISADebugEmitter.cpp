@@ -259,16 +259,17 @@ void DebugEmitter::Finalize(void*& pBuffer, unsigned int& size, bool finalize)
         unsigned int pc = prevLastGenOff;
         for (auto item : GenISAToVISAIndex)
         {
-            for (unsigned int i = pc; i != item.first; i++)
+            if (item.first > pc)
             {
-                m_pStreamEmitter->EmitInt8(genxISA[i]);
+                m_pStreamEmitter->EmitBytes(
+                    llvm::StringRef((const char*)genxISA + pc, item.first - pc));
             }
 
             pc = item.first;
 
-            auto instIt = VISAIndexToInst.end();
+            const llvm::Instruction* const* instIt = nullptr;
             auto sizeIt = VISAIndexToSize.find(item.second);
-            if (sizeIt != VISAIndexToSize.end())
+            if (sizeIt)
             {
                 // Lookup all VISA instructions that may
                 // map to an llvm::Instruction. This is useful
@@ -277,23 +278,23 @@ void DebugEmitter::Finalize(void*& pBuffer, unsigned int& size, bool finalize)
                 // optimizes some of those away. Src line
                 // mapping for all VISA instructions is the
                 // same. So lookup any one that still exists.
-                auto startIdx = sizeIt->second.first;
-                auto numVISAInsts = sizeIt->second.second;
+                auto startIdx = sizeIt->first;
+                auto numVISAInsts = sizeIt->second;
                 for (unsigned int visaId = startIdx;
                     visaId != (startIdx + numVISAInsts); visaId++)
                 {
                     instIt = VISAIndexToInst.find(visaId);
                     // Loop till at least one VISA instruction
                     // is found.
-                    if (instIt != VISAIndexToInst.end())
+                    if (instIt)
                         break;
                 }
             }
 
             bool emptyLoc = true;
-            if (instIt != VISAIndexToInst.end())
+            if (instIt)
             {
-                auto loc = instIt->second->getDebugLoc();
+                auto loc = (*instIt)->getDebugLoc();
                 if (loc)
                 {
                     if (loc != prevSrcLoc)
@@ -328,10 +329,12 @@ void DebugEmitter::Finalize(void*& pBuffer, unsigned int& size, bool finalize)
 
         if (finalize)
         {
-            for (unsigned int i = pc; i != m_pVISAModule->getUnpaddedProgramSize(); i++)
+            unsigned int programSize = m_pVISAModule->getUnpaddedProgramSize();
+            if (programSize > pc)
             {
-                m_pStreamEmitter->EmitInt8(genxISA[i]);
-                lastGenOff++;
+                m_pStreamEmitter->EmitBytes(
+                    llvm::StringRef((const char*)genxISA + pc, programSize - pc));
+                lastGenOff += programSize - pc;
             }
         }
 
@@ -727,46 +727,43 @@ void VISAModule::buildDirectElfMaps()
             continue;
 
         unsigned int currOffset = itr->second.m_offset;
-        VISAIndexToInst.insert(std::make_pair(currOffset, pInst));
+        VISAIndexToInst.append(currOffset, pInst);
         unsigned int currSize = itr->second.m_size;
         for (auto index = currOffset; index != (currOffset + currSize); index++)
-            VISAIndexToSize.insert(std::make_pair(index,
-                std::make_pair(currOffset, currSize)));
+            VISAIndexToSize.append(index, std::make_pair(currOffset, currSize));
     }
+    // Equal keys keep insertion order, so the first mapping wins as it did
+    // with std::map::insert.
+    VISAIndexToInst.finalize();
+    VISAIndexToSize.finalize();
 
     GenISAToVISAIndex.clear();
-    for (auto i = 0;
-        i != co->CISAIndexMap.size();
-        i++)
+    GenISAToVISAIndex.reserve(co->CISAIndexMap.size());
+    for (auto& item : co->CISAIndexMap)
     {
-        auto& item = co->CISAIndexMap[i];
         GenISAToVISAIndex.push_back(std::make_pair(item.second, item.first));
     }
 
     // Compute all Gen ISA offsets corresponding to each VISA index
     VISAIndexToAllGenISAOff.clear();
+    VISAIndexToAllGenISAOff.reserve(co->CISAIndexMap.size());
     for (auto& item : co->CISAIndexMap)
     {
-        auto VISAIndex = item.first;
-        auto GenISAOffset = item.second;
-        auto it = VISAIndexToAllGenISAOff.find(VISAIndex);
-        if (it != VISAIndexToAllGenISAOff.end())
-            it->second.push_back(GenISAOffset);
-        else
-        {
-            std::vector<unsigned int> vec;
-            vec.push_back(GenISAOffset);
-            VISAIndexToAllGenISAOff[VISAIndex] = vec;
-        }
+        VISAIndexToAllGenISAOff.append(item.first, item.second);
     }
+    VISAIndexToAllGenISAOff.finalize();
 
     GenISAInstSizeBytes.clear();
-    for (auto i = 0; i != co->CISAIndexMap.size() - 1; i++)
+    if (GenISAToVISAIndex.empty())
+        return;
+    GenISAInstSizeBytes.reserve(GenISAToVISAIndex.size());
+    for (size_t i = 0; i + 1 < GenISAToVISAIndex.size(); i++)
     {
         unsigned int size = GenISAToVISAIndex[i + 1].first - GenISAToVISAIndex[i].first;
-        GenISAInstSizeBytes.insert(std::make_pair(GenISAToVISAIndex[i].first, size));
+        GenISAInstSizeBytes.append(GenISAToVISAIndex[i].first, size);
     }
-    GenISAInstSizeBytes.insert(std::make_pair(GenISAToVISAIndex[GenISAToVISAIndex.size() - 1].first, 16));
+    GenISAInstSizeBytes.append(GenISAToVISAIndex.back().first, 16);
+    GenISAInstSizeBytes.finalize();
 }
 
 std::vector<std::pair<unsigned int, unsigned int>> VISAModule::getGenISARange(const InsnRange& Range)
@@ -815,13 +812,15 @@ std::vector<std::pair<unsigned int, unsigned int>> VISAModule::getGenISARange(co
         for (unsigned int i = 0; i != VISASize; i++)
         {
             auto VISAIndex = startVISAOffset + i;
-            auto it = VISAIndexToAllGenISAOff.find(VISAIndex);
-            if (it != VISAIndexToAllGenISAOff.end())
+            auto range = VISAIndexToAllGenISAOff.equalRange(VISAIndex);
+            if (range.first != range.second)
             {
                 int lastEnd = -1;
-                for (auto& genInst : it->second)
+                for (auto it = range.first; it != range.second; ++it)
                 {
-                    unsigned int sizeGenInst = GenISAInstSizeBytes[genInst];
+                    unsigned int genInst = it->second;
+                    auto sizeIt = GenISAInstSizeBytes.find(genInst);
+                    unsigned int sizeGenInst = sizeIt ? *sizeIt : 0;
 
                     if (GenISARange.size() > 0)
                         lastEnd = GenISARange.back().second;
@@ -38,6 +38,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <unordered_map>
 #include "Compiler/DebugInfo/VISAIDebugEmitter.hpp"
 #include "Compiler/DebugInfo/LexicalScopes.hpp"
+#include "Compiler/DebugInfo/OffsetTable.hpp"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
 
 namespace llvm
@@ -433,18 +434,21 @@ namespace IGC
         }
 
         bool isDirectElfInput = false;
+        // The tables below are built once by buildDirectElfMaps() and are
+        // sorted by key, so lookups are binary searches.
         // Store first VISA index->llvm::Instruction mapping
-        std::map<unsigned int, const llvm::Instruction*> VISAIndexToInst;
+        OffsetTable<const llvm::Instruction*> VISAIndexToInst;
         // Store VISA index->[header VISA index, #VISA instructions] corresponding
         // to same llvm::Instruction. If llvm inst A generates VISA 3,4,5 then
         // this structure will have 3 entries:
         // 3 -> [3,3]
         // 4 -> [3,3]
         // 5 -> [3,3]
-        std::map<unsigned int, std::pair<unsigned int, unsigned int>> VISAIndexToSize;
+        OffsetTable<std::pair<unsigned int, unsigned int>> VISAIndexToSize;
         std::vector<std::pair<unsigned int, unsigned int>> GenISAToVISAIndex;
-        std::map<unsigned int, std::vector<unsigned int>> VISAIndexToAllGenISAOff;
-        std::map<unsigned int, unsigned int> GenISAInstSizeBytes;
+        // VISA index->Gen ISA offset, one entry per Gen ISA instruction
+        OffsetTable<unsigned int> VISAIndexToAllGenISAOff;
+        OffsetTable<unsigned int> GenISAInstSizeBytes;
         class comparer
         {
         public:
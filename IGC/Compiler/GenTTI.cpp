@@ -30,6 +30,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/CodeGenPublic.h"
 #include "Compiler/IGCPassSupport.h"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
+#include "Compiler/CISACodeGen/ProfileGuided.h"
 
 #include "common/LLVMWarningsPush.hpp"
 
@@ -151,6 +152,29 @@ namespace llvm {
                 UP.Threshold = 200;
         }
 
+        // With a profile, don't unroll loops that never ran or barely iterate,
+        // and give loops that iterate a lot more room.
+        if (hasPGOProfile(*L->getHeader()->getParent()))
+        {
+            uint64_t HeaderCount = 0;
+            uint64_t AvgTrips = 0;
+            bool Cold = getPGOBlockCount(L->getHeader(), HeaderCount) && HeaderCount == 0;
+            bool KnownTrips = getPGOLoopTripCount(L, AvgTrips);
+            if (Cold || (KnownTrips && AvgTrips < 2))
+            {
+                UP.Count = 1;
+                UP.MaxCount = UP.Count;
+                UP.Partial = false;
+                UP.Runtime = false;
+                return;
+            }
+            if (KnownTrips && AvgTrips >= IGC_GET_FLAG_VALUE(PGOHotLoopMinTrips))
+            {
+                UP.Threshold *= 2;
+                UP.PartialThreshold *= 2;
+            }
+        }
+
 #if LLVM_VERSION_MAJOR == 4
         ScalarEvolution * SE = &dummyPass->getAnalysisIfAvailable<ScalarEvolutionWrapperPass>()->getSE();
         if (!SE)
@@ -298,47 +298,29 @@ static bool materialized_use_empty(const Value* v)
     return v->materialized_use_begin() == v->use_end();
 }
 
-void BIImport::WriteElfHeaderToMap(DenseMap<StringRef, int>& Map, char* pData, size_t dataSize)
-{
-    //Data from pData is layed out as follows.....
-    //First two bytes are the string size
-    //Next byte is the start of the function name
-    //Last two bytes are the index of function in the elf file
-
-    auto pData2 = (unsigned char*)pData;
-    for (uint i = 0; i < dataSize;)
-    {
-        unsigned short str_size = (unsigned short)pData2[i] | ((unsigned short)pData2[i + 1] << 8);
-        StringRef key(&pData[i + 2], str_size);
-        unsigned short func_index = (unsigned short)pData2[i + 2 + str_size] | ((unsigned short)pData2[i + 3 + str_size] << 8);
-        Map[key] = func_index;
-        i += (4 + str_size);
-    }
-
-}
-
 std::unique_ptr<llvm::Module> BIImport::Construct(Module& M, CLElfLib::CElfReader* pElfReader, bool hasSizet)
 {
-    char* pData = NULL;
-    size_t dataSize = 0;
-    std::string num_line = "";
-    DenseMap<StringRef, int> Map(32768);
-    pElfReader->GetSectionData(1, pData, dataSize);
-    WriteElfHeaderToMap(Map, pData, dataSize);
+    // Section 1 holds the generic symbols and sections 2/3 the size_t
+    // dependent ones, which take precedence. The reader hashes each symbol
+    // section once and reuses the index on later calls.
+    unsigned sizetSection = 0;
     if (hasSizet)
     {
-        char* pData_sizet = NULL;
-        size_t dataSize_sizet = 0;
-        if (M.getDataLayout().getPointerSizeInBits() == 32)
+        sizetSection = M.getDataLayout().getPointerSizeInBits() == 32 ? 2 : 3;
+    }
+    auto getSymbolSection = [pElfReader, sizetSection](StringRef Name) -> int
+    {
+        unsigned SectionIndex = 0;
+        if (sizetSection != 0)
         {
-            pElfReader->GetSectionData(2, pData_sizet, dataSize_sizet);
+            SectionIndex = pElfReader->GetSymbolSectionIndex(sizetSection, Name.data(), Name.size());
         }
-        else
+        if (SectionIndex == 0)
         {
-            pElfReader->GetSectionData(3, pData_sizet, dataSize_sizet);
+            SectionIndex = pElfReader->GetSymbolSectionIndex(1, Name.data(), Name.size());
         }
-        WriteElfHeaderToMap(Map, pData_sizet, dataSize_sizet);
-    }
+        return (int)SectionIndex;
+    };
 
     unsigned numOfHeaders = pElfReader->GetElfHeader()->NumSectionHeaderEntries;
     std::vector<std::unique_ptr<llvm::Module>> elf_index(numOfHeaders);
@@ -361,16 +343,14 @@ std::unique_ptr<llvm::Module> BIImport::Construct(Module& M, CLElfLib::CElfReade
                 {
                     funcName = StringRef("enqueue_IB_kernel");
                 }
-                int SectionIndex = Map[funcName];
+                int SectionIndex = getSymbolSection(funcName);
                 if (SectionIndex == 0 || pCallee->isIntrinsic()) continue;
                 if (elf_index[SectionIndex] == NULL)
                 {
-                    char* pData_Func = NULL;
-                    size_t SectionSize = 0;
-                    pElfReader->GetSectionData(SectionIndex, pData_Func, SectionSize);
+                    CLElfLib::SElfSectionView Section = pElfReader->GetSectionView(SectionIndex);
                     std::unique_ptr<MemoryBuffer> OutputBuffer =
                         MemoryBuffer::getMemBufferCopy(
-                            StringRef(pData_Func, SectionSize));
+                            StringRef(Section.pData, Section.DataSize));
                     llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
                         getOwningLazyBitcodeModule(std::move(OutputBuffer), M.getContext());
                     if (llvm::Error EC = ModuleOrErr.takeError())
@@ -460,14 +440,12 @@ std::unique_ptr<llvm::Module> BIImport::Construct(Module& M, CLElfLib::CElfReade
     {
         if (!global_iterator.hasInitializer() && !global_iterator.use_empty())
         {
-            int SectionIndex = Map[global_iterator.getName()];
+            int SectionIndex = getSymbolSection(global_iterator.getName());
             if (SectionIndex == 0) continue;
-            char* pData_Func = NULL;
-            size_t SectionSize = 0;
-            pElfReader->GetSectionData(SectionIndex, pData_Func, SectionSize);
+            CLElfLib::SElfSectionView Section = pElfReader->GetSectionView(SectionIndex);
             std::unique_ptr<MemoryBuffer> OutputBuffer =
                 MemoryBuffer::getMemBufferCopy(
-                    StringRef(pData_Func, SectionSize));
+                    StringRef(Section.pData, Section.DataSize));
             llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
                 getOwningLazyBitcodeModule(std::move(OutputBuffer), M.getContext());
             if (llvm::Error EC = ModuleOrErr.takeError())
@@ -94,9 +94,6 @@ namespace IGC
         static llvm::Function* GetBuiltinFunction(llvm::StringRef funcName, llvm::Module* GenericModule);
         llvm::Function* GetBuiltinFunction2(llvm::StringRef funcName) const;
 
-        /// @brief  Read elf Header file that is constructed by Build Packager and write to a DenseMap.
-        static void WriteElfHeaderToMap(llvm::DenseMap<llvm::StringRef, int>& Map, char* pData, size_t dataSize);
-
     protected:
         /// Builtin module - contains the source function definition to import
         std::unique_ptr<llvm::Module> m_GenericModule;
@@ -36,6 +36,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/Dominators.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "common/LLVMWarningsPop.hpp"
 
 using namespace llvm;
@@ -99,6 +100,11 @@ namespace IGC {
 
         /// @brief - Current processed function
         llvm::Function* m_currFunction;
+
+        /// @brief  Place the allocas of the current kernel in SLM, one slot per
+        ///         work-item, when its work-group is small enough.
+        /// @return true if the allocas were resolved, false otherwise.
+        bool resolveAllocasToSLM(llvm::SmallVectorImpl<llvm::AllocaInst*>& allocaInsts);
     };
 
     ModulePass* CreatePrivateMemoryResolution()
@@ -684,6 +690,172 @@ public:
 };
 
 
+// Return true if every use of the private pointer V can be rewritten to the
+// local address space: V may only be indexed, bitcast, used as the address of
+// a simple load/store or by lifetime markers.
+static bool canRewriteToLocal(Value* V)
+{
+    for (auto U : V->users())
+    {
+        if (isa<GetElementPtrInst>(U) || isa<BitCastInst>(U))
+        {
+            if (!canRewriteToLocal(U))
+                return false;
+        }
+        else if (LoadInst * LI = dyn_cast<LoadInst>(U))
+        {
+            if (!LI->isSimple())
+                return false;
+        }
+        else if (StoreInst * SI = dyn_cast<StoreInst>(U))
+        {
+            if (!SI->isSimple() || SI->getValueOperand() == V)
+                return false;
+        }
+        else if (IntrinsicInst * II = dyn_cast<IntrinsicInst>(U))
+        {
+            if (II->getIntrinsicID() != Intrinsic::lifetime_start &&
+                II->getIntrinsicID() != Intrinsic::lifetime_end)
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rewrite the uses of the private pointer Old with the local pointer New and
+// erase them. Old itself is left for the caller to erase.
+static void rewriteToLocal(Instruction* Old, Value* New)
+{
+    SmallVector<User*, 8> users(Old->user_begin(), Old->user_end());
+    for (auto U : users)
+    {
+        Instruction* I = cast<Instruction>(U);
+        IRBuilder<> builder(I);
+        if (GetElementPtrInst * GEP = dyn_cast<GetElementPtrInst>(I))
+        {
+            SmallVector<Value*, 4> indices(GEP->idx_begin(), GEP->idx_end());
+            Value* newGEP = GEP->isInBounds() ?
+                builder.CreateInBoundsGEP(New, indices, GEP->getName()) :
+                builder.CreateGEP(New, indices, GEP->getName());
+            rewriteToLocal(GEP, newGEP);
+        }
+        else if (BitCastInst * BC = dyn_cast<BitCastInst>(I))
+        {
+            Type* newTy = PointerType::get(BC->getType()->getPointerElementType(), ADDRESS_SPACE_LOCAL);
+            rewriteToLocal(BC, builder.CreateBitCast(New, newTy, BC->getName()));
+        }
+        else if (LoadInst * LI = dyn_cast<LoadInst>(I))
+        {
+            LoadInst* newLI = builder.CreateAlignedLoad(New, LI->getAlignment(), LI->getName());
+            newLI->setDebugLoc(LI->getDebugLoc());
+            LI->replaceAllUsesWith(newLI);
+        }
+        else if (StoreInst * SI = dyn_cast<StoreInst>(I))
+        {
+            StoreInst* newSI = builder.CreateAlignedStore(SI->getValueOperand(), New, SI->getAlignment());
+            newSI->setDebugLoc(SI->getDebugLoc());
+        }
+        // Lifetime markers are simply dropped.
+        I->eraseFromParent();
+    }
+}
+
+bool PrivateMemoryResolution::resolveAllocasToSLM(SmallVectorImpl<AllocaInst*>& allocaInsts)
+{
+    // PrivateMemoryUsageAnalysis marks the kernels that qualify and requests
+    // their local ids, see PrivateMemoryUsageAnalysis::isSLMPrivateMemoryCandidate.
+    ImplicitArgs implicitArgs(*m_currFunction, m_pMdUtils);
+    if (!m_currFunction->hasFnAttribute("SLMPrivateMemory") ||
+        !implicitArgs.isImplicitArgExist(ImplicitArg::LOCAL_ID_X) ||
+        !implicitArgs.isImplicitArgExist(ImplicitArg::LOCAL_ID_Y) ||
+        !implicitArgs.isImplicitArgExist(ImplicitArg::LOCAL_ID_Z))
+    {
+        return false;
+    }
+
+    ModuleMetaData* modMD = getAnalysis<MetaDataUtilsWrapper>().getModuleMetaData();
+    if (modMD->compOpt.OptDisable)
+    {
+        return false;
+    }
+
+    // The private memory of callees is laid out after the kernel's own buffers
+    // and would need the same treatment; keep it simple and give up.
+    for (auto& BB : *m_currFunction)
+    {
+        for (auto& I : BB)
+        {
+            if (CallInst * CI = dyn_cast<CallInst>(&I))
+            {
+                Function* callee = CI->getCalledFunction();
+                if (!callee || !callee->isDeclaration())
+                    return false;
+            }
+        }
+    }
+
+    for (auto pAI : allocaInsts)
+    {
+        if (!canRewriteToLocal(pAI))
+            return false;
+    }
+
+    IGCMD::ThreadGroupSizeMetaDataHandle tgSize = m_pMdUtils->getFunctionsInfoItem(m_currFunction)->getThreadGroupSize();
+    if (!tgSize->hasValue())
+    {
+        return false;
+    }
+    uint32_t dimX = tgSize->getXDim();
+    uint32_t dimY = tgSize->getYDim();
+    uint32_t dimZ = tgSize->getZDim();
+    uint32_t groupSize = dimX * dimY * dimZ;
+
+    // Keep each work-item slot dword aligned.
+    unsigned int stride = iSTD::Align(m_ModAllocaInfo->getTotalPrivateMemPerWI(m_currFunction), 4);
+    uint64_t slmSize = (uint64_t)groupSize * stride;
+    unsigned int slmBase = iSTD::Align(modMD->FuncMD[m_currFunction].localSize, 32);
+    if (groupSize == 0 ||
+        slmSize > IGC_GET_FLAG_VALUE(SLMPrivateMemoryMaxSize) ||
+        slmBase + slmSize > 64 * 1024)
+    {
+        return false;
+    }
+
+    // {buffer i ptr} = slmBase + linearLocalId * stride + {buffer i offset per WI}
+    // with linearLocalId = x + dimX * (y + dimY * z)
+    llvm::IRBuilder<> entryBuilder(&*m_currFunction->getEntryBlock().getFirstInsertionPt());
+    IntegerType* typeInt32 = entryBuilder.getInt32Ty();
+    Value* idX = entryBuilder.CreateZExtOrTrunc(implicitArgs.getArgInFunc(*m_currFunction, ImplicitArg::LOCAL_ID_X), typeInt32);
+    Value* idY = entryBuilder.CreateZExtOrTrunc(implicitArgs.getArgInFunc(*m_currFunction, ImplicitArg::LOCAL_ID_Y), typeInt32);
+    Value* idZ = entryBuilder.CreateZExtOrTrunc(implicitArgs.getArgInFunc(*m_currFunction, ImplicitArg::LOCAL_ID_Z), typeInt32);
+    Value* linearId = entryBuilder.CreateMul(idZ, entryBuilder.getInt32(dimY));
+    linearId = entryBuilder.CreateAdd(linearId, idY);
+    linearId = entryBuilder.CreateMul(linearId, entryBuilder.getInt32(dimX));
+    linearId = entryBuilder.CreateAdd(linearId, idX, VALUE_NAME("linearLocalId"));
+    Value* wiOffset = entryBuilder.CreateMul(linearId, entryBuilder.getInt32(stride));
+    wiOffset = entryBuilder.CreateAdd(wiOffset, entryBuilder.getInt32(slmBase), VALUE_NAME("slmPrivateBase"));
+
+    for (auto pAI : allocaInsts)
+    {
+        llvm::IRBuilder<> builder(pAI);
+        unsigned int bufferOffset = m_ModAllocaInfo->getBufferOffset(pAI);
+        Value* offset = builder.CreateAdd(wiOffset, builder.getInt32(bufferOffset), VALUE_NAME(pAI->getName() + ".slmOffset"));
+        Type* ptrTy = PointerType::get(pAI->getAllocatedType(), ADDRESS_SPACE_LOCAL);
+        Value* slmBuffer = builder.CreateIntToPtr(offset, ptrTy, VALUE_NAME(pAI->getName() + ".slmBuffer"));
+        rewriteToLocal(pAI, slmBuffer);
+        pAI->eraseFromParent();
+    }
+
+    modMD->FuncMD[m_currFunction].localSize = iSTD::Align(slmBase + (unsigned int)slmSize, 32);
+    modMD->FuncMD[m_currFunction].privateMemoryPerWI = 0;
+    modMD->privateMemoryPerWI = 0;
+    return true;
+}
+
 bool PrivateMemoryResolution::resolveAllocaInstructions(bool stackCall)
 {
     // It is possible that there is no alloca instruction in the caller but there
@@ -704,6 +876,12 @@ bool PrivateMemoryResolution::resolveAllocaInstructions(bool stackCall)
     }
 
     sinkAllocas(allocaInsts);
+
+    if (!stackCall && resolveAllocasToSLM(allocaInsts))
+    {
+        return true;
+    }
+
     // If there are N+1 private buffers, and M+1 threads,
     // the layout representing the private memory will look like this:
 
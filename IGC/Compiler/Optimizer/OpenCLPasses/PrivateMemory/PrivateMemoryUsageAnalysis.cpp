@@ -28,6 +28,12 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "AdaptorCommon/ImplicitArgs.hpp"
 #include "Compiler/IGCPassSupport.h"
+#include "Compiler/MetaDataApi/IGCMetaDataHelper.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Module.h>
+#include "common/LLVMWarningsPop.hpp"
 
 using namespace llvm;
 using namespace IGC;
@@ -45,7 +51,7 @@ IGC_INITIALIZE_PASS_END(PrivateMemoryUsageAnalysis, PASS_FLAG, PASS_DESCRIPTION,
 char PrivateMemoryUsageAnalysis::ID = 0;
 
 PrivateMemoryUsageAnalysis::PrivateMemoryUsageAnalysis()
-    : ModulePass(ID), m_hasPrivateMem(false)
+    : ModulePass(ID), m_hasPrivateMem(false), m_hasStackCall(false), m_allocaSize(0)
 {
     initializePrivateMemoryUsageAnalysisPass(*PassRegistry::getPassRegistry());
 
@@ -79,6 +85,8 @@ bool PrivateMemoryUsageAnalysis::runOnFunction(Function& F)
 {
     // Processing new function
     m_hasPrivateMem = false;
+    m_hasStackCall = false;
+    m_allocaSize = 0;
 
     visit(F);
 
@@ -142,6 +150,16 @@ bool PrivateMemoryUsageAnalysis::runOnFunction(Function& F)
     {
         implicitArgs.push_back(ImplicitArg::PRIVATE_BASE);
     }
+
+    // PrivateMemoryResolution may place the allocas of small work-groups in SLM,
+    // indexed by the linearized local id.
+    if (isSLMPrivateMemoryCandidate(F))
+    {
+        F.addFnAttr("SLMPrivateMemory");
+        implicitArgs.push_back(ImplicitArg::LOCAL_ID_X);
+        implicitArgs.push_back(ImplicitArg::LOCAL_ID_Y);
+        implicitArgs.push_back(ImplicitArg::LOCAL_ID_Z);
+    }
     ImplicitArgs::addImplicitArgs(F, implicitArgs, getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils());
 
     return true;
@@ -154,6 +172,7 @@ void PrivateMemoryUsageAnalysis::visitCallInst(llvm::CallInst& CI)
     {
         // If a called function is indirect or uses stack call, we need private memory for the parent
         m_hasPrivateMem = true;
+        m_hasStackCall = true;
     }
 }
 
@@ -163,6 +182,39 @@ void PrivateMemoryUsageAnalysis::visitAllocaInst(llvm::AllocaInst& AI)
 
     // If we encountered Alloca, then the function uses private memory
     m_hasPrivateMem = true;
+
+    const DataLayout& DL = AI.getModule()->getDataLayout();
+    uint64_t count = 1;
+    if (AI.isArrayAllocation())
+    {
+        ConstantInt* pCount = dyn_cast<ConstantInt>(AI.getArraySize());
+        // A variable sized alloca can never be placed in SLM.
+        count = pCount ? pCount->getZExtValue() : UINT32_MAX;
+    }
+    m_allocaSize += DL.getTypeAllocSize(AI.getAllocatedType()) * count;
+}
+
+bool PrivateMemoryUsageAnalysis::isSLMPrivateMemoryCandidate(Function& F) const
+{
+    CodeGenContext* pCtx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    IGCMD::MetaDataUtils* pMdUtils = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+
+    if (!IGC_IS_FLAG_ENABLED(EnableSLMPrivateMemory) ||
+        pCtx->type != ShaderType::OPENCL_SHADER ||
+        m_allocaSize == 0 || m_hasStackCall ||
+        F.hasFnAttribute("visaStackCall") ||
+        !isEntryFunc(pMdUtils, &F))
+    {
+        return false;
+    }
+
+    // Only kernels with a known, small work-group size qualify.
+    uint32_t groupSize = IGCMD::IGCMetaDataHelper::getThreadGroupSize(*pMdUtils, &F);
+    if (groupSize == 0 || groupSize > IGC_GET_FLAG_VALUE(SLMPrivateMemoryMaxGroupSize))
+    {
+        return false;
+    }
+    return m_allocaSize * groupSize <= IGC_GET_FLAG_VALUE(SLMPrivateMemoryMaxSize);
 }
 
 void PrivateMemoryUsageAnalysis::visitBinaryOperator(llvm::BinaryOperator& I)
@@ -88,8 +88,18 @@ namespace IGC
         bool runOnFunction(llvm::Function& F);
 
 
+        /// @brief  Returns true if the private memory of F may be placed in SLM,
+        ///         in which case the local ids are needed to address it.
+        bool isSLMPrivateMemoryCandidate(llvm::Function& F) const;
+
         /// @brief  A flag signaling if the current function uses private memory
         bool m_hasPrivateMem;
+
+        /// @brief  A flag signaling if the current function has indirect or stack calls
+        bool m_hasStackCall;
+
+        /// @brief  Total size in bytes of the allocas in the current function
+        uint64_t m_allocaSize;
     };
 
 } // namespace IGC
@@ -37,11 +37,18 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "llvmWrapper/IR/Instructions.h"
 #include "llvmWrapper/Support/Alignment.h"
+#include "llvmWrapper/Transforms/Utils/ScalarEvolutionExpander.h"
 
 #include <llvmWrapper/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/GetElementPtrTypeIterator.h>
+#include <llvm/Analysis/ScalarEvolutionExpressions.h>
 #include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Transforms/Utils/BasicBlockUtils.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/LoopUtils.h>
+#include <llvm/Support/CommandLine.h>
 #include "common/LLVMWarningsPop.hpp"
 
 #include <string>
@@ -50,6 +57,10 @@ using namespace llvm;
 using namespace IGC;
 using namespace IGC::IGCMD;
 
+static cl::opt<bool> ForceLoopVersioning(
+    "igc-s2s-loop-versioning", cl::init(false), cl::Hidden,
+    cl::desc("Version loops in StatelessToStatefull regardless of EnableStatelessToStatefullVersioning (default false)"));
+
 // Register pass to igc-opt
 #define PASS_FLAG "igc-stateless-to-statefull-resolution"
 #define PASS_DESCRIPTION "Tries to convert stateless to statefull accesses"
@@ -58,6 +69,9 @@ using namespace IGC::IGCMD;
 IGC_INITIALIZE_PASS_BEGIN(StatelessToStatefull, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
 IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
 IGC_INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
+IGC_INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
 IGC_INITIALIZE_PASS_END(StatelessToStatefull, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
 
 // This pass turns a global/constants address space (stateless) load/store into a statefull a load/store.
@@ -135,6 +149,21 @@ IGC_INITIALIZE_PASS_END(StatelessToStatefull, PASS_FLAG, PASS_DESCRIPTION, PASS_
 //                 have implicit BUFFER_OFFSET arguments at all.
 //
 
+//  Loop versioning
+//    When the offset of an access in an innermost loop cannot be proven positive, but it is
+//    loop invariant or an affine function of the induction variable, the loop is versioned
+//    (EnableStatelessToStatefullVersioning). The preheader checks that the first and the last
+//    offset of every such access are within [0, 4GB - access size], the checked copy of the
+//    loop uses statefull accesses and the other copy keeps the stateless ones:
+//
+//      for.body.s2s.check:
+//        %ok = (first0 <= limit0) & (last0 <= limit0) & ...
+//        br i1 %ok, label %for.body.ph, label %for.body.ph.stateless
+//
+//    As the range is checked on the whole 64-bit offset, the 32-bit truncated offset used by
+//    the statefull access is exact.
+//
+
 // Future things to look out for:
 //  - This transformation cannot be done if a pointer is stored to or loaded from memory
 //    In general, if an address of load/store cannot be resolevd to the kernel argument, the load/store
@@ -196,8 +225,17 @@ bool StatelessToStatefull::runOnFunction(llvm::Function& F)
     CodeGenContext* ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
     m_pKernelArgs = new KernelArgs(F, &(F.getParent()->getDataLayout()), pMdUtils, modMD, ctx->platform.getGRFSize());
 
+    // Versioning only pays off if the offsets would otherwise have to be proven positive.
+    if ((IGC_IS_FLAG_ENABLED(EnableStatelessToStatefullVersioning) || ForceLoopVersioning) &&
+        (!m_hasBufferOffsetArg || m_hasOptionalBufferOffsetArg) &&
+        IGC_IS_FLAG_DISABLED(SToSProducesPositivePointer))
+    {
+        m_changed |= versionLoops(F);
+    }
+
     visit(F);
 
+    m_versionedAccesses.clear();
     finalizeArgInitialValue(&F);
     delete m_pImplicitArgs;
     delete m_pKernelArgs;
@@ -336,7 +374,7 @@ bool StatelessToStatefull::getOffsetFromGEP(
 }
 
 bool StatelessToStatefull::pointerIsPositiveOffsetFromKernelArgument(
-    Function* F, Value* V, Value*& offset, unsigned int& argNumber)
+    Function* F, Value* V, Value*& offset, unsigned int& argNumber, bool isRangeChecked)
 {
     auto getPointeeAlign = [](const DataLayout* DL, Value* ptrVal)-> unsigned {
         if (PointerType* PTy = dyn_cast<PointerType>(ptrVal->getType()))
@@ -415,15 +453,19 @@ bool StatelessToStatefull::pointerIsPositiveOffsetFromKernelArgument(
                 (!m_hasBufferOffsetArg || m_hasOptionalBufferOffsetArg) &&
                 IGC_IS_FLAG_DISABLED(SToSProducesPositivePointer))
             {
-                // This is for proving that the offset is positive.
-                for (int i = 0, sz = GEPs.size(); i < sz; ++i)
+                // This is for proving that the offset is positive. Accesses in
+                // versioned loops are already checked at runtime.
+                if (!isRangeChecked)
                 {
-                    GetElementPtrInst* tgep = GEPs[i];
-                    for (auto U = tgep->idx_begin(), E = tgep->idx_end(); U != E; ++U)
+                    for (int i = 0, sz = GEPs.size(); i < sz; ++i)
                     {
-                        Value* Idx = U->get();
-                        gepProducesPositivePointer &=
-                            valueIsPositive(Idx, &(F->getParent()->getDataLayout()), AC);
+                        GetElementPtrInst* tgep = GEPs[i];
+                        for (auto U = tgep->idx_begin(), E = tgep->idx_end(); U != E; ++U)
+                        {
+                            Value* Idx = U->get();
+                            gepProducesPositivePointer &=
+                                valueIsPositive(Idx, &(F->getParent()->getDataLayout()), AC);
+                        }
                     }
                 }
 
@@ -444,6 +486,238 @@ bool StatelessToStatefull::pointerIsPositiveOffsetFromKernelArgument(
     return false;
 }
 
+const KernelArg* StatelessToStatefull::getVersioningBase(Value* Ptr, bool& isPositive)
+{
+    PointerType* ptrType = dyn_cast<PointerType>(Ptr->getType());
+    if (!ptrType || (ptrType->getAddressSpace() != ADDRESS_SPACE_GLOBAL &&
+        ptrType->getAddressSpace() != ADDRESS_SPACE_CONSTANT))
+    {
+        return nullptr;
+    }
+
+    Function* F = cast<Instruction>(Ptr)->getParent()->getParent();
+    const DataLayout* DL = &F->getParent()->getDataLayout();
+    AssumptionCache* AC = getAC(F);
+
+    // Same base matching as pointerIsPositiveOffsetFromKernelArgument(), without
+    // creating any instruction.
+    isPositive = true;
+    Value* base = Ptr->stripPointerCasts();
+    bool hasGEP = false;
+    while (GetElementPtrInst * gep = dyn_cast<GetElementPtrInst>(base))
+    {
+        hasGEP = true;
+        for (auto U = gep->idx_begin(), E = gep->idx_end(); U != E; ++U)
+        {
+            isPositive &= valueIsPositive(U->get(), DL, AC);
+        }
+        base = gep->getPointerOperand()->stripPointerCasts();
+    }
+
+    if (!hasGEP || isa<Instruction>(base) ||
+        cast<PointerType>(base->getType())->getAddressSpace() != ptrType->getAddressSpace())
+    {
+        return nullptr;
+    }
+
+    const KernelArg* arg = getKernelArg(base);
+    if (!arg || arg->isImplicitArg())
+    {
+        return nullptr;
+    }
+
+    // Unaligned arguments need buffer offset, see pointerIsPositiveOffsetFromKernelArgument().
+    if (IGC_IS_FLAG_ENABLED(UseSubDWAlignedPtrArg))
+    {
+        Type* pointeeTy = base->getType()->getPointerElementType();
+        if (!pointeeTy->isSized() || DL->getABITypeAlignment(pointeeTy) < 4)
+        {
+            return nullptr;
+        }
+    }
+    return arg;
+}
+
+bool StatelessToStatefull::versionLoop(Loop* L, LoopInfo* LI, DominatorTree* DT, ScalarEvolution* SE)
+{
+    BasicBlock* preheader = L->getLoopPreheader();
+    BasicBlock* latch = L->getLoopLatch();
+    BasicBlock* exitBB = L->getExitBlock();
+    if (!preheader || !latch || !exitBB ||
+        L->getExitingBlock() != latch || exitBB->getSinglePredecessor() != latch)
+    {
+        return false;
+    }
+
+    const SCEV* BTC = SE->getBackedgeTakenCount(L);
+    if (isa<SCEVCouldNotCompute>(BTC))
+    {
+        return false;
+    }
+
+    // Versioning duplicates the loop, keep the code growth bounded.
+    unsigned numInsts = 0;
+    for (BasicBlock* BB : L->blocks())
+    {
+        numInsts += BB->size();
+    }
+    if (numInsts > IGC_GET_FLAG_VALUE(StatelessToStatefullVersioningMaxLoopSize))
+    {
+        return false;
+    }
+
+    const DataLayout& DL = preheader->getModule()->getDataLayout();
+    SmallVector<std::pair<const SCEV*, uint64_t>, 8> checks;
+    SmallVector<Instruction*, 8> accesses;
+    for (BasicBlock* BB : L->blocks())
+    {
+        for (Instruction& I : *BB)
+        {
+            Value* ptr = nullptr;
+            Type* accessTy = nullptr;
+            if (LoadInst * pLoad = dyn_cast<LoadInst>(&I))
+            {
+                ptr = pLoad->getPointerOperand();
+                accessTy = pLoad->getType();
+            }
+            else if (StoreInst * pStore = dyn_cast<StoreInst>(&I))
+            {
+                ptr = pStore->getPointerOperand();
+                accessTy = pStore->getValueOperand()->getType();
+            }
+            if (!ptr || !isa<Instruction>(ptr))
+            {
+                continue;
+            }
+
+            bool isPositive = false;
+            const KernelArg* arg = getVersioningBase(ptr, isPositive);
+            if (!arg || isPositive)
+            {
+                continue;
+            }
+
+            Value* base = const_cast<Argument*>(arg->getArg());
+            const SCEV* offset = SE->getMinusSCEV(SE->getSCEV(ptr), SE->getSCEV(base));
+            if (isa<SCEVCouldNotCompute>(offset) || offset->getType()->getScalarSizeInBits() != 64)
+            {
+                continue;
+            }
+
+            // The offset is monotonic in the loop, so checking both ends is enough.
+            // That needs nuw or nsw, nw alone lets the offset wrap in between. With
+            // nsw the offset is monotonic as a signed value, which is still fine as
+            // an unsigned compare against a limit below 2^63 also rejects negative ends.
+            const SCEV* first = offset;
+            const SCEV* last = offset;
+            if (!SE->isLoopInvariant(offset, L))
+            {
+                const SCEVAddRecExpr* AR = dyn_cast<SCEVAddRecExpr>(offset);
+                if (!AR || AR->getLoop() != L || !AR->isAffine() ||
+                    (!AR->hasNoUnsignedWrap() && !AR->hasNoSignedWrap()))
+                {
+                    continue;
+                }
+                first = AR->getStart();
+                last = AR->evaluateAtIteration(BTC, *SE);
+            }
+            if (!isSafeToExpand(first, *SE) || !isSafeToExpand(last, *SE))
+            {
+                continue;
+            }
+
+            uint64_t limit = (1ULL << 32) - DL.getTypeStoreSize(accessTy);
+            checks.push_back(std::make_pair(first, limit));
+            if (last != first)
+            {
+                checks.push_back(std::make_pair(last, limit));
+            }
+            accesses.push_back(&I);
+        }
+    }
+
+    if (accesses.empty())
+    {
+        return false;
+    }
+
+    // Values live out of the loop must flow through exit PHIs that can merge
+    // the two versions.
+    formLCSSA(*L, *DT, LI, SE);
+
+    // Emit the range check in the original preheader.
+    BasicBlock* checkBB = preheader;
+    Instruction* insertPt = checkBB->getTerminator();
+    SCEVExpander expander(*SE, DL, "s2s.ver");
+    IRBuilder<> builder(insertPt);
+    Value* inRange = builder.getTrue();
+    for (auto& check : checks)
+    {
+        Value* offset = expander.expandCodeFor(check.first, builder.getInt64Ty(), insertPt);
+        builder.SetInsertPoint(insertPt);
+        Value* cmp = builder.CreateICmpULE(offset, builder.getInt64(check.second));
+        inRange = builder.CreateAnd(inRange, cmp, VALUE_NAME("s2s.inrange"));
+    }
+    checkBB->setName(L->getHeader()->getName() + ".s2s.check");
+
+    // Clone the loop with a fresh preheader; the clone keeps stateless accesses.
+    BasicBlock* PH = SplitBlock(checkBB, checkBB->getTerminator(), DT, LI);
+    PH->setName(L->getHeader()->getName() + ".ph");
+    ValueToValueMapTy VMap;
+    SmallVector<BasicBlock*, 8> clonedBlocks;
+    Loop* statelessLoop = cloneLoopWithPreheader(PH, checkBB, L, VMap, ".stateless", LI, DT, clonedBlocks);
+    remapInstructionsInBlocks(clonedBlocks, VMap);
+
+    Instruction* origTerm = checkBB->getTerminator();
+    BranchInst::Create(PH, statelessLoop->getLoopPreheader(), inRange, origTerm);
+    origTerm->eraseFromParent();
+    DT->changeImmediateDominator(exitBB, checkBB);
+
+    BasicBlock* clonedLatch = cast<BasicBlock>(VMap[latch]);
+    for (auto II = exitBB->begin(); PHINode * PN = dyn_cast<PHINode>(II); ++II)
+    {
+        Value* V = PN->getIncomingValueForBlock(latch);
+        Value* clonedV = VMap.lookup(V);
+        PN->addIncoming(clonedV ? clonedV : V, clonedLatch);
+    }
+
+    Loop* outermost = L;
+    while (outermost->getParentLoop())
+    {
+        outermost = outermost->getParentLoop();
+    }
+    SE->forgetLoop(outermost);
+
+    // Only the accesses of the checked copy are range checked; the clone and any
+    // other access through the same pointers still need to be proven positive.
+    m_versionedAccesses.insert(accesses.begin(), accesses.end());
+    return true;
+}
+
+bool StatelessToStatefull::versionLoops(Function& F)
+{
+    DominatorTree* DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    LoopInfo* LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    ScalarEvolution* SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+
+    // Collect first, versioning adds new loops to LoopInfo.
+    SmallVector<Loop*, 8> innermostLoops;
+    for (Loop* L : LI->getLoopsInPreorder())
+    {
+        if (L->getSubLoops().empty())
+        {
+            innermostLoops.push_back(L);
+        }
+    }
+
+    bool changed = false;
+    for (Loop* L : innermostLoops)
+    {
+        changed |= versionLoop(L, LI, DT, SE);
+    }
+    return changed;
+}
+
 void StatelessToStatefull::visitCallInst(CallInst& I)
 {
     if (auto Inst = dyn_cast<GenIntrinsicInst>(&I))
@@ -467,7 +741,7 @@ void StatelessToStatefull::visitCallInst(CallInst& I)
 
             Value* offset = nullptr;
             unsigned int baseArgNumber  = 0;
-            if (pointerIsPositiveOffsetFromKernelArgument(F, ptr, offset, baseArgNumber))
+            if (pointerIsPositiveOffsetFromKernelArgument(F, ptr, offset, baseArgNumber, false))
             {
                 ModuleMetaData* modMD = getAnalysis<MetaDataUtilsWrapper>().getModuleMetaData();
                 FunctionMetaData* funcMD = &modMD->FuncMD[F];
@@ -526,7 +800,8 @@ void StatelessToStatefull::visitLoadInst(LoadInst& I)
 
     Value* offset = nullptr;
     unsigned int baseArgNumber = 0;
-    if (pointerIsPositiveOffsetFromKernelArgument(F, ptr, offset, baseArgNumber))
+    if (pointerIsPositiveOffsetFromKernelArgument(F, ptr, offset, baseArgNumber,
+            m_versionedAccesses.count(&I) != 0))
     {
         ModuleMetaData* modMD = getAnalysis<MetaDataUtilsWrapper>().getModuleMetaData();
         FunctionMetaData* funcMD = &modMD->FuncMD[F];
@@ -573,7 +848,8 @@ void StatelessToStatefull::visitStoreInst(StoreInst& I)
 
     Value* offset = nullptr;
     unsigned int baseArgNumber = 0;
-    if (pointerIsPositiveOffsetFromKernelArgument(F, ptr, offset, baseArgNumber))
+    if (pointerIsPositiveOffsetFromKernelArgument(F, ptr, offset, baseArgNumber,
+            m_versionedAccesses.count(&I) != 0))
     {
         Value* dataVal = I.getOperand(0);
 
@@ -28,12 +28,17 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "AdaptorCommon/ImplicitArgs.hpp"
 #include "Compiler/Optimizer/OpenCLPasses/KernelArgs.hpp"
 #include "Compiler/MetaDataUtilsWrapper.h"
+#include "common/igc_regkeys.hpp"
 
 #include "common/LLVMWarningsPush.hpp"
 #include <llvm/Pass.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/IR/Dominators.h>
 #include <llvm/IR/InstVisitor.h>
 #include <llvm/IR/Instruction.h>
 #include <llvm/Analysis/AssumptionCache.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/ScalarEvolution.h>
 #include "common/LLVMWarningsPop.hpp"
 
 namespace IGC
@@ -51,10 +56,20 @@ namespace IGC
 
         virtual void getAnalysisUsage(llvm::AnalysisUsage& AU) const override
         {
-            AU.setPreservesCFG();
             AU.addRequired<MetaDataUtilsWrapper>();
             AU.addRequired<llvm::AssumptionCacheTracker>();
             AU.addRequired<CodeGenContextWrapper>();
+            if (IGC_IS_FLAG_ENABLED(EnableStatelessToStatefullVersioning))
+            {
+                // Loop versioning changes the CFG.
+                AU.addRequired<llvm::DominatorTreeWrapperPass>();
+                AU.addRequired<llvm::LoopInfoWrapperPass>();
+                AU.addRequired<llvm::ScalarEvolutionWrapperPass>();
+            }
+            else
+            {
+                AU.setPreservesCFG();
+            }
         }
 
         virtual llvm::StringRef getPassName() const override
@@ -72,13 +87,21 @@ namespace IGC
         llvm::CallInst* createBufferPtr(
             unsigned addrSpace, llvm::Constant* argNumber, llvm::Instruction* InsertBefore);
         bool pointerIsPositiveOffsetFromKernelArgument(
-            llvm::Function* F, llvm::Value* V, llvm::Value*& offset, unsigned int& argNumber);
+            llvm::Function* F, llvm::Value* V, llvm::Value*& offset, unsigned int& argNumber,
+            bool isRangeChecked);
         bool getOffsetFromGEP(
             llvm::Function* F, llvm::SmallVector<llvm::GetElementPtrInst*, 4> GEPs,
             uint32_t argNumber, bool isImplicitArg, llvm::Value*& offset);
         llvm::Argument* getBufferOffsetArg(llvm::Function* F, uint32_t ArgNumber);
         void setPointerSizeTo32bit(int32_t AddrSpace, llvm::Module* M);
 
+        /// Version innermost loops on a runtime check of the offset range of
+        /// accesses that cannot be proven positive statically.
+        bool versionLoops(llvm::Function& F);
+        bool versionLoop(llvm::Loop* L, llvm::LoopInfo* LI,
+            llvm::DominatorTree* DT, llvm::ScalarEvolution* SE);
+        const KernelArg* getVersioningBase(llvm::Value* Ptr, bool& isPositive);
+
         void updateArgInfo(const KernelArg* KA, bool IsPositive);
         void finalizeArgInitialValue(llvm::Function* F);
 
@@ -123,6 +146,10 @@ namespace IGC
         KernelArgs* m_pKernelArgs;
         ArgInfoMap   m_argsInfo;
         bool m_changed;
+
+        // Loads and stores in versioned loops whose offsets have been range
+        // checked at runtime, so they can be treated as positive.
+        llvm::SmallPtrSet<llvm::Instruction*, 16> m_versionedAccesses;
     };
 
 }
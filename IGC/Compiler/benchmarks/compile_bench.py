@@ -0,0 +1,300 @@
+#!/usr/bin/env python
+
+#===================== begin_copyright_notice ==================================
+
+#Copyright (c) 2017 Intel Corporation
+
+#Permission is hereby granted, free of charge, to any person obtaining a
+#copy of this software and associated documentation files (the
+#"Software"), to deal in the Software without restriction, including
+#without limitation the rights to use, copy, modify, merge, publish,
+#distribute, sublicense, and/or sell copies of the Software, and to
+#permit persons to whom the Software is furnished to do so, subject to
+#the following conditions:
+
+#The above copyright notice and this permission notice shall be included
+#in all copies or substantial portions of the Software.
+
+#THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+#OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+#MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+#IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+#CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+#TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+#SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+
+#======================= end_copyright_notice ==================================
+
+"""Offline compile-time benchmark.
+
+Replays a corpus of dumped compiler inputs and reports how long each one
+takes to compile:
+
+  .isa / .visaasm   standalone vISA driver (GenX_IR)
+  .bc / .ll         igc_opt with the given pass pipeline
+  .spv              any driver command given with --spirv-cmd, e.g. a
+                    wrapper that calls TranslateBuild
+
+Each input is compiled --iterations times in a scratch directory. For every
+input the harness records wall time, peak RSS of the compiler process, the
+size of the files it produced and the per-phase times from the compile trace
+(-compileTraceFile for vISA, IGC_CompileTraceFile for IGC).
+
+Results are written as CSV and/or JSON. When --baseline points to a JSON file
+produced by an earlier run, the median wall time, peak RSS and phase times
+are compared against it and the script exits with 1 if any input regressed
+by more than --threshold percent.
+
+Example:
+  compile_bench.py corpus/ --visa GenX_IR --platform GEN9 \\
+      --json result.json --baseline baseline.json
+"""
+
+import argparse
+import csv
+import json
+import os
+import shlex
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+TRACE_NAME = "trace.json"
+
+VISA_EXTS = (".isa", ".visaasm", ".isaasm")
+LLVM_EXTS = (".bc", ".ll")
+SPIRV_EXTS = (".spv",)
+
+
+def collect_inputs(paths):
+    """Returns (path, name) pairs. Names are relative to the corpus directory
+    so that results can be compared between different checkouts."""
+    inputs = []
+    for path in paths:
+        if os.path.isdir(path):
+            for root, _, files in os.walk(path):
+                for name in files:
+                    if name.endswith(VISA_EXTS + LLVM_EXTS + SPIRV_EXTS):
+                        full = os.path.join(root, name)
+                        inputs.append((os.path.abspath(full), os.path.relpath(full, path)))
+        else:
+            inputs.append((os.path.abspath(path), os.path.basename(path)))
+    return sorted(inputs, key=lambda i: i[1])
+
+
+def build_command(args, input_path, work_dir):
+    """Returns (argv, env) used to compile input_path, or None to skip it."""
+    trace = os.path.join(work_dir, TRACE_NAME)
+    env = dict(os.environ)
+    # IGC reads its regkeys from IGC_<name> environment variables
+    env["IGC_CompileTraceFile"] = trace
+    env["IGC_CompileTraceFormat"] = "0"
+
+    if input_path.endswith(VISA_EXTS):
+        if not args.visa:
+            return None
+        argv = [args.visa, input_path, "-platform", args.platform, "-binary",
+                "-compileTraceFile", trace]
+        argv += shlex.split(args.visa_args)
+    elif input_path.endswith(LLVM_EXTS):
+        if not args.igc_opt:
+            return None
+        argv = [args.igc_opt, input_path, "-o", os.path.join(work_dir, "out.bc")]
+        argv += shlex.split(args.igc_opt_args)
+    else:
+        if not args.spirv_cmd:
+            return None
+        argv = [a.format(input=input_path, output=work_dir, platform=args.platform)
+                for a in shlex.split(args.spirv_cmd)]
+    return argv, env
+
+
+def run_once(argv, env, work_dir, timeout):
+    """Runs the compiler once. Returns (wall seconds, peak RSS KB, exit code)."""
+    start = time.perf_counter()
+    proc = subprocess.Popen(argv, cwd=work_dir, env=env,
+                            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    deadline = start + timeout if timeout else None
+    while True:
+        pid, status, usage = os.wait4(proc.pid, os.WNOHANG)
+        if pid != 0:
+            break
+        if deadline and time.perf_counter() > deadline:
+            proc.kill()
+            pid, status, usage = os.wait4(proc.pid, 0)
+            break
+        time.sleep(0.001)
+    wall = time.perf_counter() - start
+    # The child is already reaped, keep Popen from waiting on it again
+    proc.returncode = -os.WTERMSIG(status) if os.WIFSIGNALED(status) else os.WEXITSTATUS(status)
+    # ru_maxrss is in kilobytes on Linux
+    return wall, usage.ru_maxrss, proc.returncode
+
+
+def read_trace(path):
+    """Sums the span durations of a compile trace by category and name (ms)."""
+    phases = {}
+    if not os.path.exists(path):
+        return phases
+    with open(path, "r") as f:
+        text = f.read().rstrip()
+    # The trace is streamed, so the array may be left open
+    if text.endswith(","):
+        text = text[:-1]
+    if not text.endswith("]"):
+        text += "]"
+    try:
+        events = json.loads(text)
+    except ValueError:
+        return phases
+    for e in events:
+        if e.get("ph") != "X":
+            continue
+        key = "%s:%s" % (e.get("cat", ""), e.get("name", ""))
+        phases[key] = phases.get(key, 0.0) + float(e.get("dur", 0.0)) / 1000.0
+    return phases
+
+
+def output_size(work_dir):
+    total = 0
+    for root, _, files in os.walk(work_dir):
+        for name in files:
+            if name != TRACE_NAME:
+                total += os.path.getsize(os.path.join(root, name))
+    return total
+
+
+def bench_input(args, input_path, input_name):
+    samples = []
+    for i in range(args.warmup + args.iterations):
+        work_dir = tempfile.mkdtemp(prefix="igc-bench-")
+        try:
+            cmd = build_command(args, input_path, work_dir)
+            if cmd is None:
+                return None
+            argv, env = cmd
+            wall, rss, code = run_once(argv, env, work_dir, args.timeout)
+            if code != 0:
+                return {"input": input_name, "status": "failed(%d)" % code}
+            if i < args.warmup:
+                continue
+            samples.append({
+                "wall": wall,
+                "rss": rss,
+                "size": output_size(work_dir),
+                "phases": read_trace(os.path.join(work_dir, TRACE_NAME)),
+            })
+        finally:
+            shutil.rmtree(work_dir, ignore_errors=True)
+
+    walls = [s["wall"] for s in samples]
+    phase_names = sorted(set(k for s in samples for k in s["phases"]))
+    return {
+        "input": input_name,
+        "status": "ok",
+        "iterations": len(samples),
+        "wall_ms_median": statistics.median(walls) * 1000.0,
+        "wall_ms_min": min(walls) * 1000.0,
+        "wall_ms_stdev": (statistics.stdev(walls) * 1000.0) if len(walls) > 1 else 0.0,
+        "peak_rss_kb": max(s["rss"] for s in samples),
+        "output_bytes": samples[-1]["size"],
+        "phases_ms": dict((p, statistics.median([s["phases"].get(p, 0.0) for s in samples]))
+                          for p in phase_names),
+    }
+
+
+def write_csv(path, results):
+    phase_names = sorted(set(p for r in results for p in r.get("phases_ms", {})))
+    columns = ["input", "status", "iterations", "wall_ms_median", "wall_ms_min",
+               "wall_ms_stdev", "peak_rss_kb", "output_bytes"]
+    with open(path, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(columns + phase_names)
+        for r in results:
+            row = [r.get(c, "") for c in columns]
+            row += [r.get("phases_ms", {}).get(p, "") for p in phase_names]
+            writer.writerow(row)
+
+
+def compare(results, baseline_path, threshold, min_ms):
+    """Prints regressions against the baseline. Returns their number."""
+    with open(baseline_path, "r") as f:
+        baseline = dict((r["input"], r) for r in json.load(f)["results"])
+
+    def regressed(new, old, floor):
+        return old > 0 and new > floor and (new - old) * 100.0 / old > threshold
+
+    num_regressions = 0
+    for r in results:
+        old = baseline.get(r["input"])
+        if old is None or r["status"] != "ok" or old.get("status") != "ok":
+            continue
+        checks = [("wall_ms_median", r["wall_ms_median"], old["wall_ms_median"], min_ms),
+                  ("peak_rss_kb", r["peak_rss_kb"], old["peak_rss_kb"], 0)]
+        for phase, ms in r["phases_ms"].items():
+            checks.append((phase, ms, old.get("phases_ms", {}).get(phase, 0.0), min_ms))
+        for name, new, prev, floor in checks:
+            if regressed(new, prev, floor):
+                num_regressions += 1
+                print("REGRESSION %s %s: %.2f -> %.2f (%+.1f%%)" %
+                      (r["input"], name, prev, new, (new - prev) * 100.0 / prev))
+    return num_regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="IGC/vISA compile-time benchmark")
+    parser.add_argument("inputs", nargs="+", help="input files or corpus directories")
+    parser.add_argument("--iterations", type=int, default=5)
+    parser.add_argument("--warmup", type=int, default=1)
+    parser.add_argument("--timeout", type=float, default=600.0, help="seconds per compile")
+    parser.add_argument("--visa", help="standalone vISA driver (GenX_IR)")
+    parser.add_argument("--visa-args", default="", help="extra vISA options")
+    parser.add_argument("--platform", default="GEN9")
+    parser.add_argument("--igc-opt", help="igc_opt binary used for LLVM inputs")
+    parser.add_argument("--igc-opt-args", default="", help="igc_opt pass pipeline")
+    parser.add_argument("--spirv-cmd",
+                        help="command for SPIR-V inputs; {input}, {output} and "
+                             "{platform} are substituted")
+    parser.add_argument("--csv", help="write results as CSV")
+    parser.add_argument("--json", help="write results as JSON")
+    parser.add_argument("--baseline", help="JSON results of a previous run")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="allowed slowdown against the baseline in percent")
+    parser.add_argument("--min-ms", type=float, default=1.0,
+                        help="ignore timings below this many milliseconds")
+    args = parser.parse_args()
+
+    results = []
+    for input_path, input_name in collect_inputs(args.inputs):
+        r = bench_input(args, input_path, input_name)
+        if r is None:
+            print("SKIP %s: no driver for this input" % input_name)
+            continue
+        results.append(r)
+        if r["status"] == "ok":
+            print("%-60s %10.2f ms %10d KB %10d B" % (input_name,
+                  r["wall_ms_median"], r["peak_rss_kb"], r["output_bytes"]))
+        else:
+            print("%-60s %s" % (input_name, r["status"]))
+
+    if args.csv:
+        write_csv(args.csv, results)
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"platform": args.platform, "iterations": args.iterations,
+                       "results": results}, f, indent=2, sort_keys=True)
+
+    failed = sum(1 for r in results if r["status"] != "ok")
+    regressions = compare(results, args.baseline, args.threshold, args.min_ms) \
+        if args.baseline else 0
+    return 1 if failed or regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,89 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-lane-compaction | FileCheck %s
+
+; The outer loop is divergent since its trip count depends on the local id.
+; %a and %b swap every iteration, so the latch value of each header PHI is
+; the other header PHI. %u is uniform but defined before the loop, so it
+; must move with the work like the local id %lid.
+
+; CHECK-LABEL: define void @test(
+; CHECK:       lc.header:
+; CHECK-DAG:     %i.lc = phi i32 [ 0, %entry ]
+; CHECK-DAG:     %a.lc = phi i32 [ 0, %entry ]
+; CHECK-DAG:     %b.lc = phi i32 [ 1, %entry ]
+; CHECK-DAG:     %u.lc = phi i32 [ %u, %entry ]
+; CHECK-DAG:     %lid.lc = phi i32 [ %lid, %entry ]
+; CHECK:       inner:
+; CHECK:         icmp ult i32 %j.next, %u.lc
+; CHECK:       outer.latch:
+; CHECK:         icmp ult i32 %i.next, %lid.lc
+; CHECK:       lc.latch:
+; CHECK-DAG:     phi i32 [ %a.lc, %lc.header ], [ %b.lc, %outer.latch ], [ %a.lc, %lc.finish ]
+; CHECK-DAG:     phi i32 [ %b.lc, %lc.header ], [ %a.lc, %outer.latch ], [ %b.lc, %lc.finish ]
+; CHECK:       lc.push:
+; CHECK-COUNT-6: store i32
+; CHECK:       lc.exit:
+
+define void @test(i32 addrspace(1)* %out, i32 %n, i16 %localIdX, i16 %localIdY, i16 %localIdZ) {
+entry:
+  %lid = zext i16 %localIdX to i32
+  %u = shl i32 %n, 1
+  br label %outer
+
+outer:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %a = phi i32 [ 0, %entry ], [ %b, %outer.latch ]
+  %b = phi i32 [ 1, %entry ], [ %a, %outer.latch ]
+  br label %inner
+
+inner:
+  %j = phi i32 [ 0, %outer ], [ %j.next, %inner ]
+  %j.next = add i32 %j, 1
+  %ic = icmp ult i32 %j.next, %u
+  br i1 %ic, label %inner, label %outer.latch
+
+outer.latch:
+  %i.next = add i32 %i, 1
+  %oc = icmp ult i32 %i.next, %lid
+  br i1 %oc, label %outer, label %exit
+
+exit:
+  %r = phi i32 [ %a, %outer.latch ]
+  store i32 %r, i32 addrspace(1)* %out, align 4
+  ret void
+}
+
+!igc.functions = !{!0}
+!0 = !{void (i32 addrspace(1)*, i32, i16, i16, i16)* @test, !1}
+!1 = !{!2, !3, !4, !8}
+!2 = !{!"function_type", i32 0}
+!3 = !{!"arg_desc"}
+!4 = !{!"implicit_arg_desc", !5, !6, !7}
+!5 = !{i32 7}
+!6 = !{i32 8}
+!7 = !{i32 9}
+!8 = !{!"thread_group_size", i32 16, i32 1, i32 1}
@@ -0,0 +1,85 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-layout | FileCheck %s
+
+; Without a profile, the layout visits the successors of a block in order and
+; places the last one visited right after it.
+
+define void @f0(i32 addrspace(1)* %dst, i32 %x) {
+entry:
+  %c = icmp sgt i32 %x, 0
+  br i1 %c, label %then, label %else, !prof !0
+
+then:
+  %a = add i32 %x, 1
+  store i32 %a, i32 addrspace(1)* %dst, align 4
+  br label %join
+
+else:
+  %b = sub i32 %x, 1
+  store i32 %b, i32 addrspace(1)* %dst, align 4
+  br label %join
+
+join:
+  ret void
+}
+
+; CHECK-LABEL: define void @f0
+; CHECK: entry:
+; CHECK: else:
+; CHECK: then:
+; CHECK: join:
+
+; With a profile, the hottest successor becomes the fall-through.
+
+define void @f1(i32 addrspace(1)* %dst, i32 %x) #0 {
+entry:
+  %c = icmp sgt i32 %x, 0
+  br i1 %c, label %then, label %else, !prof !0
+
+then:
+  %a = add i32 %x, 1
+  store i32 %a, i32 addrspace(1)* %dst, align 4
+  br label %join
+
+else:
+  %b = sub i32 %x, 1
+  store i32 %b, i32 addrspace(1)* %dst, align 4
+  br label %join
+
+join:
+  ret void
+}
+
+; CHECK-LABEL: define void @f1
+; CHECK: entry:
+; CHECK: then:
+; CHECK: else:
+; CHECK: join:
+
+attributes #0 = { "igc-pgo" }
+
+!0 = !{!"branch_weights", i32 90, i32 10}
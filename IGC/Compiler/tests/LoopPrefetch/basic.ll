@@ -0,0 +1,101 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-loop-prefetch | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-n8:16:32:64"
+
+define void @f0(float addrspace(1)* %src, float addrspace(1)* %dst, i64 %n) {
+entry:
+  %cmp0 = icmp sgt i64 %n, 0
+  br i1 %cmp0, label %loop, label %exit
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %loop ]
+  %acc = phi float [ 0.000000e+00, %entry ], [ %add, %loop ]
+  %p = getelementptr inbounds float, float addrspace(1)* %src, i64 %i
+  %v = load float, float addrspace(1)* %p, align 4
+  %add = fadd float %acc, %v
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp slt i64 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r = phi float [ 0.000000e+00, %entry ], [ %add, %loop ]
+  store float %r, float addrspace(1)* %dst, align 4
+  ret void
+}
+
+; The strided load is prefetched from the latch with a volatile load whose
+; result is unused.
+
+; CHECK-LABEL: define void @f0
+; CHECK: loop:
+; CHECK: %v = load float, float addrspace(1)* %p, align 4
+; CHECK: %prefetch = load volatile float, float addrspace(1)* {{.*}}, align 4
+; CHECK-NEXT: br i1 %cmp, label %loop, label %exit
+
+define void @f1(float addrspace(1)* %src, float addrspace(1)* %dst, i64 %n) {
+entry:
+  %cmp0 = icmp sgt i64 %n, 0
+  br i1 %cmp0, label %loop, label %exit
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %inc, %latch ]
+  %acc = phi float [ 0.000000e+00, %entry ], [ %acc.next, %latch ]
+  %c = fcmp ogt float %acc, 1.000000e+00
+  br i1 %c, label %then, label %latch
+
+then:
+  %p = getelementptr inbounds float, float addrspace(1)* %src, i64 %i
+  %v = load float, float addrspace(1)* %p, align 4
+  %add = fadd float %acc, %v
+  br label %latch
+
+latch:
+  %acc.next = phi float [ %acc, %loop ], [ %add, %then ]
+  %inc = add nuw nsw i64 %i, 1
+  %cmp = icmp slt i64 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r = phi float [ 0.000000e+00, %entry ], [ %acc.next, %latch ]
+  store float %r, float addrspace(1)* %dst, align 4
+  ret void
+}
+
+; The load is conditional within the loop and is not prefetched.
+
+; CHECK-LABEL: define void @f1
+; CHECK-NOT: load volatile
+; CHECK: ret void
+
+!igc.functions = !{!0, !3}
+
+!0 = !{void (float addrspace(1)*, float addrspace(1)*, i64)* @f0, !1}
+!3 = !{void (float addrspace(1)*, float addrspace(1)*, i64)* @f1, !1}
+
+!1 = !{!2}
+!2 = !{!"function_type", i32 0}
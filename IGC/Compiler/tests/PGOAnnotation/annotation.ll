@@ -0,0 +1,92 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-pgo-annotation -igc-pgo-feedback-file=%S/Inputs/feedback.txt | FileCheck %s
+
+; Block counts become !igc.pgo.count on the terminators and branch weights on
+; the branches. The fastest of the timed SIMD widths is recorded, but only
+; when at least two widths were timed. A kernel whose CFG checksum doesn't
+; match the profile is left alone.
+
+; CHECK-LABEL: define void @diamond(
+; CHECK:         br i1 %c, label %then, label %else, !prof [[PROF:![0-9]+]], !igc.pgo.count [[C100:![0-9]+]]
+; CHECK:       then:
+; CHECK:         br label %exit, !igc.pgo.count [[C30:![0-9]+]]
+; CHECK:       else:
+; CHECK:         br label %exit, !igc.pgo.count [[C70:![0-9]+]]
+; CHECK:       exit:
+; CHECK:         ret void, !igc.pgo.count [[C100]]
+
+; CHECK-LABEL: define void @single(
+; CHECK:         ret void, !igc.pgo.count [[C10:![0-9]+]]
+
+; CHECK-LABEL: define void @stale(
+; CHECK-NOT:     !igc.pgo.count
+; CHECK:         ret void{{$}}
+
+; CHECK-DAG:   attributes #{{[0-9]+}} = { "igc-pgo" "igc-pgo-simd"="16" }
+; CHECK-DAG:   attributes #{{[0-9]+}} = { "igc-pgo" }
+; CHECK-DAG:   [[PROF]] = !{!"branch_weights", i32 30, i32 70}
+; CHECK-DAG:   [[C100]] = !{i64 100}
+; CHECK-DAG:   [[C30]] = !{i64 30}
+; CHECK-DAG:   [[C70]] = !{i64 70}
+; CHECK-DAG:   [[C10]] = !{i64 10}
+; CHECK-NOT:   "igc-pgo-simd"="32"
+; CHECK-NOT:   "igc-pgo-simd"="8"
+
+define void @diamond(i32 addrspace(1)* %out, i1 %c) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  store i32 1, i32 addrspace(1)* %out, align 4
+  br label %exit
+
+else:
+  store i32 2, i32 addrspace(1)* %out, align 4
+  br label %exit
+
+exit:
+  ret void
+}
+
+define void @single(i32 addrspace(1)* %out) {
+entry:
+  store i32 3, i32 addrspace(1)* %out, align 4
+  ret void
+}
+
+define void @stale(i32 addrspace(1)* %out) {
+entry:
+  store i32 4, i32 addrspace(1)* %out, align 4
+  ret void
+}
+
+!igc.functions = !{!0, !3, !4}
+!0 = !{void (i32 addrspace(1)*, i1)* @diamond, !1}
+!1 = !{!2}
+!2 = !{!"function_type", i32 0}
+!3 = !{void (i32 addrspace(1)*)* @single, !1}
+!4 = !{void (i32 addrspace(1)*)* @stale, !1}
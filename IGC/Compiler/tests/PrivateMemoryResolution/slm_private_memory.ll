@@ -0,0 +1,72 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt -igc-private-mem-resolution -S %s -o - | FileCheck %s
+
+; The kernel was marked by PrivateMemoryUsageAnalysis, so its private array is
+; placed in SLM at 16 bytes per work-item of the 8x1x1 work-group.
+
+; CHECK-LABEL: define void @test(
+; CHECK-NOT:     alloca
+; CHECK:         [[X:%[A-Za-z0-9_.]+]] = zext i16 %localIdX to i32
+; CHECK:         [[Y:%[A-Za-z0-9_.]+]] = zext i16 %localIdY to i32
+; CHECK:         [[Z:%[A-Za-z0-9_.]+]] = zext i16 %localIdZ to i32
+; CHECK:         [[ZY:%[A-Za-z0-9_.]+]] = mul i32 [[Z]], 1
+; CHECK:         [[ZYY:%[A-Za-z0-9_.]+]] = add i32 [[ZY]], [[Y]]
+; CHECK:         [[ZYX:%[A-Za-z0-9_.]+]] = mul i32 [[ZYY]], 8
+; CHECK:         [[LID:%[A-Za-z0-9_.]+]] = add i32 [[ZYX]], [[X]]
+; CHECK:         [[OFF:%[A-Za-z0-9_.]+]] = mul i32 [[LID]], 16
+; CHECK:         [[BASE:%[A-Za-z0-9_.]+]] = add i32 [[OFF]], 0
+; CHECK:         [[ADDR:%[A-Za-z0-9_.]+]] = add i32 [[BASE]], 0
+; CHECK:         [[BUF:%[A-Za-z0-9_.]+]] = inttoptr i32 [[ADDR]] to [4 x i32] addrspace(3)*
+; CHECK:         [[PTR:%[A-Za-z0-9_.]+]] = getelementptr inbounds [4 x i32], [4 x i32] addrspace(3)* [[BUF]], i32 0, i32 %i
+; CHECK:         store i32 %i, i32 addrspace(3)* [[PTR]], align 4
+; CHECK:         load i32, i32 addrspace(3)*
+; CHECK-NOT:     alloca
+; CHECK:         ret void
+
+define void @test(i32 addrspace(1)* %out, i32 %i, i16 %localIdX, i16 %localIdY, i16 %localIdZ) #0 {
+entry:
+  %arr = alloca [4 x i32], align 4
+  %p = getelementptr inbounds [4 x i32], [4 x i32]* %arr, i32 0, i32 %i
+  store i32 %i, i32* %p, align 4
+  %q = getelementptr inbounds [4 x i32], [4 x i32]* %arr, i32 0, i32 0
+  %v = load i32, i32* %q, align 4
+  store i32 %v, i32 addrspace(1)* %out, align 4
+  ret void
+}
+
+attributes #0 = { "SLMPrivateMemory" }
+
+!igc.functions = !{!0}
+!0 = !{void (i32 addrspace(1)*, i32, i16, i16, i16)* @test, !1}
+!1 = !{!2, !3, !4, !8}
+!2 = !{!"function_type", i32 0}
+!3 = !{!"arg_desc"}
+!4 = !{!"implicit_arg_desc", !5, !6, !7}
+!5 = !{i32 7}
+!6 = !{i32 8}
+!7 = !{i32 9}
+!8 = !{!"thread_group_size", i32 8, i32 1, i32 1}
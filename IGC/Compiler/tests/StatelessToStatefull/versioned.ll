@@ -0,0 +1,94 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+
+; RUN: igc_opt %s -S -o - -igc-stateless-to-statefull-resolution -igc-s2s-loop-versioning | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-n8:16:32:64"
+
+; The index starts at an unknown %start, so the offsets cannot be proven positive.
+; The loop is versioned on a check of the first and the last offsets in the
+; preheader, and the accesses of the checked copy become statefull.
+
+define spir_kernel void @versioned(float addrspace(1)* %dst, float addrspace(1)* %src, i32 %start, i32 %n) {
+entry:
+  %cmp0 = icmp slt i32 %start, %n
+  br i1 %cmp0, label %for.body.preheader, label %exit
+
+for.body.preheader:
+  br label %for.body
+
+for.body:
+  %i = phi i32 [ %start, %for.body.preheader ], [ %inc, %for.body ]
+  %idx = sext i32 %i to i64
+  %src.ptr = getelementptr inbounds float, float addrspace(1)* %src, i64 %idx
+  %v = load float, float addrspace(1)* %src.ptr, align 4
+  %dst.ptr = getelementptr inbounds float, float addrspace(1)* %dst, i64 %idx
+  store float %v, float addrspace(1)* %dst.ptr, align 4
+  %inc = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %inc, %n
+  br i1 %cmp, label %for.body, label %for.end
+
+for.end:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: define spir_kernel void @versioned
+; CHECK: for.body.s2s.check:
+; CHECK: icmp ule i64 {{.*}}, 4294967292
+; CHECK: icmp ule i64 {{.*}}, 4294967292
+; CHECK: br i1 {{.*}}, label %for.body.ph, label %for.body.ph.stateless
+; CHECK: for.body.ph:
+; CHECK: for.body:
+; CHECK: load float, float addrspace({{[0-9][0-9]+}})*
+; CHECK: store float {{.*}}, float addrspace({{[0-9][0-9]+}})*
+; CHECK: br i1 %cmp, label %for.body, label %for.end
+
+!igc.functions = !{!0}
+!IGCMetadata = !{!4}
+
+!0 = !{void (float addrspace(1)*, float addrspace(1)*, i32, i32)* @versioned, !1}
+!1 = !{!2, !3}
+!2 = !{!"function_type", i32 0}
+!3 = !{!"implicit_arg_desc"}
+
+!4 = !{!"ModuleMD", !5}
+!5 = !{!"FuncMD", !6, !7}
+!6 = !{!"FuncMDMap[0]", void (float addrspace(1)*, float addrspace(1)*, i32, i32)* @versioned}
+!7 = !{!"FuncMDValue[0]", !8}
+!8 = !{!"resAllocMD", !9}
+!9 = !{!"argAllocMDList", !10, !14, !16, !16}
+!10 = !{!"argAllocMDListVec[0]", !11, !12, !13}
+!11 = !{!"type", i32 1}
+!12 = !{!"extensionType", i32 -1}
+!13 = !{!"indexType", i32 0}
+!14 = !{!"argAllocMDListVec[1]", !11, !12, !15}
+!15 = !{!"indexType", i32 1}
+!16 = !{!"argAllocMDListVec[2]", !17, !12, !18}
+!17 = !{!"type", i32 0}
+!18 = !{!"indexType", i32 -1}
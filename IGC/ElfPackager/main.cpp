@@ -93,7 +93,7 @@ void MakeHeader(StringRef Func, SmallVector<char, 0> &headerVector, int index)
     headerVector.push_back((char)(index >> 8));
 }
 
-void CreateElfSection(CLElfLib::CElfWriter* pWriter, CLElfLib::SSectionNode sectionNode, std::string Name, char* pData, unsigned DataSize)
+void CreateElfSection(CLElfLib::CElfWriter* pWriter, CLElfLib::SSectionNode sectionNode, std::string Name, char* pData, unsigned DataSize, bool byReference = false)
 {
     // Create section
     sectionNode.Name = Name;
@@ -103,7 +103,10 @@ void CreateElfSection(CLElfLib::CElfWriter* pWriter, CLElfLib::SSectionNode sect
     sectionNode.Type = SH_TYPE_PROG_BITS;
 
     // Add it to the file
-    pWriter->AddSection(&sectionNode);
+    if (byReference)
+        pWriter->AddSectionReference(&sectionNode);
+    else
+        pWriter->AddSection(&sectionNode);
 }
 
 
@@ -475,20 +478,21 @@ int main(int argc, char *argv[])
     }
 
     //Now to add all of the sections in the file
-    for (auto elf_iterator : ElfMap)
+    // ElfMap outlives ResolveBinary, so its sections are copied only once,
+    // straight into the final ELF blob.
+    for (auto& elf_iterator : ElfMap)
     {
         CreateElfSection(pWriter,
             sectionNode,
             elf_iterator.first,
             const_cast<char*>(elf_iterator.second.data()),
-            elf_iterator.second.size());
+            elf_iterator.second.size(),
+            true);
     }
 
     // Resolve size of ELF blob
-    size_t dataSize = 0;
-    char* ElfBlob = NULL;
-    pWriter->ResolveBinary(ElfBlob, dataSize);
-    ElfBlob = new char[dataSize];
+    size_t dataSize = pWriter->GetBinarySize();
+    char* ElfBlob = new char[dataSize];
     if (ElfBlob == NULL)
     {
         return -1;
@@ -960,14 +960,12 @@ namespace TC
         }
         if (pSectionHeader->Type == SH_TYPE_OPENCL_SOURCE)
         {
-            char *pData = NULL;
-            size_t uiDataSize = 0;
-            pElfReader->GetSectionData(1, pData, uiDataSize);
+            SElfSectionView section = pElfReader->GetSectionView(1);
 
-            if (pData != NULL)
+            if (section.pData != NULL)
             {
-                assert(pData[uiDataSize - 1] == '\0' && "Program source is not null terminated");
-                pClangArgs->pszProgramSource = (const char *)pData;
+                assert(section.pData[section.DataSize - 1] == '\0' && "Program source is not null terminated");
+                pClangArgs->pszProgramSource = section.pData;
             }
         }
 
@@ -978,14 +976,12 @@ namespace TC
 
             if ((pSectionHeader != NULL) && (pSectionHeader->Type == SH_TYPE_OPENCL_HEADER))
             {
-                char* pData = NULL;
-                size_t uiDataSize = 0;
-                pElfReader->GetSectionData(i, pData, uiDataSize);
+                SElfSectionView section = pElfReader->GetSectionView(i);
 
-                if (pData != NULL)
+                if (section.pData != NULL)
                 {
-                    assert(pData[uiDataSize - 1] == '\0' && "Header source is not null terminated");
-                    pClangArgs->inputHeaders.push_back(pData);
+                    assert(section.pData[section.DataSize - 1] == '\0' && "Header source is not null terminated");
+                    pClangArgs->inputHeaders.push_back(section.pData);
                     pClangArgs->inputHeadersNames.push_back(pElfReader->GetSectionName(i));
                 }
             }
@@ -1609,8 +1605,6 @@ namespace TC
             if ((pSectionHeader->Type == SH_TYPE_OPENCL_LLVM_ARCHIVE) ||
                 (pSectionHeader->Type == SH_TYPE_OPENCL_LLVM_BINARY))
             {
-                char *pData = NULL;
-                size_t dataSize = 0;
                 const unsigned char *pBufStart;
 
                 if (pOutputArgs->pOutput != NULL)
@@ -1620,8 +1614,9 @@ namespace TC
                     break;
                 }
 
-                pElfReader->GetSectionData(i, pData, dataSize);
-                pBufStart = (const unsigned char *)pData;
+                SElfSectionView section = pElfReader->GetSectionView(i);
+                size_t dataSize = section.DataSize;
+                pBufStart = (const unsigned char *)section.pData;
 
                 if (llvm::isBitcode(pBufStart, pBufStart + pHeader->ElfHeaderSize))
                 {
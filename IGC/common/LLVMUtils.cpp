@@ -96,8 +96,35 @@ void IGCPassManager::add(Pass *P)
         PassManager::add(createTimeStatsIGCPass(m_pContext, m_name + '_' + std::string(P->getPassName()), STATS_COUNTER_START));
     }
 
+    if (CompileTrace::isEnabled())
+    {
+        PassManager::add(createCompileTraceSpanPass(m_pContext, m_name + '_' + std::string(P->getPassName()), STATS_COUNTER_START));
+    }
+
+    std::shared_ptr<PassStatsSnapshot> passStats;
+    std::string passStatsName;
+    if (IGC_IS_FLAG_ENABLED(DumpCompilerStats))
+    {
+        // Index the stats by position so repeated passes do not collide.
+        char index[8];
+        snprintf(index, sizeof(index), "%03u", m_numStatsPasses++);
+        passStatsName = m_name + '_' + index + '_' + std::string(P->getPassName());
+        passStats = std::make_shared<PassStatsSnapshot>();
+        PassManager::add(createPassStatsCounterPass(m_pContext, passStatsName, passStats, STATS_COUNTER_START));
+    }
+
     PassManager::add(P);
 
+    if (passStats)
+    {
+        PassManager::add(createPassStatsCounterPass(m_pContext, passStatsName, passStats, STATS_COUNTER_END));
+    }
+
+    if (CompileTrace::isEnabled())
+    {
+        PassManager::add(createCompileTraceSpanPass(m_pContext, m_name + '_' + std::string(P->getPassName()), STATS_COUNTER_END));
+    }
+
     if (IGC::Debug::GetDebugFlag(IGC::Debug::DebugFlag::TIME_STATS_PER_PASS))
     {
         PassManager::add(createTimeStatsIGCPass(m_pContext, m_name + '_' + std::string(P->getPassName()), STATS_COUNTER_END));
@@ -140,7 +167,7 @@ void DumpLLVMIR(IGC::CodeGenContext* pContext, const char* dumpName)
     if (IGC_IS_FLAG_ENABLED(DumpLLVMIR))
     {
         pContext->getMetaDataUtils()->save(*pContext->getLLVMContext());
-        serialize(*(pContext->getModuleMetaData()), pContext->getModule());
+        serialize(*(pContext->getModuleMetaData()), pContext->getModule(), true);
         using namespace IGC::Debug;
         auto name =
             DumpName(IGC::Debug::GetShaderOutputName())
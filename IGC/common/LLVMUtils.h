@@ -57,6 +57,7 @@ namespace IGC
         CodeGenContext* m_pContext;
         std::string m_name;
         std::vector<Debug::Dump *> m_irDumps;
+        unsigned m_numStatsPasses = 0;
     };
 }
 
@@ -6,12 +6,149 @@
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Casting.h>
 #include <llvm/ADT/StringSwitch.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Optional.h>
 #include "common/LLVMWarningsPop.hpp"
 
+#include "common/igc_regkeys.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 
 using namespace llvm;
 
+// Binary encoding of ModuleMetaData.
+//
+// The whole structure is stored as a single MDString under the named metadata
+// "IGCMetadataBin". LLVM values referenced from the metadata (functions, global
+// variables) cannot live in the blob, so they are kept in a side tuple of
+// ValueAsMetadata and the blob refers to them by index; this way they still
+// follow RAUW and deletion exactly like the MDNode encoding does.
+//
+// Layout: header | ModuleMetaData fields in declaration order.
+// FuncMD entries are stored as (value index, payload size, payload) and the header
+// records where FuncMD starts, so deserializeFunctionMD() can seek to FuncMD and
+// skip over the entries of other functions without decoding them.
+namespace
+{
+    const char* const IGCMDNodeName = "IGCMetadata";
+    const char* const IGCMDBinaryName = "IGCMetadataBin";
+
+    const uint32_t IGCMDBinaryMagic = 0x444D4749; // 'IGMD'
+    const uint32_t IGCMDBinaryVersion = 2;
+
+    struct MDBinaryHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t schemaHash;
+        uint32_t funcMDOffset;
+    };
+}
+
+class MDBinaryWriter
+{
+public:
+    MDBinaryWriter()
+    {
+        m_buffer.reserve(4096);
+    }
+
+    void write(const void* data, size_t size)
+    {
+        m_buffer.append(static_cast<const char*>(data), size);
+    }
+
+    template<typename T>
+    void writePOD(T v)
+    {
+        write(&v, sizeof(T));
+    }
+
+    size_t tell() const { return m_buffer.size(); }
+
+    void patch(size_t offset, const void* data, size_t size)
+    {
+        assert(offset + size <= m_buffer.size());
+        memcpy(&m_buffer[offset], data, size);
+    }
+
+    // Returns the 1-based index of V in the value table, 0 stands for null.
+    uint32_t getValueIndex(Value* V)
+    {
+        if (V == nullptr)
+        {
+            return 0;
+        }
+        auto it = m_valueIndex.insert(std::make_pair(V, (uint32_t)m_values.size() + 1));
+        if (it.second)
+        {
+            m_values.push_back(ValueAsMetadata::get(V));
+        }
+        return it.first->second;
+    }
+
+    StringRef getBuffer() const { return m_buffer; }
+    ArrayRef<Metadata*> getValues() const { return m_values; }
+
+private:
+    std::string m_buffer;
+    std::vector<Metadata*> m_values;
+    DenseMap<Value*, uint32_t> m_valueIndex;
+};
+
+class MDBinaryReader
+{
+public:
+    MDBinaryReader(StringRef blob, const MDNode* values) :
+        m_blob(blob), m_values(values) {}
+
+    void read(void* data, size_t size)
+    {
+        if (m_offset + size > m_blob.size())
+        {
+            assert(0 && "truncated binary module metadata");
+            m_failed = true;
+            memset(data, 0, size);
+            m_offset = m_blob.size();
+            return;
+        }
+        memcpy(data, m_blob.data() + m_offset, size);
+        m_offset += size;
+    }
+
+    template<typename T>
+    T readPOD()
+    {
+        T v;
+        read(&v, sizeof(T));
+        return v;
+    }
+
+    size_t tell() const { return m_offset; }
+    void seek(size_t offset) { m_offset = std::min(offset, m_blob.size()); }
+    void skip(size_t size) { seek(m_offset + size); }
+    bool failed() const { return m_failed; }
+
+    Value* getValue(uint32_t index) const
+    {
+        if (index == 0 || !m_values || index > m_values->getNumOperands())
+        {
+            return nullptr;
+        }
+        auto* VAM = dyn_cast_or_null<ValueAsMetadata>(m_values->getOperand(index - 1).get());
+        return VAM ? VAM->getValue() : nullptr;
+    }
+
+private:
+    StringRef m_blob;
+    const MDNode* m_values;
+    size_t m_offset = 0;
+    bool m_failed = false;
+};
+
 //(non-autogen)function prototypes
 MDNode* CreateNode(unsigned char i, Module* module, StringRef name);
 MDNode* CreateNode(int i, Module* module, StringRef name);
@@ -51,6 +188,46 @@ void readNode(std::map<Key, Value> &funcMD, MDNode* node);
 template<typename T>
 void readNode(T &t, MDNode* node, StringRef name);
 
+void writeBin(unsigned char i, MDBinaryWriter& writer);
+void writeBin(int i, MDBinaryWriter& writer);
+void writeBin(unsigned i, MDBinaryWriter& writer);
+void writeBin(uint64_t i, MDBinaryWriter& writer);
+void writeBin(float f, MDBinaryWriter& writer);
+void writeBin(bool b, MDBinaryWriter& writer);
+void writeBin(const std::string &s, MDBinaryWriter& writer);
+void writeBin(Value* val, MDBinaryWriter& writer);
+void writeBin(Function* funcPtr, MDBinaryWriter& writer);
+void writeBin(GlobalVariable* globalVar, MDBinaryWriter& writer);
+template<typename T>
+void writeBin(const std::vector<T> &vec, MDBinaryWriter& writer);
+void writeBin(const std::vector<char> &vec, MDBinaryWriter& writer);
+void writeBin(const std::vector<unsigned char> &vec, MDBinaryWriter& writer);
+template<typename T, size_t s>
+void writeBin(const std::array<T, s> &arr, MDBinaryWriter& writer);
+template<typename Key, typename Value>
+void writeBin(const std::map<Key, Value> &keyMD, MDBinaryWriter& writer);
+void writeBin(const std::map<Function*, IGC::FunctionMetaData> &FuncMD, MDBinaryWriter& writer);
+
+void readBin(unsigned char &x, MDBinaryReader& reader);
+void readBin(int &x, MDBinaryReader& reader);
+void readBin(unsigned &x, MDBinaryReader& reader);
+void readBin(uint64_t &x, MDBinaryReader& reader);
+void readBin(float &x, MDBinaryReader& reader);
+void readBin(bool &b, MDBinaryReader& reader);
+void readBin(std::string &s, MDBinaryReader& reader);
+void readBin(Value* &val, MDBinaryReader& reader);
+void readBin(Function* &funcPtr, MDBinaryReader& reader);
+void readBin(GlobalVariable* &globalVar, MDBinaryReader& reader);
+template<typename T>
+void readBin(std::vector<T> &vec, MDBinaryReader& reader);
+void readBin(std::vector<char> &vec, MDBinaryReader& reader);
+void readBin(std::vector<unsigned char> &vec, MDBinaryReader& reader);
+template<typename T, size_t s>
+void readBin(std::array<T, s> &arr, MDBinaryReader& reader);
+template<typename Key, typename Value>
+void readBin(std::map<Key, Value> &keyMD, MDBinaryReader& reader);
+void readBin(std::map<Function*, IGC::FunctionMetaData> &FuncMD, MDBinaryReader& reader);
+
 //including auto-generated functions
 #include "MDNodeFunctions.gen"
 namespace IGC
@@ -325,26 +502,355 @@ void readNode(T &t, MDNode* node, StringRef name)
     }
 }
 
+void writeBin(unsigned char i, MDBinaryWriter& writer)
+{
+    writer.writePOD(i);
+}
+
+void writeBin(int i, MDBinaryWriter& writer)
+{
+    writer.writePOD(i);
+}
+
+void writeBin(unsigned i, MDBinaryWriter& writer)
+{
+    writer.writePOD(i);
+}
+
+void writeBin(uint64_t i, MDBinaryWriter& writer)
+{
+    writer.writePOD(i);
+}
+
+void writeBin(float f, MDBinaryWriter& writer)
+{
+    writer.writePOD(f);
+}
+
+void writeBin(bool b, MDBinaryWriter& writer)
+{
+    writer.writePOD<uint8_t>(b ? 1 : 0);
+}
+
+void writeBin(const std::string &s, MDBinaryWriter& writer)
+{
+    writer.writePOD<uint32_t>((uint32_t)s.size());
+    writer.write(s.data(), s.size());
+}
+
+void writeBin(Value* val, MDBinaryWriter& writer)
+{
+    writer.writePOD<uint32_t>(writer.getValueIndex(val));
+}
+
+void writeBin(Function* funcPtr, MDBinaryWriter& writer)
+{
+    writer.writePOD<uint32_t>(writer.getValueIndex(funcPtr));
+}
+
+void writeBin(GlobalVariable* globalVar, MDBinaryWriter& writer)
+{
+    writer.writePOD<uint32_t>(writer.getValueIndex(globalVar));
+}
+
+template<typename T>
+void writeBin(const std::vector<T> &vec, MDBinaryWriter& writer)
+{
+    writer.writePOD<uint32_t>((uint32_t)vec.size());
+    for (const auto &ele : vec)
+    {
+        writeBin(ele, writer);
+    }
+}
+
+// byte buffers (immediate constants, program scope buffers) are copied in bulk
+void writeBin(const std::vector<char> &vec, MDBinaryWriter& writer)
+{
+    writer.writePOD<uint32_t>((uint32_t)vec.size());
+    writer.write(vec.data(), vec.size());
+}
+
+void writeBin(const std::vector<unsigned char> &vec, MDBinaryWriter& writer)
+{
+    writer.writePOD<uint32_t>((uint32_t)vec.size());
+    writer.write(vec.data(), vec.size());
+}
+
+template<typename T, size_t s>
+void writeBin(const std::array<T, s> &arr, MDBinaryWriter& writer)
+{
+    for (const auto &ele : arr)
+    {
+        writeBin(ele, writer);
+    }
+}
+
+template<typename Key, typename Value>
+void writeBin(const std::map<Key, Value> &keyMD, MDBinaryWriter& writer)
+{
+    writer.writePOD<uint32_t>((uint32_t)keyMD.size());
+    for (const auto &it : keyMD)
+    {
+        writeBin(it.first, writer);
+        writeBin(it.second, writer);
+    }
+}
+
+void writeBin(const std::map<Function*, IGC::FunctionMetaData> &FuncMD, MDBinaryWriter& writer)
+{
+    // Remember where FuncMD starts so that deserializeFunctionMD() can jump
+    // straight to it, and prefix every entry with its size so it can be skipped.
+    uint32_t funcMDOffset = (uint32_t)writer.tell();
+    writer.patch(offsetof(MDBinaryHeader, funcMDOffset), &funcMDOffset, sizeof(funcMDOffset));
+
+    writer.writePOD<uint32_t>((uint32_t)FuncMD.size());
+    for (const auto &it : FuncMD)
+    {
+        writeBin(it.first, writer);
+        size_t sizeOffset = writer.tell();
+        writer.writePOD<uint32_t>(0);
+        writeBin(it.second, writer);
+        uint32_t size = (uint32_t)(writer.tell() - sizeOffset - sizeof(uint32_t));
+        writer.patch(sizeOffset, &size, sizeof(size));
+    }
+}
+
+void readBin(unsigned char &x, MDBinaryReader& reader)
+{
+    x = reader.readPOD<unsigned char>();
+}
+
+void readBin(int &x, MDBinaryReader& reader)
+{
+    x = reader.readPOD<int>();
+}
+
+void readBin(unsigned &x, MDBinaryReader& reader)
+{
+    x = reader.readPOD<unsigned>();
+}
+
+void readBin(uint64_t &x, MDBinaryReader& reader)
+{
+    x = reader.readPOD<uint64_t>();
+}
+
+void readBin(float &x, MDBinaryReader& reader)
+{
+    x = reader.readPOD<float>();
+}
+
+void readBin(bool &b, MDBinaryReader& reader)
+{
+    b = reader.readPOD<uint8_t>() != 0;
+}
+
+void readBin(std::string &s, MDBinaryReader& reader)
+{
+    uint32_t size = reader.readPOD<uint32_t>();
+    s.resize(size);
+    reader.read(&s[0], size);
+}
+
+void readBin(Value* &val, MDBinaryReader& reader)
+{
+    val = reader.getValue(reader.readPOD<uint32_t>());
+}
+
+void readBin(Function* &funcPtr, MDBinaryReader& reader)
+{
+    funcPtr = cast_or_null<Function>(reader.getValue(reader.readPOD<uint32_t>()));
+}
+
+void readBin(GlobalVariable* &globalVar, MDBinaryReader& reader)
+{
+    globalVar = cast_or_null<GlobalVariable>(reader.getValue(reader.readPOD<uint32_t>()));
+}
+
+template<typename T>
+void readBin(std::vector<T> &vec, MDBinaryReader& reader)
+{
+    uint32_t size = reader.readPOD<uint32_t>();
+    vec.resize(size);
+    for (uint32_t i = 0; i < size && !reader.failed(); i++)
+    {
+        readBin(vec[i], reader);
+    }
+}
+
+void readBin(std::vector<char> &vec, MDBinaryReader& reader)
+{
+    uint32_t size = reader.readPOD<uint32_t>();
+    vec.resize(size);
+    reader.read(vec.data(), size);
+}
+
+void readBin(std::vector<unsigned char> &vec, MDBinaryReader& reader)
+{
+    uint32_t size = reader.readPOD<uint32_t>();
+    vec.resize(size);
+    reader.read(vec.data(), size);
+}
+
+template<typename T, size_t s>
+void readBin(std::array<T, s> &arr, MDBinaryReader& reader)
+{
+    for (auto &ele : arr)
+    {
+        readBin(ele, reader);
+    }
+}
+
+template<typename Key, typename Value>
+void readBin(std::map<Key, Value> &keyMD, MDBinaryReader& reader)
+{
+    uint32_t size = reader.readPOD<uint32_t>();
+    for (uint32_t i = 0; i < size && !reader.failed(); i++)
+    {
+        std::pair<Key, Value> p;
+        readBin(p.first, reader);
+        readBin(p.second, reader);
+        keyMD.insert(std::move(p));
+    }
+}
+
+void readBin(std::map<Function*, IGC::FunctionMetaData> &FuncMD, MDBinaryReader& reader)
+{
+    uint32_t size = reader.readPOD<uint32_t>();
+    for (uint32_t i = 0; i < size && !reader.failed(); i++)
+    {
+        Function* F = nullptr;
+        readBin(F, reader);
+        uint32_t entrySize = reader.readPOD<uint32_t>();
+        if (F == nullptr)
+        {
+            // the function has been deleted since the metadata was written
+            reader.skip(entrySize);
+            continue;
+        }
+        readBin(FuncMD[F], reader);
+    }
+}
+
+// Returns a reader positioned right after the header, or nothing if the module
+// has no binary metadata or the blob was written with a different layout.
+static Optional<MDBinaryReader> getBinaryReader(const Module* module, uint32_t* funcMDOffset = nullptr)
+{
+    NamedMDNode* root = module->getNamedMetadata(IGCMDBinaryName);
+    if (!root || root->getNumOperands() == 0)
+    {
+        return None;
+    }
+    MDNode* node = root->getOperand(0);
+    auto* blob = node->getNumOperands() == 2 ? dyn_cast_or_null<MDString>(node->getOperand(0)) : nullptr;
+    auto* values = node->getNumOperands() == 2 ? dyn_cast_or_null<MDNode>(node->getOperand(1)) : nullptr;
+    if (!blob || !values)
+    {
+        return None;
+    }
+
+    MDBinaryReader reader(blob->getString(), values);
+    MDBinaryHeader header = reader.readPOD<MDBinaryHeader>();
+    if (reader.failed() ||
+        header.magic != IGCMDBinaryMagic ||
+        header.version != IGCMDBinaryVersion ||
+        header.schemaHash != IGCMDBinarySchemaHash)
+    {
+        return None;
+    }
+    if (funcMDOffset)
+    {
+        *funcMDOffset = header.funcMDOffset;
+    }
+    return reader;
+}
+
+static void eraseNamedMD(Module* module, StringRef name)
+{
+    if (NamedMDNode* node = module->getNamedMetadata(name))
+    {
+        node->eraseFromParent();
+    }
+}
+
 void IGC::deserialize(IGC::ModuleMetaData &deserializeMD, const Module* module)
 {
     IGC::ModuleMetaData temp;
     deserializeMD = temp;
-    NamedMDNode* root = module->getNamedMetadata("IGCMetadata");
+    if (auto reader = getBinaryReader(module))
+    {
+        readBin(deserializeMD, *reader);
+        if (!reader->failed())
+        {
+            return;
+        }
+        deserializeMD = IGC::ModuleMetaData();
+    }
+    NamedMDNode* root = module->getNamedMetadata(IGCMDNodeName);
     if (!root) { return; } //module has not been serialized with IGCMetadata yet
     MDNode* moduleRoot = root->getOperand(0);
     readNode(deserializeMD, moduleRoot);
 }
 
-void IGC::serialize(const IGC::ModuleMetaData &moduleMD, Module* module)
+bool IGC::deserializeFunctionMD(IGC::FunctionMetaData &funcMD, const Function* F, const Module* module)
 {
-    NamedMDNode* LLVMMetadata = module->getNamedMetadata("IGCMetadata");
-    if(LLVMMetadata)
+    funcMD = IGC::FunctionMetaData();
+    uint32_t funcMDOffset = 0;
+    if (auto reader = getBinaryReader(module, &funcMDOffset))
     {
-        // clear old metadata if present
-        LLVMMetadata->dropAllReferences();
+        reader->seek(funcMDOffset);
+        uint32_t size = reader->readPOD<uint32_t>();
+        for (uint32_t i = 0; i < size && !reader->failed(); i++)
+        {
+            Function* key = nullptr;
+            readBin(key, *reader);
+            uint32_t entrySize = reader->readPOD<uint32_t>();
+            if (key == F)
+            {
+                readBin(funcMD, *reader);
+                return !reader->failed();
+            }
+            reader->skip(entrySize);
+        }
+        return false;
     }
-    LLVMMetadata = module->getOrInsertNamedMetadata("IGCMetadata");
+
+    // MDNode encoding has no index, decode everything and pick the entry
+    IGC::ModuleMetaData moduleMD;
+    IGC::deserialize(moduleMD, module);
+    auto it = moduleMD.FuncMD.find(const_cast<Function*>(F));
+    if (it == moduleMD.FuncMD.end())
+    {
+        return false;
+    }
+    funcMD = std::move(it->second);
+    return true;
+}
+
+void IGC::serialize(const IGC::ModuleMetaData &moduleMD, Module* module, bool humanReadable)
+{
+    // only one encoding is kept in the module so a stale copy is never read back
+    eraseNamedMD(module, IGCMDBinaryName);
+    eraseNamedMD(module, IGCMDNodeName);
+
+    if (!humanReadable && IGC_IS_FLAG_ENABLED(EnableBinaryModuleMD))
+    {
+        MDBinaryWriter writer;
+        MDBinaryHeader header = { IGCMDBinaryMagic, IGCMDBinaryVersion, IGCMDBinarySchemaHash, 0 };
+        writer.writePOD(header);
+        writeBin(moduleMD, writer);
+
+        LLVMContext& ctx = module->getContext();
+        Metadata* v[] =
+        {
+            MDString::get(ctx, writer.getBuffer()),
+            MDNode::get(ctx, writer.getValues()),
+        };
+        module->getOrInsertNamedMetadata(IGCMDBinaryName)->addOperand(MDNode::get(ctx, v));
+        return;
+    }
+
+    NamedMDNode* LLVMMetadata = module->getOrInsertNamedMetadata(IGCMDNodeName);
     auto node = CreateNode(moduleMD, module, "ModuleMD");
     LLVMMetadata->addOperand(node);
 }
-
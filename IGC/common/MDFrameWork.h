@@ -366,7 +366,11 @@ namespace IGC
         unsigned int privateMemoryPerWI = 0;
         std::array<uint64_t, NUM_SHADER_RESOURCE_VIEW_SIZE> m_ShaderResourceViewMcsMask{};
     };
-    void serialize(const IGC::ModuleMetaData &moduleMD, llvm::Module* module);
+    // Stores moduleMD in the module, in the compact binary encoding unless
+    // EnableBinaryModuleMD is off or humanReadable is requested (IR dumps).
+    void serialize(const IGC::ModuleMetaData &moduleMD, llvm::Module* module, bool humanReadable = false);
     void deserialize(IGC::ModuleMetaData &deserializedMD, const llvm::Module* module);
+    // Decodes the metadata of a single function only; returns false if F has none.
+    bool deserializeFunctionMD(IGC::FunctionMetaData &funcMD, const llvm::Function* F, const llvm::Module* module);
 
 }
@@ -1397,6 +1397,9 @@ void CMemoryReport::MallocMemInstrumentation( size_t _Size )
     g_MemoryReport.m_Stat.HeapUsedPeak =
         iSTD::Max<DWORD>( g_MemoryReport.m_Stat.HeapUsedPeak,
                           g_MemoryReport.m_Stat.HeapUsed > 0 ? g_MemoryReport.m_Stat.HeapUsed : 0 );
+    g_MemoryReport.m_Stat.PassHeapUsedPeak =
+        iSTD::Max<DWORD>( g_MemoryReport.m_Stat.PassHeapUsedPeak,
+                          g_MemoryReport.m_Stat.HeapUsed > 0 ? g_MemoryReport.m_Stat.HeapUsed : 0 );
 
     g_MemoryReport.m_Stat.SnapHeapUsed += reinterpret_cast<int&>(_Size);
     g_MemoryReport.m_Stat.SnapHeapUsedPeak =
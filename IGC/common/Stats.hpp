@@ -40,6 +40,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/MemStats.h"
 
 #include "AdaptorCommon/customApi.hpp"
+#include "CompileTrace.h"
 
 #include <3d/common/iStdLib/utility.h>
 
@@ -310,6 +311,10 @@ private:
         { \
                 (pointer)->m_compilerTimeStats->recordTimerStart( compileTimeInterval );  \
         } \
+        if( CompileTrace::isEnabled() ) \
+        { \
+                CompileTrace::begin( "IGC", g_cCompTimeIntervals[ compileTimeInterval ] ); \
+        } \
     } while (0)
 #define COMPILER_TIME_END( pointer, compileTimeInterval ) \
     do \
@@ -318,6 +323,10 @@ private:
         { \
                 (pointer)->m_compilerTimeStats->recordTimerEnd( compileTimeInterval ); \
         } \
+        if( CompileTrace::isEnabled() ) \
+        { \
+                CompileTrace::end( g_cCompTimeIntervals[ compileTimeInterval ] ); \
+        } \
     } while (0)
 
 #define COMPILER_TIME_PASS_START( pointer, name ) \
@@ -449,6 +458,7 @@ public:
         unsigned int NumCurrAllocationsPeak;
         int          HeapUsed;
         unsigned int HeapUsedPeak;
+        unsigned int PassHeapUsedPeak;
 
         int          SnapHeapUsed;
         unsigned int SnapHeapUsedPeak;
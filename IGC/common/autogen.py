@@ -168,6 +168,39 @@ def printEnumReadCalls(enumName):
         output.write("        .Case(\""+ item + "\", IGC::"+ item + ")\n")
     output.write("        .Default((IGC::" + enumName + ")(0));\n")
 
+def printBinWriteCalls(structName):
+    for item in structDataMembers:
+        item = item[:-1]
+        output.write("    writeBin(" + structName + "Var" + "." + item + ", writer);\n")
+    recordSchema("struct", structName, [item[:-1] for item in structDataMembers])
+
+def printEnumBinWriteCalls(enumName):
+    output.write("    writer.writePOD<uint32_t>((uint32_t)" + enumName + "Var);\n")
+    recordSchema("enum", enumName, structDataMembers)
+
+def printBinReadCalls(structName):
+    for item in structDataMembers:
+        item = item[:-1]
+        output.write("    readBin(" + structName + "Var" + "." + item + ", reader);\n")
+
+def printEnumBinReadCalls(enumName):
+    output.write("    " + enumName + "Var = (IGC::" + enumName + ")reader.readPOD<uint32_t>();\n")
+
+# The binary encoding has no field names, so the member layout seen by the
+# generator is hashed and stored in every blob; a blob written by a compiler
+# with a different layout is rejected instead of being misread.
+schemaParts = []
+
+def recordSchema(kind, name, members):
+    schemaParts.append(kind + " " + name + "{" + ",".join(members) + "}")
+
+def schemaHash():
+    # FNV-1a, so the value is stable across python versions and runs
+    h = 0x811c9dc5
+    for c in ";".join(schemaParts):
+        h = ((h ^ ord(c)) * 0x01000193) & 0xffffffff
+    return h
+
 def emitCodeBlock(names, declType, fmtFn, extractFn, printFn):
     for item in names:
         foundStruct = False
@@ -227,10 +260,38 @@ def emitStructReadNode():
         return "void readNode( IGC::" + item + " &" + item + "Var," + " MDNode* node)\n"
     emitCodeBlock(structureNames, "struct", fmtFn, extractVars, printReadCalls)
 
+def emitEnumBinWrite():
+    def fmtFn(item):
+        return "void writeBin(IGC::" + item + " " + item + "Var" + ", MDBinaryWriter& writer)\n"
+    emitCodeBlock(enumNames, "enum", fmtFn, extractEnumVal, printEnumBinWriteCalls)
+
+def emitStructBinWrite():
+    def fmtFn(item):
+        return "void writeBin(const IGC::" + item + "& " + item + "Var" + ", MDBinaryWriter& writer)\n"
+    emitCodeBlock(structureNames, "struct", fmtFn, extractVars, printBinWriteCalls)
+
+def emitEnumBinRead():
+    def fmtFn(item):
+        return "void readBin(IGC::" + item + " &" + item + "Var" + ", MDBinaryReader& reader)\n"
+    emitCodeBlock(enumNames, "enum", fmtFn, extractEnumVal, printEnumBinReadCalls)
+
+def emitStructBinRead():
+    def fmtFn(item):
+        return "void readBin(IGC::" + item + " &" + item + "Var" + ", MDBinaryReader& reader)\n"
+    emitCodeBlock(structureNames, "struct", fmtFn, extractVars, printBinReadCalls)
+
+def emitSchemaHash():
+    output.write("static const uint32_t IGCMDBinarySchemaHash = " + hex(schemaHash()) + ";\n")
+
 def genCode():
     emitEnumCreateNode()
     emitStructCreateNode()
     emitEnumReadNode()
     emitStructReadNode()
+    emitEnumBinWrite()
+    emitStructBinWrite()
+    emitEnumBinRead()
+    emitStructBinRead()
+    emitSchemaHash()
 
 genCode()
@@ -34,6 +34,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "3d/common/iStdLib/File.h"
 #include "secure_mem.h"
 #include "secure_string.h"
+#include "CompileTrace.h"
 
 #if defined(_WIN64) || defined(_WIN32)
 #include <devguid.h>  // for GUID_DEVCLASS_DISPLAY
@@ -899,6 +900,13 @@ void LoadRegistryKeys(const std::string& options, bool *RegFlagNameError)
         }
 
 
+        if(IGC_IS_FLAG_ENABLED(CompileTraceFile))
+        {
+            CompileTrace::enable(
+                IGC_GET_REGKEYSTRING(CompileTraceFile),
+                (CompileTrace::Format)IGC_GET_FLAG_VALUE(CompileTraceFormat));
+        }
+
         switch(IGC_GET_FLAG_VALUE(ForceOCLSIMDWidth))
         {
         case 32:
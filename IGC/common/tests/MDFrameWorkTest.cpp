@@ -0,0 +1,207 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Round-trip test for the ModuleMetaData encodings: serializes a small module's
+// metadata in the binary and in the MDNode form, decodes it back with
+// IGC::deserialize and IGC::deserializeFunctionMD, and checks the fields.
+
+#include "common/MDFrameWork.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <stdio.h>
+#include <memory>
+
+using namespace llvm;
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond))                                                        \
+        {                                                                   \
+            fprintf(stderr, "%s:%d: check failed: %s\n",                    \
+                __FILE__, __LINE__, #cond);                                 \
+            g_failures++;                                                   \
+        }                                                                   \
+    } while (0)
+
+static Function* AddKernel(Module* M, const char* name)
+{
+    FunctionType* FTy = FunctionType::get(Type::getVoidTy(M->getContext()), false);
+    return Function::Create(FTy, GlobalValue::ExternalLinkage, name, M);
+}
+
+static void FillFunctionMD(IGC::FunctionMetaData& funcMD, GlobalVariable* GV, int seed)
+{
+    funcMD.functionType = IGC::KernelFunction;
+    funcMD.localOffsets.push_back({ 16 * seed, GV });
+    IGC::FuncArgMD argMD;
+    argMD.bufferLocationIndex = seed;
+    argMD.bufferLocationCount = 2;
+    funcMD.funcArgs.push_back(argMD);
+    IGC::ArgAllocMD argAlloc;
+    argAlloc.type = IGC::UAVResourceType;
+    argAlloc.indexType = seed;
+    funcMD.resAllocMD.argAllocMDList.push_back(argAlloc);
+    funcMD.maxByteOffsets.push_back(1024 + seed);
+    funcMD.CompiledSubGroupsNumber = seed;
+    funcMD.IsInitializer = (seed & 1) != 0;
+    funcMD.UserAnnotations.push_back("annotation" + std::to_string(seed));
+}
+
+static void CheckFunctionMD(const IGC::FunctionMetaData& funcMD, GlobalVariable* GV, int seed)
+{
+    CHECK(funcMD.functionType == IGC::KernelFunction);
+    CHECK(funcMD.localOffsets.size() == 1);
+    if (funcMD.localOffsets.size() == 1)
+    {
+        CHECK(funcMD.localOffsets[0].m_Offset == 16 * seed);
+        CHECK(funcMD.localOffsets[0].m_Var == GV);
+    }
+    CHECK(funcMD.funcArgs.size() == 1);
+    if (funcMD.funcArgs.size() == 1)
+    {
+        CHECK(funcMD.funcArgs[0].bufferLocationIndex == seed);
+        CHECK(funcMD.funcArgs[0].bufferLocationCount == 2);
+        CHECK(!funcMD.funcArgs[0].isEmulationArg);
+    }
+    CHECK(funcMD.resAllocMD.argAllocMDList.size() == 1);
+    if (funcMD.resAllocMD.argAllocMDList.size() == 1)
+    {
+        CHECK(funcMD.resAllocMD.argAllocMDList[0].type == IGC::UAVResourceType);
+        CHECK(funcMD.resAllocMD.argAllocMDList[0].indexType == seed);
+    }
+    CHECK(funcMD.maxByteOffsets.size() == 1 && funcMD.maxByteOffsets[0] == 1024u + seed);
+    CHECK(funcMD.CompiledSubGroupsNumber == (unsigned)seed);
+    CHECK(funcMD.IsInitializer == ((seed & 1) != 0));
+    CHECK(funcMD.UserAnnotations.size() == 1 &&
+        funcMD.UserAnnotations[0] == "annotation" + std::to_string(seed));
+}
+
+static void CheckModuleMD(const IGC::ModuleMetaData& MD, Function* F1, Function* F2, GlobalVariable* GV)
+{
+    CHECK(MD.compOpt.FastRelaxedMath);
+    CHECK(MD.compOpt.FloatRoundingMode == IGC::ROUND_TO_ZERO);
+    CHECK(MD.csInfo.forcedSIMDSize == 16);
+    CHECK(MD.privateMemoryPerWI == 256);
+    CHECK(MD.UseBindlessImage);
+    auto offsetIt = MD.inlineProgramScopeOffsets.find(GV);
+    CHECK(offsetIt != MD.inlineProgramScopeOffsets.end() && offsetIt->second == 64);
+    CHECK(MD.FuncMD.size() == 2);
+    auto it1 = MD.FuncMD.find(F1);
+    auto it2 = MD.FuncMD.find(F2);
+    CHECK(it1 != MD.FuncMD.end() && it2 != MD.FuncMD.end());
+    if (it1 != MD.FuncMD.end() && it2 != MD.FuncMD.end())
+    {
+        CheckFunctionMD(it1->second, GV, 1);
+        CheckFunctionMD(it2->second, GV, 2);
+    }
+}
+
+static void RoundTrip(bool humanReadable)
+{
+    LLVMContext context;
+    std::unique_ptr<Module> M(new Module("md_roundtrip", context));
+    Function* F1 = AddKernel(M.get(), "k1");
+    Function* F2 = AddKernel(M.get(), "k2");
+    Type* int32Ty = Type::getInt32Ty(context);
+    GlobalVariable* GV = new GlobalVariable(*M, int32Ty, false,
+        GlobalValue::InternalLinkage, ConstantInt::get(int32Ty, 0), "slm", nullptr,
+        GlobalValue::NotThreadLocal, 3);
+
+    IGC::ModuleMetaData MD;
+    MD.compOpt.FastRelaxedMath = true;
+    MD.compOpt.FloatRoundingMode = IGC::ROUND_TO_ZERO;
+    MD.csInfo.forcedSIMDSize = 16;
+    MD.privateMemoryPerWI = 256;
+    MD.UseBindlessImage = true;
+    MD.inlineProgramScopeOffsets[GV] = 64;
+    FillFunctionMD(MD.FuncMD[F1], GV, 1);
+    FillFunctionMD(MD.FuncMD[F2], GV, 2);
+
+    IGC::serialize(MD, M.get(), humanReadable);
+    CHECK((M->getNamedMetadata("IGCMetadataBin") != nullptr) == !humanReadable);
+    CHECK((M->getNamedMetadata("IGCMetadata") != nullptr) == humanReadable);
+
+    IGC::ModuleMetaData decoded;
+    IGC::deserialize(decoded, M.get());
+    CheckModuleMD(decoded, F1, F2, GV);
+
+    IGC::FunctionMetaData funcMD;
+    CHECK(IGC::deserializeFunctionMD(funcMD, F2, M.get()));
+    CheckFunctionMD(funcMD, GV, 2);
+    CHECK(IGC::deserializeFunctionMD(funcMD, F1, M.get()));
+    CheckFunctionMD(funcMD, GV, 1);
+
+    // Serializing again replaces the previous encoding.
+    IGC::serialize(decoded, M.get(), humanReadable);
+    IGC::ModuleMetaData decodedTwice;
+    IGC::deserialize(decodedTwice, M.get());
+    CheckModuleMD(decodedTwice, F1, F2, GV);
+
+    // A function without metadata is not found.
+    Function* F3 = AddKernel(M.get(), "k3");
+    CHECK(!IGC::deserializeFunctionMD(funcMD, F3, M.get()));
+
+    if (!humanReadable)
+    {
+        // The entry of a deleted function is skipped and the others still decode.
+        F1->eraseFromParent();
+        IGC::ModuleMetaData afterErase;
+        IGC::deserialize(afterErase, M.get());
+        CHECK(afterErase.FuncMD.size() == 1);
+        auto it = afterErase.FuncMD.find(F2);
+        CHECK(it != afterErase.FuncMD.end());
+        if (it != afterErase.FuncMD.end())
+        {
+            CheckFunctionMD(it->second, GV, 2);
+        }
+        CHECK(IGC::deserializeFunctionMD(funcMD, F2, M.get()));
+        CheckFunctionMD(funcMD, GV, 2);
+    }
+}
+
+int main()
+{
+    RoundTrip(false);
+    RoundTrip(true);
+
+    if (g_failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+}
@@ -36,6 +36,39 @@ int maxArenaLength = 0;
 int currentMallocSize = 0;
 #endif
 using namespace vISA;
+
+static _THREAD size_t arenaLiveBytes = 0;
+static _THREAD size_t arenaPeakBytes = 0;
+
+size_t ArenaStats::liveBytes()
+{
+    return arenaLiveBytes;
+}
+
+size_t ArenaStats::peakBytes()
+{
+    return arenaPeakBytes;
+}
+
+void ArenaStats::resetPeak()
+{
+    arenaPeakBytes = arenaLiveBytes;
+}
+
+void ArenaStats::onAlloc(size_t size)
+{
+    arenaLiveBytes += size;
+    if (arenaLiveBytes > arenaPeakBytes)
+    {
+        arenaPeakBytes = arenaLiveBytes;
+    }
+}
+
+void ArenaStats::onFree(size_t size)
+{
+    arenaLiveBytes = size > arenaLiveBytes ? 0 : arenaLiveBytes - size;
+}
+
 void*
 ArenaHeader::AllocSpace (size_t size)
 {
@@ -70,6 +103,7 @@ ArenaManager::FreeArenas()
 #ifdef COLLECT_ALLOCATION_STATS
         currentMallocSize -= _arenas->size;
 #endif
+        ArenaStats::onFree(ArenaHeader::GetArenaSize(_arenas->size));
         unsigned char* killed = (unsigned char*) _arenas;
         _arenas = _arenas->_nextArena;
         delete [] killed;
@@ -52,6 +52,20 @@ extern int currentMallocSize;
 namespace vISA
 {
     class Mem_Manager;
+
+    // Per-thread accounting of the bytes held by all arena managers. Used to
+    // report the memory high-water mark of individual optimization passes.
+    class ArenaStats
+    {
+    public:
+        static size_t liveBytes();
+        static size_t peakBytes();
+        // Restart peak tracking from the current live size.
+        static void resetPeak();
+        static void onAlloc(size_t size);
+        static void onFree(size_t size);
+    };
+
     class ArenaHeader
     {
         friend class ArenaManager;
@@ -169,6 +183,7 @@ namespace vISA
                 new unsigned char[ArenaHeader::GetArenaSize(arenaDataSize)];
 
             ArenaHeader* newArena = new (arena)ArenaHeader(arenaDataSize, _arenas);
+            ArenaStats::onAlloc(ArenaHeader::GetArenaSize(arenaDataSize));
             // Add new arena to the head of queue
             if (_arenas != NULL)
             {
@@ -36,10 +36,10 @@ class CisaBinary;
 class VISAKernelImpl;
 class VISAFunction;
 
-extern FILE *CISAin;
-extern FILE *CISAout;
 extern int CISAdebug;
 
+#include <unordered_set>
+
 #include "VISABuilderAPIDefinition.h"
 #include "visa_wa.h"
 
@@ -69,25 +69,6 @@ public:
 
     virtual ~CISA_IR_Builder();
 
-    #ifndef DLL_MODE
-    //
-    // routines for initializing and ending CISA parser
-    //
-    // to make the tool quit when there is incorrect input file
-    bool openCISAParsingFile(const char* fileName, char* mode)
-    {
-        if( (CISAin = fopen(fileName, mode)) == NULL)
-        {
-            fprintf(stderr,"Cannot open file %s\n", fileName);
-            return false;
-        }
-        return true;
-    }
-
-    void closeCISAParsingFile() { fclose(CISAin); }
-
-    #endif
-
     /**************START VISA BUILDER API*****************************/
 
     static int CreateBuilder(CISA_IR_Builder *&builder,
@@ -110,6 +91,7 @@ public:
     // Used for inline asm code generation
     VISA_BUILDER_API virtual int ParseVISAText(const std::string& visaHeader, const std::string& visaText, const std::string& visaTextFile);
     VISA_BUILDER_API virtual int ParseVISAText(const std::string& visaFile);
+    VISA_BUILDER_API virtual int ParseVISAInlineAsm(VISAKernel* kernel, const std::string& asmText);
     VISA_BUILDER_API virtual int WriteVISAHeader();
     VISA_BUILDER_API std::stringstream& GetAsmTextStream() { return m_ssIsaAsm; }
     VISA_BUILDER_API std::stringstream& GetAsmTextHeaderStream() { return m_ssIsaAsmHeader; }
@@ -727,6 +709,11 @@ public:
     void setGtpinInit(void* buf) { gtpin_init = buf; }
     void* getGtpinInit() { return gtpin_init; }
 
+    // Returns a null-terminated copy of str[0, len) owned by this builder.
+    // Equal strings share one copy, so the text parser neither allocates nor
+    // leaks a string per token.
+    char* internString(const char* str, size_t len);
+
 
 private:
 
@@ -751,6 +738,32 @@ private:
     PVISA_WA_TABLE m_pWaTable;
 
     void* gtpin_init = nullptr;
+
+    struct InternedString
+    {
+        const char* str;
+        size_t len;
+
+        bool operator==(const InternedString& other) const
+        {
+            return len == other.len && memcmp(str, other.str, len) == 0;
+        }
+    };
+    struct InternedStringHash
+    {
+        size_t operator()(const InternedString& s) const
+        {
+            // FNV-1a
+            size_t hash = 2166136261u;
+            for (size_t i = 0; i < s.len; i++)
+            {
+                hash = (hash ^ (unsigned char)s.str[i]) * 16777619u;
+            }
+            return hash;
+        }
+    };
+    // Strings handed out by internString(), allocated in m_mem.
+    std::unordered_set<InternedString, InternedStringHash> m_internedStrings;
 };
 extern _THREAD CISA_IR_Builder * pCisaBuilder;
 
@@ -43,6 +43,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "BuildCISAIR.h"
 #include "BinaryCISAEmission.h"
 #include "Timer.h"
+#include "CompileTrace.h"
 #include "BinaryEncoding.h"
 #include "IsaDisassembly.h"
 
@@ -301,6 +302,12 @@ int CISA_IR_Builder::CreateBuilder(
         return VISA_FAILURE;
     }
 
+    if (const char* traceFile = builder->m_options.getOptionCstr(vISA_CompileTraceFile))
+    {
+        CompileTrace::enable(traceFile,
+            builder->m_options.getOption(vISA_CompileTraceBinary) ? CompileTrace::FORMAT_BINARY : CompileTrace::FORMAT_CHROME_JSON);
+    }
+
     auto targetMode = (mode == vISA_3D || mode == vISA_ASM_WRITER || mode == vISA_ASM_READER) ? VISA_3D : VISA_CM;
     builder->m_options.setTarget(targetMode);
     builder->m_options.setOptionInternally(vISA_isParseMode, (mode == vISA_PARSER || mode == vISA_ASM_READER));
@@ -353,6 +360,8 @@ int CISA_IR_Builder::DestroyBuilder(CISA_IR_Builder *builder)
 
     delete builder;
 
+    CompileTrace::flush();
+
     return VISA_SUCCESS;
 }
 
@@ -677,21 +686,82 @@ int CISA_IR_Builder::WriteVISAHeader()
     return VISA_FAILURE;
 }
 
+char* CISA_IR_Builder::internString(const char* str, size_t len)
+{
+    auto it = m_internedStrings.find(InternedString{ str, len });
+    if (it != m_internedStrings.end())
+    {
+        return const_cast<char*>(it->str);
+    }
+
+    char* copy = (char*)m_mem.alloc(len + 1);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    m_internedStrings.insert(InternedString{ copy, len });
+    return copy;
+}
+
+typedef void * yyscan_t;
 typedef struct yy_buffer_state * YY_BUFFER_STATE;
-extern int CISAparse();
-extern YY_BUFFER_STATE CISA_scan_string(const char* yy_str);
-extern void CISA_delete_buffer(YY_BUFFER_STATE buf);
+extern int CISAparse(yyscan_t scanner);
+extern int CISAlex_init(yyscan_t* scanner);
+extern int CISAlex_destroy(yyscan_t scanner);
+extern void CISAset_in(FILE* in, yyscan_t scanner);
+extern void CISAset_out(FILE* out, yyscan_t scanner);
+extern YY_BUFFER_STATE CISA_scan_string(const char* yy_str, yyscan_t scanner);
+extern void CISA_delete_buffer(YY_BUFFER_STATE buf, yyscan_t scanner);
 
-int CISA_IR_Builder::ParseVISAText(const std::string& visaHeader, const std::string& visaText, const std::string& visaTextFile)
+// Runs the text parser over `text`, or over `in` if `text` is NULL, building
+// into the current kernel of `builder`. All scanner and parser state lives in
+// a handle local to this call, so builders on different threads may parse
+// concurrently. Returns the CISAparse() status.
+static int parseVISAText(CISA_IR_Builder* builder, const char* text, FILE* in)
 {
-#if defined(__linux__) || defined(_WIN64) || defined(_WIN32)
+    yyscan_t scanner;
+    if (CISAlex_init(&scanner) != 0)
+    {
+        return 1;
+    }
+
     // Direct output of parser to null
 #if defined(_WIN64) || defined(_WIN32)
-    CISAout = fopen("nul", "w");
+    FILE* out = fopen("nul", "w");
 #else
-    CISAout = fopen("/dev/null", "w");
+    FILE* out = fopen("/dev/null", "w");
 #endif
+    if (out)
+    {
+        CISAset_out(out, scanner);
+    }
+
+    YY_BUFFER_STATE buf = NULL;
+    if (text)
+    {
+        buf = CISA_scan_string(text, scanner);
+    }
+    else
+    {
+        CISAset_in(in, scanner);
+    }
+
+    pCisaBuilder = builder;
+    int status = CISAparse(scanner);
+
+    if (buf)
+    {
+        CISA_delete_buffer(buf, scanner);
+    }
+    CISAlex_destroy(scanner);
+    if (out)
+    {
+        fclose(out);
+    }
+    return status;
+}
 
+int CISA_IR_Builder::ParseVISAText(const std::string& visaHeader, const std::string& visaText, const std::string& visaTextFile)
+{
+#if defined(__linux__) || defined(_WIN64) || defined(_WIN32)
     // Dump the visa text
     if (m_options.getOption(vISA_GenerateISAASM) && !visaTextFile.empty())
     {
@@ -719,30 +789,21 @@ int CISA_IR_Builder::ParseVISAText(const std::string& visaHeader, const std::str
     // Parse the header string
     if (!visaHeader.empty())
     {
-        YY_BUFFER_STATE headerBuf = CISA_scan_string(visaHeader.c_str());
-        if (CISAparse() != 0)
+        if (parseVISAText(this, visaHeader.c_str(), NULL) != 0)
         {
             assert(0 && "Parsing header message failed");
             return VISA_FAILURE;
         }
-        CISA_delete_buffer(headerBuf);
     }
 
     // Parse the visa body
     if (!visaText.empty())
     {
-        YY_BUFFER_STATE visaBuf = CISA_scan_string(visaText.c_str());
-        if (CISAparse() != 0)
+        if (parseVISAText(this, visaText.c_str(), NULL) != 0)
         {
             assert(0 && "Parsing visa text failed");
             return VISA_FAILURE;
         }
-        CISA_delete_buffer(visaBuf);
-    }
-
-    if (CISAout)
-    {
-        fclose(CISAout);
     }
 
     return VISA_SUCCESS;
@@ -756,31 +817,67 @@ int CISA_IR_Builder::ParseVISAText(const std::string& visaHeader, const std::str
 int CISA_IR_Builder::ParseVISAText(const std::string& visaFile)
 {
 #if defined(__linux__) || defined(_WIN64) || defined(_WIN32)
-    // Direct output of parser to null
-#if defined(_WIN64) || defined(_WIN32)
-    CISAout = fopen("nul", "w");
-#else
-    CISAout = fopen("/dev/null", "w");
-#endif
-    CISAin = fopen(visaFile.c_str(), "r");
-    if (!CISAin)
+    FILE* visaIn = fopen(visaFile.c_str(), "r");
+    if (!visaIn)
     {
         assert(0 && "Failed to open file");
         return VISA_FAILURE;
     }
 
-    if (CISAparse() != 0)
+    int status = parseVISAText(this, NULL, visaIn);
+    fclose(visaIn);
+    if (status != 0)
     {
         assert(0 && "Parsing visa text failed");
         return VISA_FAILURE;
     }
-    fclose(CISAin);
+    return VISA_SUCCESS;
+#else
+    assert(0 && "Asm parsing not supported on this platform");
+    return VISA_FAILURE;
+#endif
+}
 
-    if (CISAout)
+// Parses an inline asm fragment (declarations and instructions, no kernel
+// header) directly into `kernel`, which may be a kernel or a function of this
+// builder. Operands may name the variables created through the builder API by
+// the names VISAKernel::getVarName() prints for them. This avoids printing the
+// whole kernel to text and parsing it back in a separate builder.
+int CISA_IR_Builder::ParseVISAInlineAsm(VISAKernel* kernel, const std::string& asmText)
+{
+#if defined(__linux__) || defined(_WIN64) || defined(_WIN32)
+    if (asmText.empty())
     {
-        fclose(CISAout);
+        return VISA_SUCCESS;
     }
-    return VISA_SUCCESS;
+
+    // The grammar actions build into the current kernel of the current builder.
+    VISAKernelImpl* savedKernel = m_kernel;
+    bool savedParseMode = m_options.getOption(vISA_isParseMode);
+    m_kernel = static_cast<VISAKernelImpl*>(kernel);
+    // Variables declared by the fragment need to be named.
+    m_options.setOptionInternally(vISA_isParseMode, true);
+    m_kernel->beginInlineAsm();
+
+    // Every statement ends with a newline and the scanner emits none at the
+    // end of the input, so terminate the last line of the fragment.
+    std::string text = asmText;
+    if (text.back() != '\n')
+    {
+        text += '\n';
+    }
+
+    int status = VISA_SUCCESS;
+    if (parseVISAText(this, text.c_str(), NULL) != 0)
+    {
+        assert(0 && "Parsing inline asm failed");
+        status = VISA_FAILURE;
+    }
+
+    m_kernel->endInlineAsm();
+    m_options.setOptionInternally(vISA_isParseMode, savedParseMode);
+    m_kernel = savedKernel;
+    return status;
 #else
     assert(0 && "Asm parsing not supported on this platform");
     return VISA_FAILURE;
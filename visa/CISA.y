@@ -40,9 +40,15 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
 //VISA_Type variable_declaration_and_type_check(char *var, Common_ISA_Var_Class type);
-void yyerror(char const* msg);
-int  yylex();
-extern int CISAlineno;
+void yyerror(void* scanner, char const* msg);
+
+// The parser is pure and the scanner reentrant: all lexer state lives in the
+// scanner handle passed to CISAparse(), so separate builders may parse on
+// separate threads.
+int   CISAget_lineno(void* yyscanner);
+FILE* CISAget_out(void* yyscanner);
+char* CISAget_text(void* yyscanner);
+#define CISAlineno CISAget_lineno(scanner)
 
 /*
  * check if the cond is true.
@@ -51,17 +57,18 @@ extern int CISAlineno;
 #define MUST_HOLD(cond, errorMessage) \
   {if (!(cond)) {printf("Line %d: ", CISAlineno); printf("ERROR Message : %s\n", errorMessage); YYABORT;}}
 #ifdef _DEBUG
-#define TRACE(str) fprintf(CISAout, str)
+#define TRACE(str) fprintf(CISAget_out(scanner), str)
 #else
 #define TRACE(str)
 #endif
 
-char * switch_label_array[32];
-std::vector<VISA_opnd*> RTWriteOperands;
-VISA_opnd *opndRTWriteArray[32];
-int num_parameters;
+// Scratch state shared between grammar actions of one parse.
+static thread_local char * switch_label_array[32];
+static thread_local std::vector<VISA_opnd*> RTWriteOperands;
+static thread_local VISA_opnd *opndRTWriteArray[32];
+static thread_local int num_parameters;
 
-VISA_RawOpnd* rawOperandArray[16];
+static thread_local VISA_RawOpnd* rawOperandArray[16];
 
 #ifndef PRId64
 # ifdef _WIN32
@@ -82,16 +89,15 @@ VISA_RawOpnd* rawOperandArray[16];
 %}
 
 %error-verbose
+%define api.pure
+%parse-param {void* scanner}
+%lex-param   {void* scanner}
 
 %union
 {
     int64_t                number;
     double                 fp;
 
-    struct strlitbuf_struct {
-        char      decoded[4096];
-        size_t    len;
-    } strlit;
     char *                 string;
     char *                 asm_name;
     char *                 var_name;
@@ -254,6 +260,10 @@ VISA_RawOpnd* rawOperandArray[16];
     bool                   flag;
 }
 
+%{
+int yylex(YYSTYPE* lvalp, void* scanner);
+%}
+
 %start CISAStmt
 
 %token DIRECTIVE_KERNEL     /* .kernel */
@@ -1769,7 +1779,7 @@ AddrVar :  VAR
               TRACE("\n** Address operand");
               $$.cisa_decl = pCisaBuilder->CISA_find_decl($1);
               if (!$$.cisa_decl)
-                  yyerror("unbound variable");
+                  yyerror(scanner, "unbound variable");
               $$.row = 0;
               $$.elem = 0;
           }
@@ -1779,7 +1789,7 @@ AddrVar :  VAR
 
               $$.cisa_decl = pCisaBuilder->CISA_find_decl($1);
               if (!$$.cisa_decl)
-                  yyerror("unbound variable");
+                  yyerror(scanner, "unbound variable");
               $$.row = 1;
               $$.elem = (int)$3;
           }
@@ -1790,7 +1800,7 @@ AddrVar :  VAR
 
               $$.cisa_decl = pCisaBuilder->CISA_find_decl($1);
               if (!$$.cisa_decl)
-                  yyerror("unbound variable");
+                  yyerror(scanner, "unbound variable");
               $$.row = (int)$6;
               $$.elem = (int)$3;
           }
@@ -1799,7 +1809,7 @@ AddrVar :  VAR
               TRACE("\n** Address operand");
               $$.cisa_decl = pCisaBuilder->CISA_find_decl($1);
               if (!$$.cisa_decl)
-                  yyerror("unbound variable");
+                  yyerror(scanner, "unbound variable");
               $$.row = (int)$3;
               $$.elem = (int)$5;
           };
@@ -1809,7 +1819,7 @@ AddressableVar : VAR {
               //$$.opnd = pBuilder->getRegVar($1);
               $$.cisa_decl = pCisaBuilder->CISA_find_decl($1);
               if (!$$.cisa_decl)
-                  yyerror("unbound variable");
+                  yyerror(scanner, "unbound variable");
               $$.row = 0;
               $$.elem = 0;
           };
@@ -1896,7 +1906,7 @@ Exp : AbstractNum   { $$ = $1; }
     | Exp TIMES Exp { $$ = $1 * $3; }
     | Exp SLASH Exp {
             if ($3 == 0)
-                yyerror("division by 0");
+                yyerror(scanner, "division by 0");
             $$ = $1 / $3;
         }
     | MINUS Exp %prec NEG  { $$ = -$2; }
@@ -2038,17 +2048,8 @@ VISA_Type variable_declaration_and_type_check(char *var, Common_ISA_Var_Class ty
 }
 */
 
-void yyerror(char const *s)
+void yyerror(void* scanner, char const *s)
 {
-
-    int yytype = YYTRANSLATE (yychar);
-    if (strcmp(yytname[yytype], "NUMBER") == 0)
-        fprintf (stderr, "\nLine %d: %s, number: %" PRId64 "\n", CISAlineno,  s, yylval.number);
-     else if (strcmp(yytname[yytype], "VAR") == 0)
-        fprintf (stderr, "\nLine %d: %s, symbol: %s\n", CISAlineno,  s, yylval.string);
-     else
-        fprintf (stderr, "\nLine %d: %s\n", CISAlineno,  s);
-
-    return;
+    // The offending token is the last one the scanner matched.
+    fprintf(stderr, "\nLine %d: %s, near: %s\n", CISAlineno, s, CISAget_text(scanner));
 }
-
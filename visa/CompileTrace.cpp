@@ -0,0 +1,389 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "CompileTrace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define TRACE_GETPID _getpid
+#else
+#include <unistd.h>
+#define TRACE_GETPID getpid
+#endif
+
+namespace CompileTrace
+{
+std::atomic<bool> g_traceEnabled(false);
+}
+
+using namespace CompileTrace;
+
+namespace
+{
+typedef std::chrono::steady_clock TraceClock;
+
+// Flush a thread's buffer once it holds this many completed spans so a long
+// running compile does not grow without bound.
+const size_t MaxBufferedEvents = 64 * 1024;
+
+const char BinaryMagic[8] = { 'I', 'G', 'C', 'T', 'R', 'A', 'C', 'E' };
+const uint32_t BinaryVersion = 1;
+
+enum BinaryRecordKind : uint8_t
+{
+    RECORD_STRING = 1,
+    RECORD_SPAN   = 2,
+};
+
+struct Event
+{
+    const char* category;
+    const char* name;
+    const char* kernel;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint32_t depth;
+    uint16_t simd;
+    uint16_t retry;
+};
+
+struct OpenSpan
+{
+    const char* category;
+    const char* name;
+    uint64_t startNs;
+};
+
+// Process wide output; only touched under its mutex.
+struct TraceOutput
+{
+    std::mutex lock;
+    FILE* file = nullptr;
+    Format format = FORMAT_CHROME_JSON;
+    TraceClock::time_point origin;
+    unsigned pid = 0;
+    std::atomic<unsigned> nextTid{ 1 };
+    // binary format: strings already written out, by content
+    std::unordered_map<std::string, uint32_t> stringIds;
+
+    ~TraceOutput()
+    {
+        if (file)
+        {
+            fclose(file);
+        }
+    }
+};
+
+TraceOutput& output()
+{
+    static TraceOutput out;
+    return out;
+}
+
+struct ThreadTrace
+{
+    unsigned tid;
+    const char* kernel = "";
+    unsigned simd = 0;
+    unsigned retry = 0;
+    std::vector<OpenSpan> stack;
+    std::vector<Event> events;
+    // names are copied once per thread; node based so pointers stay valid
+    std::unordered_set<std::string> strings;
+
+    ThreadTrace() : tid(output().nextTid++) {}
+
+    ~ThreadTrace()
+    {
+        writeEvents();
+    }
+
+    const char* intern(const char* s)
+    {
+        return strings.insert(s ? s : "").first->c_str();
+    }
+
+    void writeEvents();
+};
+
+thread_local ThreadTrace t_trace;
+
+uint64_t nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        TraceClock::now() - output().origin).count();
+}
+
+void writeJSONString(FILE* f, const char* s)
+{
+    fputc('"', f);
+    for (; *s; ++s)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+        {
+            fputc('\\', f);
+            fputc(c, f);
+        }
+        else if (c < 0x20)
+        {
+            fprintf(f, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+uint32_t binaryStringId(TraceOutput& out, const char* s)
+{
+    auto it = out.stringIds.find(s);
+    if (it != out.stringIds.end())
+    {
+        return it->second;
+    }
+    uint32_t id = (uint32_t)out.stringIds.size();
+    out.stringIds.emplace(s, id);
+
+    uint8_t kind = RECORD_STRING;
+    uint32_t len = (uint32_t)strlen(s);
+    fwrite(&kind, sizeof(kind), 1, out.file);
+    fwrite(&id, sizeof(id), 1, out.file);
+    fwrite(&len, sizeof(len), 1, out.file);
+    fwrite(s, 1, len, out.file);
+    return id;
+}
+
+void ThreadTrace::writeEvents()
+{
+    if (events.empty())
+    {
+        return;
+    }
+
+    TraceOutput& out = output();
+    std::lock_guard<std::mutex> guard(out.lock);
+    if (!out.file)
+    {
+        events.clear();
+        return;
+    }
+
+    for (const Event& E : events)
+    {
+        if (out.format == FORMAT_BINARY)
+        {
+            // ids first: writing them may emit string records
+            uint32_t ids[3] =
+            {
+                binaryStringId(out, E.category),
+                binaryStringId(out, E.name),
+                binaryStringId(out, E.kernel),
+            };
+            uint8_t kind = RECORD_SPAN;
+            fwrite(&kind, sizeof(kind), 1, out.file);
+            fwrite(&tid, sizeof(uint32_t), 1, out.file);
+            fwrite(&E.depth, sizeof(E.depth), 1, out.file);
+            fwrite(&E.startNs, sizeof(E.startNs), 1, out.file);
+            fwrite(&E.durationNs, sizeof(E.durationNs), 1, out.file);
+            fwrite(ids, sizeof(ids), 1, out.file);
+            fwrite(&E.simd, sizeof(E.simd), 1, out.file);
+            fwrite(&E.retry, sizeof(E.retry), 1, out.file);
+        }
+        else
+        {
+            // JSON array format: the closing ']' is optional, which lets us
+            // append from any thread without rewriting the file.
+            fputs("{\"name\":", out.file);
+            writeJSONString(out.file, E.name);
+            fputs(",\"cat\":", out.file);
+            writeJSONString(out.file, E.category);
+            fprintf(out.file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u,\"args\":{\"kernel\":",
+                E.startNs / 1000.0, E.durationNs / 1000.0, out.pid, tid);
+            writeJSONString(out.file, E.kernel);
+            fprintf(out.file, ",\"simd\":%u,\"retry\":%u,\"depth\":%u}},\n",
+                (unsigned)E.simd, (unsigned)E.retry, E.depth);
+        }
+    }
+    fflush(out.file);
+    events.clear();
+}
+} // namespace
+
+void CompileTrace::enable(const char* path, Format format)
+{
+    if (!path || !*path)
+    {
+        return;
+    }
+
+    TraceOutput& out = output();
+    std::lock_guard<std::mutex> guard(out.lock);
+    if (out.file)
+    {
+        // already tracing, e.g. both IGC and vISA asked for it
+        return;
+    }
+    out.file = fopen(path, "wb");
+    if (!out.file)
+    {
+        fprintf(stderr, "CompileTrace: cannot open %s\n", path);
+        return;
+    }
+    out.format = format;
+    out.origin = TraceClock::now();
+    out.pid = (unsigned)TRACE_GETPID();
+    if (format == FORMAT_BINARY)
+    {
+        fwrite(BinaryMagic, sizeof(BinaryMagic), 1, out.file);
+        fwrite(&BinaryVersion, sizeof(BinaryVersion), 1, out.file);
+    }
+    else
+    {
+        fputs("[\n", out.file);
+    }
+    g_traceEnabled.store(true, std::memory_order_release);
+}
+
+void CompileTrace::setKernel(const char* name)
+{
+    if (isEnabled())
+    {
+        t_trace.kernel = t_trace.intern(name);
+    }
+}
+
+void CompileTrace::setSimd(unsigned simdSize)
+{
+    if (isEnabled())
+    {
+        t_trace.simd = simdSize;
+    }
+}
+
+void CompileTrace::setRetry(unsigned retryId)
+{
+    if (isEnabled())
+    {
+        t_trace.retry = retryId;
+    }
+}
+
+void CompileTrace::begin(const char* category, const char* name)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    ThreadTrace& T = t_trace;
+    OpenSpan S = { T.intern(category), T.intern(name), nowNs() };
+    T.stack.push_back(S);
+}
+
+void CompileTrace::end(const char* name)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    uint64_t endNs = nowNs();
+    ThreadTrace& T = t_trace;
+
+    // Normally the innermost span; search outwards so that an interval that
+    // is not strictly nested (some timers overlap) still gets its own time.
+    for (size_t i = T.stack.size(); i-- > 0;)
+    {
+        const OpenSpan& S = T.stack[i];
+        if (strcmp(S.name, name) != 0)
+        {
+            continue;
+        }
+        Event E;
+        E.category = S.category;
+        E.name = S.name;
+        E.kernel = T.kernel;
+        E.startNs = S.startNs;
+        E.durationNs = endNs - S.startNs;
+        E.depth = (uint32_t)i;
+        E.simd = (uint16_t)T.simd;
+        E.retry = (uint16_t)T.retry;
+        T.events.push_back(E);
+        T.stack.erase(T.stack.begin() + i);
+        break;
+    }
+
+    if (T.stack.empty() && T.events.size() >= MaxBufferedEvents)
+    {
+        T.writeEvents();
+    }
+}
+
+void CompileTrace::flush()
+{
+    if (isEnabled())
+    {
+        t_trace.writeEvents();
+    }
+}
+
+CompileTrace::KernelScope::KernelScope(const char* name, unsigned simdSize, unsigned retryId) :
+    m_active(isEnabled()), m_prevKernel(nullptr), m_prevSimd(0), m_prevRetry(0)
+{
+    if (m_active)
+    {
+        ThreadTrace& T = t_trace;
+        m_prevKernel = T.kernel;
+        m_prevSimd = T.simd;
+        m_prevRetry = T.retry;
+        T.kernel = T.intern(name);
+        T.simd = simdSize;
+        T.retry = retryId;
+    }
+}
+
+CompileTrace::KernelScope::~KernelScope()
+{
+    if (m_active)
+    {
+        ThreadTrace& T = t_trace;
+        T.kernel = m_prevKernel;
+        T.simd = m_prevSimd;
+        T.retry = m_prevRetry;
+    }
+}
@@ -593,6 +593,7 @@ void KernelDebugInfo::setVISAKernel(VISAKernelImpl* k)
 
 void KernelDebugInfo::generateCISAByteOffsetFromOffset()
 {
+    mapCISAOffsetGenOffset.reserve(mapCISAIndexGenOffset.size());
     // Using map1 and map2, generate map3
     for(std::vector<std::pair<unsigned int, unsigned int>>::iterator it = mapCISAIndexGenOffset.begin();
         it != mapCISAIndexGenOffset.end();
@@ -607,7 +608,7 @@ void KernelDebugInfo::generateCISAByteOffsetFromOffset()
 
         if (map_it != mapCISAOffset.end())
         {
-            unsigned int cisaOffset = mapCISAOffset.find(cisaIndex)->second;
+            unsigned int cisaOffset = map_it->second;
             mapCISAOffsetGenOffset.push_back(std::make_pair(cisaOffset, genOffset));
         }
     }
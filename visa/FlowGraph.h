@@ -1230,6 +1230,8 @@ private:
   DO(GRAPH_COLORING_SPILL_FF_BC_RA)                                            \
   DO(GRAPH_COLORING_SPILL_RR_RA)                                               \
   DO(GRAPH_COLORING_SPILL_FF_RA)                                               \
+  DO(LINEAR_SCAN_RA)                                                           \
+  DO(LINEAR_SCAN_SPILL_RA)                                                     \
   DO(UNKNOWN_RA)
 
 enum RA_Type
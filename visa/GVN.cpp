@@ -0,0 +1,583 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "GVN.h"
+#include <climits>
+
+using namespace vISA;
+
+// Order of blocks and their immediate dominators, using the iterative
+// algorithm of Cooper, Harvey and Kennedy over reverse post-order.
+void GVN::computeDominators()
+{
+    std::vector<G4_BB*> postOrder;
+    std::unordered_map<G4_BB*, bool> visited;
+    std::vector<std::pair<G4_BB*, BB_LIST_ITER>> stack;
+
+    G4_BB* entryBB = fg.getEntryBB();
+    visited[entryBB] = true;
+    stack.push_back(std::make_pair(entryBB, entryBB->Succs.begin()));
+    while (!stack.empty())
+    {
+        G4_BB* bb = stack.back().first;
+        BB_LIST_ITER& succIt = stack.back().second;
+        if (succIt != bb->Succs.end())
+        {
+            G4_BB* succ = *succIt;
+            ++succIt;
+            if (!visited[succ])
+            {
+                visited[succ] = true;
+                stack.push_back(std::make_pair(succ, succ->Succs.begin()));
+            }
+        }
+        else
+        {
+            postOrder.push_back(bb);
+            stack.pop_back();
+        }
+    }
+
+    rpo.assign(postOrder.rbegin(), postOrder.rend());
+    for (unsigned int i = 0; i < rpo.size(); i++)
+    {
+        rpoId[rpo[i]] = i;
+    }
+
+    idom.assign(rpo.size(), UINT_MAX);
+    idom[0] = 0;
+
+    auto intersect = [this](unsigned int b1, unsigned int b2)
+    {
+        while (b1 != b2)
+        {
+            while (b1 > b2)
+                b1 = idom[b1];
+            while (b2 > b1)
+                b2 = idom[b2];
+        }
+        return b1;
+    };
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (unsigned int i = 1; i < rpo.size(); i++)
+        {
+            unsigned int newIdom = UINT_MAX;
+            for (auto pred : rpo[i]->Preds)
+            {
+                auto it = rpoId.find(pred);
+                if (it == rpoId.end() || idom[it->second] == UINT_MAX)
+                {
+                    // unreachable or not processed yet
+                    continue;
+                }
+                newIdom = newIdom == UINT_MAX ? it->second : intersect(it->second, newIdom);
+            }
+            if (newIdom != UINT_MAX && idom[i] != newIdom)
+            {
+                idom[i] = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    domChildren.assign(rpo.size(), std::vector<unsigned int>());
+    for (unsigned int i = 1; i < rpo.size(); i++)
+    {
+        domChildren[idom[i]].push_back(i);
+    }
+}
+
+bool GVN::dominates(G4_BB* bb1, G4_BB* bb2) const
+{
+    auto it1 = rpoId.find(bb1);
+    auto it2 = rpoId.find(bb2);
+    if (it1 == rpoId.end() || it2 == rpoId.end())
+    {
+        return false;
+    }
+
+    unsigned int id1 = it1->second, id2 = it2->second;
+    while (id2 > id1)
+    {
+        id2 = idom[id2];
+    }
+    return id1 == id2;
+}
+
+// Return true if inst1 strictly dominates inst2.
+bool GVN::dominates(G4_INST* inst1, G4_INST* inst2) const
+{
+    G4_BB* bb1 = instBB.at(inst1);
+    G4_BB* bb2 = instBB.at(inst2);
+    if (bb1 == bb2)
+    {
+        return inst1->getLocalId() < inst2->getLocalId();
+    }
+    return dominates(bb1, bb2);
+}
+
+void GVN::collectDefsAndUses()
+{
+    for (auto bb : fg)
+    {
+        bb->resetLocalId();
+        for (auto inst : *bb)
+        {
+            instBB[inst] = bb;
+
+            G4_DstRegRegion* dst = inst->getDst();
+            if (dst && !dst->isNullReg() && dst->getBase() && dst->getBase()->isRegVar())
+            {
+                G4_Declare* topDcl = dst->getTopDcl();
+                if (topDcl)
+                {
+                    DclInfo& info = dclInfo[topDcl];
+                    info.numDefs++;
+                    info.def = inst;
+                }
+            }
+
+            for (int i = 0, numSrc = inst->getNumSrc(); i < numSrc; i++)
+            {
+                G4_Operand* src = inst->getSrc(i);
+                if (!src)
+                {
+                    continue;
+                }
+
+                if (src->isAddrExp())
+                {
+                    G4_Declare* dcl = src->asAddrExp()->getRegVar()->getDeclare()->getRootDeclare();
+                    dclInfo[dcl].addrTaken = true;
+                }
+                else if (src->isSrcRegRegion() && !src->asSrcRegRegion()->isIndirect() &&
+                    src->getBase() && src->getBase()->isRegVar())
+                {
+                    G4_Declare* topDcl = src->getTopDcl();
+                    if (topDcl)
+                    {
+                        dclInfo[topDcl].uses.push_back(std::make_pair(inst, (unsigned int)i));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// A source is stable if every instruction it dominates reads the same value
+// from it: an immediate, or a direct GRF region of a variable that is never
+// redefined after its (dominating) definition.
+bool GVN::isStableSrc(G4_Operand* src, G4_INST* inst) const
+{
+    if (src->isImm())
+    {
+        return !src->isRelocImm();
+    }
+
+    if (!src->isSrcRegRegion())
+    {
+        return false;
+    }
+
+    G4_SrcRegRegion* srcRgn = src->asSrcRegRegion();
+    if (srcRgn->isIndirect() || srcRgn->isAccReg() ||
+        !srcRgn->getBase() || !srcRgn->getBase()->isRegVar())
+    {
+        return false;
+    }
+
+    G4_Declare* dcl = srcRgn->getBase()->asRegVar()->getDeclare();
+    if (dcl != srcRgn->getTopDcl() || !dcl->useGRF() || dcl->getAddressed())
+    {
+        return false;
+    }
+
+    auto it = dclInfo.find(dcl);
+    if (it == dclInfo.end())
+    {
+        return false;
+    }
+
+    const DclInfo& info = it->second;
+    if (info.addrTaken || info.numDefs > 1)
+    {
+        return false;
+    }
+    return info.numDefs == 0 || dominates(info.def, inst);
+}
+
+bool GVN::isCandidate(G4_INST* inst) const
+{
+    switch (inst->opcode())
+    {
+    case G4_mov:
+    case G4_add:
+    case G4_mul:
+    case G4_shl:
+    case G4_shr:
+    case G4_asr:
+    case G4_and:
+    case G4_or:
+    case G4_xor:
+    case G4_not:
+    case G4_bfrev:
+    case G4_cbit:
+        break;
+    default:
+        return false;
+    }
+
+    if (inst->getPredicate() || inst->getCondMod() ||
+        inst->getImplAccSrc() || inst->getImplAccDst())
+    {
+        return false;
+    }
+
+    G4_DstRegRegion* dst = inst->getDst();
+    if (!dst || dst->isNullReg() || dst->isIndirect() || dst->isAccReg() ||
+        !dst->getBase() || !dst->getBase()->isRegVar())
+    {
+        return false;
+    }
+
+    // The destination must be the only, full definition of a plain GRF
+    // variable. Keep to one GRF to bound the register pressure increase.
+    G4_Declare* dcl = dst->getBase()->asRegVar()->getDeclare();
+    if (dcl != dst->getTopDcl() ||
+        dcl->getRegFile() != G4_GRF || dcl->getAddressed() ||
+        dcl->isInput() || dcl->isOutput() ||
+        dcl->getRegVar()->isPhyRegAssigned() ||
+        dcl->getByteSize() > GENX_GRF_REG_SIZ)
+    {
+        return false;
+    }
+
+    auto it = dclInfo.find(dcl);
+    if (it == dclInfo.end() || it->second.numDefs != 1 || it->second.addrTaken)
+    {
+        return false;
+    }
+
+    if (dst->getLeftBound() != 0 || dst->getRightBound() + 1 != dcl->getByteSize() ||
+        (inst->getExecSize() > 1 && dst->getHorzStride() != 1))
+    {
+        return false;
+    }
+
+    // Floating point results may depend on the rounding mode, so only
+    // integer operations and raw copies are numbered.
+    G4_Type dstType = dst->getType();
+    for (int i = 0, numSrc = inst->getNumSrc(); i < numSrc; i++)
+    {
+        G4_Operand* src = inst->getSrc(i);
+        if (!src || !isStableSrc(src, inst) || src->getTopDcl() == dcl)
+        {
+            return false;
+        }
+
+        G4_Type srcType = src->getType();
+        bool isCopy = inst->opcode() == G4_mov && srcType == dstType;
+        if (!isCopy && !(IS_TYPE_INT(srcType) && IS_TYPE_INT(dstType)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// All uses of inst's dst must be dominated by inst, so that they can read
+// the value of a dominating instruction instead.
+bool GVN::canReplaceUses(G4_INST* inst) const
+{
+    G4_Declare* dcl = inst->getDst()->getTopDcl();
+    for (auto& use : dclInfo.at(dcl).uses)
+    {
+        G4_INST* useInst = use.first;
+        if (removed.count(useInst))
+        {
+            continue;
+        }
+
+        if (useInst->isLifeTimeEnd() || useInst->opcode() == G4_intrinsic)
+        {
+            return false;
+        }
+
+        G4_Operand* src = useInst->getSrc(use.second);
+        if (!src || !src->isSrcRegRegion() ||
+            src->getBase()->asRegVar()->getDeclare() != dcl ||
+            !dominates(inst, useInst))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t GVN::hashSrc(G4_Operand* src) const
+{
+    size_t hash = src->getType();
+    if (src->isImm())
+    {
+        hash = hash * 31 + std::hash<int64_t>()(src->asImm()->getImm());
+    }
+    else
+    {
+        G4_SrcRegRegion* srcRgn = src->asSrcRegRegion();
+        const RegionDesc* rd = srcRgn->getRegion();
+        hash = hash * 31 + srcRgn->getTopDcl()->getDeclId();
+        hash = hash * 31 + srcRgn->getModifier();
+        hash = hash * 31 + srcRgn->getRegOff();
+        hash = hash * 31 + srcRgn->getSubRegOff();
+        hash = hash * 31 + ((rd->vertStride << 16) | (rd->width << 8) | rd->horzStride);
+    }
+    return hash;
+}
+
+size_t GVN::hashValue(G4_INST* inst) const
+{
+    size_t hash = inst->opcode();
+    hash = hash * 31 + inst->getExecSize();
+    hash = hash * 31 + inst->getSaturate();
+    hash = hash * 31 + inst->isWriteEnableInst();
+    hash = hash * 31 + inst->getDst()->getType();
+
+    int numSrc = inst->getNumSrc();
+    if (INST_COMMUTATIVE(inst->opcode()) && numSrc == 2)
+    {
+        // order independent so that swapped sources hash the same
+        return hash * 31 + hashSrc(inst->getSrc(0)) + hashSrc(inst->getSrc(1));
+    }
+
+    for (int i = 0; i < numSrc; i++)
+    {
+        hash = hash * 31 + hashSrc(inst->getSrc(i));
+    }
+    return hash;
+}
+
+bool GVN::srcsMatch(G4_Operand* src1, G4_Operand* src2) const
+{
+    if (src1->getType() != src2->getType())
+    {
+        return false;
+    }
+
+    if (src1->isImm() || src2->isImm())
+    {
+        return src1->isImm() && src2->isImm() &&
+            src1->asImm()->getImm() == src2->asImm()->getImm();
+    }
+
+    G4_SrcRegRegion* rgn1 = src1->asSrcRegRegion();
+    G4_SrcRegRegion* rgn2 = src2->asSrcRegRegion();
+    const RegionDesc* rd1 = rgn1->getRegion();
+    const RegionDesc* rd2 = rgn2->getRegion();
+    return rgn1->getTopDcl() == rgn2->getTopDcl() &&
+        rgn1->getModifier() == rgn2->getModifier() &&
+        rgn1->getRegOff() == rgn2->getRegOff() &&
+        rgn1->getSubRegOff() == rgn2->getSubRegOff() &&
+        rd1->vertStride == rd2->vertStride &&
+        rd1->width == rd2->width &&
+        rd1->horzStride == rd2->horzStride;
+}
+
+// inst1 is the dominating instruction already in the value table.
+bool GVN::valuesMatch(G4_INST* inst1, G4_INST* inst2) const
+{
+    if (inst1->opcode() != inst2->opcode() ||
+        inst1->getExecSize() != inst2->getExecSize() ||
+        inst1->getSaturate() != inst2->getSaturate() ||
+        inst1->getNumSrc() != inst2->getNumSrc())
+    {
+        return false;
+    }
+
+    // Same emask semantics as LVN: both must write the same channels.
+    if (inst1->isWriteEnableInst() != inst2->isWriteEnableInst() ||
+        (!inst1->isWriteEnableInst() && inst1->getMaskOffset() != inst2->getMaskOffset()))
+    {
+        return false;
+    }
+
+    G4_DstRegRegion* dst1 = inst1->getDst();
+    G4_DstRegRegion* dst2 = inst2->getDst();
+    if (dst1->getType() != dst2->getType() ||
+        dst1->getHorzStride() != dst2->getHorzStride() ||
+        dst1->getTopDcl()->getByteSize() != dst2->getTopDcl()->getByteSize())
+    {
+        return false;
+    }
+
+    bool match = true;
+    for (int i = 0, numSrc = inst1->getNumSrc(); match && i < numSrc; i++)
+    {
+        match = srcsMatch(inst1->getSrc(i), inst2->getSrc(i));
+    }
+
+    if (!match && INST_COMMUTATIVE(inst1->opcode()) && inst1->getNumSrc() == 2)
+    {
+        match = srcsMatch(inst1->getSrc(0), inst2->getSrc(1)) &&
+            srcsMatch(inst1->getSrc(1), inst2->getSrc(0));
+    }
+    return match;
+}
+
+void GVN::transferAlign(G4_Declare* toDcl, G4_Declare* fromDcl)
+{
+    if (!toDcl->isEvenAlign() && fromDcl->isEvenAlign())
+    {
+        toDcl->setEvenAlign();
+    }
+    G4_SubReg_Align align1 = toDcl->getSubRegAlign();
+    G4_SubReg_Align align2 = fromDcl->getSubRegAlign();
+    if (align1 != align2)
+    {
+        toDcl->setSubRegAlign(std::max(align1, align2));
+    }
+}
+
+void GVN::replaceAllUses(G4_INST* inst, G4_INST* gvnInst)
+{
+    G4_Declare* dcl = inst->getDst()->getTopDcl();
+    G4_Declare* gvnDcl = gvnInst->getDst()->getTopDcl();
+
+    // Ensure most constrained alignment gets applied to gvnInst's dst
+    transferAlign(gvnDcl, dcl);
+
+    DclInfo& info = dclInfo[dcl];
+    DclInfo& gvnInfo = dclInfo[gvnDcl];
+    for (auto& use : info.uses)
+    {
+        G4_INST* useInst = use.first;
+        if (removed.count(useInst))
+        {
+            continue;
+        }
+
+        G4_SrcRegRegion* srcToReplace = useInst->getSrc(use.second)->asSrcRegRegion();
+        G4_SrcRegRegion* srcRgn = builder.createSrcRegRegion(srcToReplace->getModifier(), Direct,
+            gvnDcl->getRegVar(), srcToReplace->getRegOff(), srcToReplace->getSubRegOff(),
+            srcToReplace->getRegion(), srcToReplace->getType());
+        if (srcToReplace->isAccRegValid())
+        {
+            srcRgn->setAccRegSel(srcToReplace->getAccRegSel());
+        }
+        useInst->setSrc(srcRgn, use.second);
+        gvnInfo.uses.push_back(use);
+    }
+    info.uses.clear();
+}
+
+void GVN::processBB(G4_BB* bb, std::vector<size_t>& added)
+{
+    for (INST_LIST_ITER it = bb->begin(), itEnd = bb->end(); it != itEnd;)
+    {
+        G4_INST* inst = *it;
+        if (!isCandidate(inst))
+        {
+            ++it;
+            continue;
+        }
+
+        size_t hash = hashValue(inst);
+        auto& entries = valueTable[hash];
+        G4_INST* gvnInst = nullptr;
+        for (auto entryIt = entries.rbegin(); entryIt != entries.rend(); ++entryIt)
+        {
+            if (valuesMatch(*entryIt, inst))
+            {
+                gvnInst = *entryIt;
+                break;
+            }
+        }
+
+        if (gvnInst && canReplaceUses(inst))
+        {
+            replaceAllUses(inst, gvnInst);
+            if (instBB[gvnInst] != bb)
+            {
+                numCrossBBInstsRemoved++;
+            }
+            numInstsRemoved++;
+            removed.insert(inst);
+            it = bb->erase(it);
+            continue;
+        }
+
+        entries.push_back(inst);
+        added.push_back(hash);
+        ++it;
+    }
+}
+
+void GVN::doGVN()
+{
+    // Values flowing through subroutine calls would need interprocedural
+    // dominance, leave such kernels to LVN.
+    if (fg.getHasStackCalls() || fg.getIsStackCallFunc() || fg.getNumCalls() > 0)
+    {
+        return;
+    }
+
+    collectDefsAndUses();
+    computeDominators();
+
+    // Pre-order walk of the dominator tree. Values added by a BB stay
+    // visible to the BBs it dominates and are dropped afterwards.
+    struct Frame
+    {
+        unsigned int node;
+        size_t nextChild;
+        std::vector<size_t> added;
+    };
+    std::vector<Frame> stack;
+    stack.push_back(Frame{ 0, 0, std::vector<size_t>() });
+    processBB(rpo[0], stack.back().added);
+
+    while (!stack.empty())
+    {
+        Frame& frame = stack.back();
+        if (frame.nextChild < domChildren[frame.node].size())
+        {
+            unsigned int child = domChildren[frame.node][frame.nextChild++];
+            stack.push_back(Frame{ child, 0, std::vector<size_t>() });
+            processBB(rpo[child], stack.back().added);
+            continue;
+        }
+
+        for (auto hashIt = frame.added.rbegin(); hashIt != frame.added.rend(); ++hashIt)
+        {
+            valueTable[*hashIt].pop_back();
+        }
+        stack.pop_back();
+    }
+}
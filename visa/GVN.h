@@ -0,0 +1,106 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#ifndef _G4_GVN_H_
+#define _G4_GVN_H_
+
+#include "BuildIR.h"
+#include "FlowGraph.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace vISA
+{
+//
+// Dominator-based global value numbering over G4 IR.
+//
+// LVN only looks inside one BB. GVN walks the dominator tree and removes an
+// instruction when a dominating instruction computes the same value into a
+// single-def variable. Only pure integer ALU operations and plain copies are
+// considered, and their sources must be immediates or single-def variables
+// whose definition dominates them, so that both instructions are guaranteed
+// to see the same inputs. Operand matching follows LVN: type, region, source
+// modifier and emask all have to be identical.
+//
+class GVN
+{
+public:
+    GVN(G4_Kernel& k, IR_Builder& irBuilder) :
+        kernel(k), fg(k.fg), builder(irBuilder)
+    {
+    }
+
+    void doGVN();
+    unsigned int getNumInstsRemoved() const { return numInstsRemoved; }
+    unsigned int getNumCrossBBInstsRemoved() const { return numCrossBBInstsRemoved; }
+
+private:
+    struct DclInfo
+    {
+        G4_INST* def = nullptr;
+        unsigned int numDefs = 0;
+        bool addrTaken = false;
+        std::vector<std::pair<G4_INST*, unsigned int>> uses; // inst, src index
+    };
+
+    G4_Kernel& kernel;
+    FlowGraph& fg;
+    IR_Builder& builder;
+    unsigned int numInstsRemoved = 0;
+    unsigned int numCrossBBInstsRemoved = 0;
+
+    std::unordered_map<G4_Declare*, DclInfo> dclInfo;
+    std::unordered_map<G4_INST*, G4_BB*> instBB;
+    std::unordered_set<G4_INST*> removed;
+
+    // Dominator tree, indexed by reverse post-order number.
+    std::vector<G4_BB*> rpo;
+    std::unordered_map<G4_BB*, unsigned int> rpoId;
+    std::vector<unsigned int> idom;
+    std::vector<std::vector<unsigned int>> domChildren;
+
+    // Value table. Entries are pushed while walking down the dominator tree
+    // and popped when leaving the BB that added them.
+    std::unordered_map<size_t, std::vector<G4_INST*>> valueTable;
+
+    void computeDominators();
+    bool dominates(G4_BB* bb1, G4_BB* bb2) const;
+    bool dominates(G4_INST* inst1, G4_INST* inst2) const;
+    void collectDefsAndUses();
+
+    bool isStableSrc(G4_Operand* src, G4_INST* inst) const;
+    bool isCandidate(G4_INST* inst) const;
+    bool canReplaceUses(G4_INST* inst) const;
+    size_t hashSrc(G4_Operand* src) const;
+    size_t hashValue(G4_INST* inst) const;
+    bool srcsMatch(G4_Operand* src1, G4_Operand* src2) const;
+    bool valuesMatch(G4_INST* inst1, G4_INST* inst2) const;
+    void replaceAllUses(G4_INST* inst, G4_INST* gvnInst);
+    void transferAlign(G4_Declare* toDcl, G4_Declare* fromDcl);
+    void processBB(G4_BB* bb, std::vector<size_t>& added);
+};
+}
+#endif
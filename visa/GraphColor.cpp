@@ -32,6 +32,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <iostream>
 #include <sstream>
 #include "Timer.h"
+#include "CompileTrace.h"
 #include <fstream>
 #include <algorithm>
 #include "LocalRA.h"
@@ -6200,6 +6201,43 @@ void GlobalRA::determineSpillRegSize(unsigned& spillRegSize, unsigned& indrSpill
 }
 
 
+//
+// Set up the sub-reg alignment from declare information
+//
+void GraphColor::setSubRegAlignments()
+{
+    for (unsigned i = 0; i < numVar; i++)
+    {
+        G4_Declare* dcl = lrs[i]->getDcl();
+
+        if (gra.getSubRegAlign(dcl) == Any && !dcl->getIsPartialDcl())
+        {
+            //
+            // multi-row, subreg alignment = 16 words
+            //
+            if (dcl->getNumRows() > 1)
+            {
+                gra.setSubRegAlign(lrs[i]->getVar()->getDeclare(), GRFALIGN);
+            }
+            //
+            // single-row
+            //
+            else if (gra.getSubRegAlign(lrs[i]->getVar()->getDeclare()) == Any)
+            {
+                //
+                // set up Odd word or Even word sub reg alignment
+                //
+                unsigned nbytes = dcl->getNumElems()* G4_Type_Table[dcl->getElemType()].byteSize;
+                unsigned nwords = nbytes / G4_WSIZE + nbytes % G4_WSIZE;
+                if (nwords >= 2 && lrs[i]->getRegKind() == G4_GRF)
+                {
+                    gra.setSubRegAlign(lrs[i]->getVar()->getDeclare(), Even_Word);
+                }
+            }
+        }
+    }
+}
+
 bool GraphColor::regAlloc(bool doBankConflictReduction,
     bool highInternalConflict,
     bool reserveSpillReg, unsigned& spillRegSize, unsigned& indrSpillRegSize,
@@ -6258,6 +6296,14 @@ bool GraphColor::regAlloc(bool doBankConflictReduction,
     //
     intf.init(mem);
     intf.computeInterference();
+
+    if (builder.getOption(vISA_DumpCompilerStats))
+    {
+        CompilerStats &stats = builder.getcompilerStats();
+        int simd = kernel.getSimdSize();
+        stats.MaxI64("RAInterferenceBytes", intf.getSizeInBytes(), simd);
+        stats.MaxI64("RALivenessBytes", liveAnalysis.getBitsetSizeInBytes(), simd);
+    }
 #ifdef DEBUG_VERBOSE_ON
     intf.dumpInterference();
     //    intf.interferenceVerificationForSplit();
@@ -6285,36 +6331,8 @@ bool GraphColor::regAlloc(bool doBankConflictReduction,
     //
     // Set up the sub-reg alignment from declare information
     //
-    for (unsigned i = 0; i < numVar; i++)
-    {
-        G4_Declare* dcl = lrs[i]->getDcl();
+    setSubRegAlignments();
 
-        if (gra.getSubRegAlign(dcl) == Any && !dcl->getIsPartialDcl())
-        {
-            //
-            // multi-row, subreg alignment = 16 words
-            //
-            if (dcl->getNumRows() > 1)
-            {
-                gra.setSubRegAlign(lrs[i]->getVar()->getDeclare(), GRFALIGN);
-            }
-            //
-            // single-row
-            //
-            else if (gra.getSubRegAlign(lrs[i]->getVar()->getDeclare()) == Any)
-            {
-                //
-                // set up Odd word or Even word sub reg alignment
-                //
-                unsigned nbytes = dcl->getNumElems()* G4_Type_Table[dcl->getElemType()].byteSize;
-                unsigned nwords = nbytes / G4_WSIZE + nbytes % G4_WSIZE;
-                if (nwords >= 2 && lrs[i]->getRegKind() == G4_GRF)
-                {
-                    gra.setSubRegAlign(lrs[i]->getVar()->getDeclare(), Even_Word);
-                }
-            }
-        }
-    }
     //
     // assign registers for GRFs, GRFs are first attempted to be assigned using round-robin and if it fails
     // then we retry using a first-fit heuristic.
@@ -8703,6 +8721,7 @@ void GlobalRA::addrRegAlloc()
 
     while (iterationNo < maxRAIterations)
     {
+        CompileTrace::Scope traceIteration("vISA", "Address RA iteration");
         if (builder.getOption(vISA_RATrace))
         {
             std::cout << "--address RA iteration " << iterationNo << "\n";
@@ -8782,6 +8801,7 @@ void GlobalRA::flagRegAlloc()
 
     while (iterationNo < maxRAIterations)
     {
+        CompileTrace::Scope traceIteration("vISA", "Flag RA iteration");
         if (builder.getOption(vISA_RATrace))
         {
             std::cout << "--flag RA iteration " << iterationNo << "\n";
@@ -9033,6 +9053,36 @@ bool canDoLRA(G4_Kernel& kernel)
     return ret;
 }
 
+//
+// Use the linear-scan GRF allocator when it is requested, or automatically when
+// the kernel is large enough that building the interference graph would
+// dominate compile time. Stack calls need the caller/callee-save interference
+// that only graph coloring models.
+//
+bool GlobalRA::useLinearScanRA()
+{
+    if (kernel.fg.getHasStackCalls() || kernel.fg.getIsStackCallFunc() || isReRAPass())
+    {
+        return false;
+    }
+    if (builder.getOption(vISA_LinearScanRA))
+    {
+        return true;
+    }
+
+    unsigned threshold = builder.getOptions()->getuInt32Option(vISA_LinearScanRAThreshold);
+    if (threshold == 0)
+    {
+        return false;
+    }
+    unsigned numInsts = 0;
+    for (auto bb : kernel.fg)
+    {
+        numInsts += (unsigned)bb->size();
+    }
+    return numInsts >= threshold;
+}
+
 //
 // graph coloring entry point.  returns nonzero if RA fails
 //
@@ -9084,6 +9134,10 @@ int GlobalRA::coloringRegAlloc()
             addStoreRestoreForFP();
         }
     }
+    // the linear-scan tier trades code quality for compile time, skipping
+    // hybrid RA, interference, remat, splitting and spill space compression
+    bool useLinearScan = useLinearScanRA();
+
     if (builder.getOption(vISA_LocalRA) && !isReRAPass() && canDoLRA(kernel) && !hasStackCall)
     {
         startTimer(TIMER_LOCAL_RA);
@@ -9092,12 +9146,18 @@ int GlobalRA::coloringRegAlloc()
         LocalRA lra(bc, *this);
         bool success = lra.localRA();
         stopTimer(TIMER_LOCAL_RA);
-        if (!success)
+        if (!success && !useLinearScan)
         {
             startTimer(TIMER_HYBRID_RA);
             success = hybridRA(lra.doHybridBCR(), lra.hasHighInternalBC(), lra);
             stopTimer(TIMER_HYBRID_RA);
         }
+        else if (!success)
+        {
+            // linear scan allocates every range itself
+            lra.undoLocalRAAssignments(false);
+            copyAlignment();
+        }
         if (success)
         {
             // either local or hybrid RA succeeds
@@ -9115,10 +9175,12 @@ int GlobalRA::coloringRegAlloc()
 
     int globalScratchOffset = builder.getOptions()->getuInt32Option(vISA_SpillMemOffset);
     bool useScratchMsgForSpill = globalScratchOffset < (int) (SCRATCH_MSG_LIMIT * 0.6) && !hasStackCall;
-    bool enableSpillSpaceCompression = builder.getOption(vISA_SpillSpaceCompression);
+    bool enableSpillSpaceCompression = builder.getOption(vISA_SpillSpaceCompression) && !useLinearScan;
 
     uint32_t nextSpillOffset = 0;
     uint32_t scratchOffset = 0;
+    // scratch bytes the spilled ranges would need without slot reuse
+    uint32_t uncompressedSpillSize = 0;
 
     uint32_t GRFSpillFillCount = 0;
     uint32_t sendAssociatedGRFSpillFillCount = 0;
@@ -9128,6 +9190,7 @@ int GlobalRA::coloringRegAlloc()
     VarSplit splitPass(*this);
     while (iterationNo < maxRAIterations)
     {
+        CompileTrace::Scope traceIteration("vISA", "GRF RA iteration");
         if (builder.getOption(vISA_RATrace))
         {
             std::cout << "--GRF RA iteration " << iterationNo << "--\n";
@@ -9147,7 +9210,7 @@ int GlobalRA::coloringRegAlloc()
         markGraphBlockLocalVars();
 
         //Do variable splitting in each iteration
-        if (builder.getOption(vISA_LocalDeclareSplitInGlobalRA))
+        if (builder.getOption(vISA_LocalDeclareSplitInGlobalRA) && !useLinearScan)
         {
             if (builder.getOption(vISA_RATrace))
             {
@@ -9166,7 +9229,7 @@ int GlobalRA::coloringRegAlloc()
         bool highInternalConflict = false;  // this is set by setupBankConflictsForKernel
 
         if (builder.getOption(vISA_LocalBankConflictReduction) &&
-            builder.hasBankCollision())
+            builder.hasBankCollision() && !useLinearScan)
         {
             bool reduceBCInRR = false;
             bool reduceBCInTAandFF = false;
@@ -9210,7 +9273,10 @@ int GlobalRA::coloringRegAlloc()
             // force spill should be done only for the 1st iteration
             bool forceSpill = iterationNo > 0 ? false : builder.getOption(vISA_ForceSpills);
             RPE rpe(*this, &liveAnalysis);
-            rpe.run();
+            if (!useLinearScan)
+            {
+                rpe.run();
+            }
             GraphColor coloring(liveAnalysis, kernel.getNumRegTotal(), false, forceSpill);
 
             if (builder.getOption(vISA_dumpRPE) && iterationNo == 0 && !rematDone)
@@ -9221,7 +9287,9 @@ int GlobalRA::coloringRegAlloc()
 
             unsigned spillRegSize = 0;
             unsigned indrSpillRegSize = 0;
-            bool isColoringGood = coloring.regAlloc(doBankConflictReduction, highInternalConflict, reserveSpillReg, spillRegSize, indrSpillRegSize, &rpe);
+            bool isColoringGood = useLinearScan ?
+                coloring.linearScanRegAlloc(reserveSpillReg, spillRegSize, indrSpillRegSize) :
+                coloring.regAlloc(doBankConflictReduction, highInternalConflict, reserveSpillReg, spillRegSize, indrSpillRegSize, &rpe);
             if (isColoringGood == false)
             {
                 if (isReRAPass())
@@ -9240,7 +9308,8 @@ int GlobalRA::coloringRegAlloc()
                 bool globalSplitChange = false;
 
                 if (!rematDone &&
-                    rematOff)
+                    rematOff &&
+                    !useLinearScan)
                 {
                     if (builder.getOption(vISA_RATrace))
                     {
@@ -9274,6 +9343,7 @@ int GlobalRA::coloringRegAlloc()
                 }
 
                 if (iterationNo == 0 &&                             //Only works when first iteration of Global RA failed.
+                    !useLinearScan &&
                     !splitPass.didGlobalSplit &&                      //Do only one time.
                     splitPass.canDoGlobalSplit(builder, kernel, sendAssociatedGRFSpillFillCount))
                 {
@@ -9298,7 +9368,7 @@ int GlobalRA::coloringRegAlloc()
                     GRFSpillFillCount += spilled->getRefCount();
                 }
 
-                if (builder.getOption(vISA_OptReport) && iterationNo == 0)
+                if (builder.getOption(vISA_OptReport) && iterationNo == 0 && !useLinearScan)
                 {
                     // Dump out interference graph information of spill candidates
                     reportSpillInfo(liveAnalysis, coloring);
@@ -9363,6 +9433,7 @@ int GlobalRA::coloringRegAlloc()
 
                 bool success = spillGRF.insertSpillFillCode(&kernel, pointsToAnalysis);
                 nextSpillOffset = spillGRF.getNextOffset();
+                uncompressedSpillSize += spillGRF.getUncompressedSpillSize();
 
                 if (builder.getOption(vISA_RATrace))
                 {
@@ -9385,7 +9456,7 @@ int GlobalRA::coloringRegAlloc()
 
                 bool disableSpillCoalecse = builder.getOption(vISA_DisableSpillCoalescing) ||
                     builder.getOption(vISA_FastSpill) || builder.getOption(vISA_Debug) ||
-                    !useScratchMsgForSpill;
+                    !useScratchMsgForSpill || useLinearScan;
 
                 if (!reserveSpillReg && !disableSpillCoalecse && builder.useSends())
                 {
@@ -9439,6 +9510,9 @@ int GlobalRA::coloringRegAlloc()
                     case RA_Type::GRAPH_COLORING_FF_RA:
                         kernel.setRAType(RA_Type::GRAPH_COLORING_SPILL_FF_RA);
                         break;
+                    case RA_Type::LINEAR_SCAN_RA:
+                        kernel.setRAType(RA_Type::LINEAR_SCAN_SPILL_RA);
+                        break;
                     default:
                         assert(0);
                         break;
@@ -9504,6 +9578,24 @@ int GlobalRA::coloringRegAlloc()
     //
     if (spillMemUsed)
     {
+        // uncompressedSpillSize undercounts when slots were handed out lazily
+        // (e.g. sub-range spills), so never report a negative saving.
+        uncompressedSpillSize = std::max(uncompressedSpillSize, spillMemUsed);
+        if (builder.getOption(vISA_DumpCompilerStats))
+        {
+            CompilerStats &stats = builder.getcompilerStats();
+            int simd = kernel.getSimdSize();
+            stats.SetI64("SpillMemUncompressed", uncompressedSpillSize, simd);
+            stats.SetI64("SpillMemUsed", spillMemUsed, simd);
+        }
+        if (kernel.getOption(vISA_OptReport))
+        {
+            std::ofstream optreport;
+            getOptReportStream(optreport, builder.getOptions());
+            optreport << "Spill slot reuse: " << uncompressedSpillSize << " -> " <<
+                spillMemUsed << " scratch bytes" << std::endl;
+            closeOptReportStream(optreport);
+        }
         RELEASE_MSG("Spill memory used = " << spillMemUsed << " bytes for kernel " <<
             kernel.getName() << std::endl << " Compiling kernel with spill code may degrade performance." <<
             " Please consider rewriting the kernel to use less registers." << std::endl);
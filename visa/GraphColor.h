@@ -431,6 +431,21 @@ namespace vISA
 
         void computeInterference();
         bool interfereBetween(unsigned v1, unsigned v2) const;
+
+        // Approximate storage held by the interference matrix.
+        size_t getSizeInBytes() const
+        {
+            if (useDenseMatrix())
+            {
+                return (size_t)getRowSize() * maxId * sizeof(uint32_t);
+            }
+            size_t numEdges = 0;
+            for (auto &I : sparseMatrix)
+            {
+                numEdges += I.size();
+            }
+            return numEdges * sizeof(uint32_t);
+        }
         inline unsigned int getInterferenceBlk(unsigned idx) const
         {
             assert(useDenseMatrix() && "matrix is not initialized");
@@ -570,6 +585,7 @@ namespace vISA
         void relaxNeighborDegreeGRF(LiveRange* lr);
         void relaxNeighborDegreeARF(LiveRange* lr);
         bool assignColors(ColorHeuristic heuristicGRF, bool doBankConflict, bool highInternalConflict);
+        void setSubRegAlignments();
 
         void clearSpillAddrLocSignature()
         {
@@ -590,6 +606,8 @@ namespace vISA
             bool doBankConflictReduction,
             bool highInternalConflict,
             bool reserveSpillReg, unsigned& spillRegSize, unsigned& indrSpillRegSize, RPE* rpe);
+        // fast-compile alternative to regAlloc() for GRF, see LinearScanGRA.cpp
+        bool linearScanRegAlloc(bool reserveSpillReg, unsigned& spillRegSize, unsigned& indrSpillRegSize);
         bool requireSpillCode() { return !spilledLRs.empty(); }
         Interference * getIntf() { return &intf; }
         void createLiveRanges(unsigned reserveSpillSize = 0);
@@ -1265,6 +1283,7 @@ namespace vISA
         bool hybridRA(bool doBankConflictReduction, bool highInternalConflict, LocalRA& lra);
         void assignRegForAliasDcl();
         void removeSplitDecl();
+        bool useLinearScanRA();
         int coloringRegAlloc();
         void addCallerSavePseudoCode();
         void addCalleeSavePseudoCode();
@@ -5971,6 +5971,223 @@ void HWConformity::fixSelCsel(INST_LIST_ITER it, G4_BB* bb)
     }
 }
 
+// Returns the set of conformBB() rules that may apply to inst. Each bit mirrors
+// the early-exit condition of the corresponding fixer, so an instruction with
+// an empty set is left unchanged by conformBB() and can be skipped outright.
+uint32_t HWConformity::classifyInst(G4_INST* inst) const
+{
+    uint32_t rules = 0;
+    G4_opcode op = inst->opcode();
+    G4_DstRegRegion* dst = inst->getDst();
+    G4_Operand* src0 = inst->getSrc(0);
+    G4_Operand* src1 = inst->getSrc(1);
+    int numSrc = inst->getNumSrc();
+    bool skipSpecial = inst->mayExceedTwoGRF();
+
+    bool hasFloatSrc = false, hasIntSrc = false, has64bSrc = false;
+    bool hasImm64Src = false, hasAccSrc = false;
+    for (int i = 0; i < numSrc; i++)
+    {
+        G4_Operand* src = inst->getSrc(i);
+        if (!src)
+        {
+            continue;
+        }
+        G4_Type ty = src->getType();
+        if (IS_TYPE_FLOAT_ALL(ty))
+        {
+            hasFloatSrc = true;
+        }
+        else
+        {
+            hasIntSrc = true;
+        }
+        if (G4_Type_Table[ty].byteSize == 8)
+        {
+            has64bSrc = true;
+            hasImm64Src |= src->isImm();
+        }
+        hasAccSrc |= src->isAccReg();
+    }
+
+    for (int i = 0; i < G4_MAX_SRCS; i++)
+    {
+        G4_Operand* src = inst->getSrc(i);
+        if (src && src->isSrcRegRegion() && !src->isNullReg())
+        {
+            rules |= 1u << RULE_SrcRegion;
+            break;
+        }
+    }
+
+    if (op == G4_mov)
+    {
+        G4_Type dstTy = dst->getType(), srcTy = src0->getType();
+        if (IS_BTYPE(dstTy) || IS_BTYPE(srcTy) ||
+            isLowPrecisionFloatTy(dstTy) || isLowPrecisionFloatTy(srcTy))
+        {
+            rules |= 1u << RULE_Mov;
+        }
+    }
+
+    if (!skipSpecial && op != G4_smov &&
+        ((hasFloatSrc && hasIntSrc) ||
+         (builder.noSrc1Byte() && numSrc > 1 && src0 && src1 && IS_BTYPE(src1->getType()))))
+    {
+        rules |= 1u << RULE_OpndType;
+    }
+
+    if ((op == G4_sel || op == G4_csel) && inst->getCondMod())
+    {
+        rules |= 1u << RULE_SelCsel;
+    }
+
+    G4_Predicate* pred = inst->getPredicate();
+    if (pred && (pred->getControl() == PRED_ANY_WHOLE || pred->getControl() == PRED_ALL_WHOLE))
+    {
+        rules |= 1u << RULE_PredCtrl;
+    }
+
+    if (inst->isMath())
+    {
+        rules |= 1u << RULE_Math;
+        if (inst->getExecSize() > builder.getNativeExecSize())
+        {
+            rules |= 1u << RULE_HFMathSplit;
+        }
+    }
+
+    if (numSrc == 3 && !skipSpecial && op != G4_madm)
+    {
+        rules |= 1u << RULE_ThreeSrc;
+    }
+
+    if (op == G4_mul)
+    {
+        rules |= 1u << RULE_Mul;
+    }
+    else if (op == G4_mulh)
+    {
+        rules |= 1u << RULE_Mulh;
+    }
+
+    if ((dst && !inst->hasNULLDst() && dst->getRegAccess() != Direct) ||
+        (src0 && src0->isSrcRegRegion() && src0->getRegAccess() != Direct) ||
+        (src1 && src1->isSrcRegRegion() && src1->getRegAccess() != Direct))
+    {
+        rules |= 1u << RULE_IndirectOpnd;
+    }
+
+    if (op == G4_cmp || op == G4_cmpn)
+    {
+        rules |= 1u << RULE_Compare;
+    }
+
+    if ((dst && dst->isAccReg()) || op == G4_mach || hasAccSrc ||
+        inst->hasImplicitAccSrc() || inst->hasImplicitAccDst())
+    {
+        rules |= 1u << RULE_Acc;
+    }
+
+    if (dst && inst->getExecSize() == 1 && !inst->isSend())
+    {
+        rules |= 1u << RULE_DstHstride;
+    }
+
+    if (op == G4_pln)
+    {
+        rules |= 1u << RULE_Plane;
+    }
+    else if (op == G4_line)
+    {
+        rules |= 1u << RULE_Line;
+    }
+    else if (op == G4_rol || op == G4_ror)
+    {
+        rules |= 1u << RULE_Rotate;
+    }
+
+    if (!builder.hasVxHFloat64b() && src0 && src0->isSrcRegRegion() &&
+        src0->getRegAccess() == IndirGRF && src0->asSrcRegRegion()->getRegion()->isRegionWH())
+    {
+        rules |= 1u << RULE_VxHFloat64b;
+    }
+
+    if (builder.no64bitRegioning() && !skipSpecial &&
+        (has64bSrc || op == G4_mul || (dst && G4_Type_Table[dst->getType()].byteSize == 8)))
+    {
+        rules |= 1u << RULE_Inst64b;
+    }
+
+    if (hasImm64Src)
+    {
+        rules |= 1u << RULE_Imm64;
+    }
+
+    if (getGenxPlatform() == GENX_BDW && dst && dst->getType() == Type_HF)
+    {
+        rules |= 1u << RULE_PackedHF;
+    }
+
+    return rules;
+}
+
+namespace
+{
+    // Snapshot of the parts of an instruction (and its BB) a conformBB() fixer
+    // may touch. Comparing two snapshots tells whether a fixer did anything.
+    struct InstSnapshot
+    {
+        size_t bbSize;
+        G4_INST* inst;
+        G4_opcode op;
+        unsigned char execSize;
+        G4_DstRegRegion* dst;
+        unsigned short dstHS;
+        G4_Type dstType;
+        G4_Predicate* pred;
+        G4_CondMod* condMod;
+        G4_Operand* srcs[G4_MAX_SRCS];
+        G4_Type srcTypes[G4_MAX_SRCS];
+        const RegionDesc* regions[G4_MAX_SRCS];
+
+        InstSnapshot(G4_BB* bb, INST_LIST_ITER it) :
+            bbSize(bb->size()), inst(*it), op(inst->opcode()), execSize(inst->getExecSize()),
+            dst(inst->getDst()), dstHS(dst ? dst->getHorzStride() : 0),
+            dstType(dst ? dst->getType() : Type_UNDEF),
+            pred(inst->getPredicate()), condMod(inst->getCondMod())
+        {
+            for (int i = 0; i < G4_MAX_SRCS; i++)
+            {
+                G4_Operand* src = inst->getSrc(i);
+                srcs[i] = src;
+                srcTypes[i] = src ? src->getType() : Type_UNDEF;
+                regions[i] = src && src->isSrcRegRegion() ? src->asSrcRegRegion()->getRegion() : nullptr;
+            }
+        }
+
+        bool operator==(const InstSnapshot& other) const
+        {
+            if (bbSize != other.bbSize || inst != other.inst || op != other.op ||
+                execSize != other.execSize || dst != other.dst || dstHS != other.dstHS ||
+                dstType != other.dstType || pred != other.pred || condMod != other.condMod)
+            {
+                return false;
+            }
+            for (int i = 0; i < G4_MAX_SRCS; i++)
+            {
+                if (srcs[i] != other.srcs[i] || srcTypes[i] != other.srcTypes[i] ||
+                    regions[i] != other.regions[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        bool operator!=(const InstSnapshot& other) const { return !(*this == other); }
+    };
+}
+
 void HWConformity::conformBB(G4_BB* bb)
 {
     INST_LIST_ITER i = bb->begin(), iEnd = bb->end();
@@ -5988,24 +6205,70 @@ void HWConformity::conformBB(G4_BB* bb)
             continue;
         }
 
+        // Classify once and only run the fixers whose precondition holds; the
+        // common case of an already legal instruction needs none of them.
+        uint32_t rules = classifyInst(inst);
+        numInstsClassified++;
+        if (rules == 0)
+        {
+            numInstsSkipped++;
+            continue;
+        }
+        auto mayApply = [&rules](ConformityRule rule) { return (rules & (1u << rule)) != 0; };
+
+        // After a fixer changes the instruction, reclassify it so the rules that
+        // follow see its current form, exactly as the full sequence would.
+        InstSnapshot lastState(bb, i);
+        auto recordFix = [&](ConformityRule rule)
+        {
+            InstSnapshot state(bb, i);
+            if (state != lastState)
+            {
+                numRuleFixes[rule]++;
+                rules = classifyInst(*i);
+                lastState = state;
+            }
+        };
+
         // do this early since otherwise the moves inserted by other passes may still
         // inherit bad regions from the original inst
-        fixSrcRegion(inst);
+        if (mayApply(RULE_SrcRegion))
+        {
+            fixSrcRegion(inst);
+            recordFix(RULE_SrcRegion);
+        }
 
-        bool changed = fixMov(i, bb);
-        if (changed)
+        if (mayApply(RULE_Mov))
         {
-            next_iter = i;
-            next_iter++;
+            bool changed = fixMov(i, bb);
+            if (changed)
+            {
+                next_iter = i;
+                next_iter++;
+            }
+            recordFix(RULE_Mov);
         }
 
-        fixOpndType(i, bb);
+        if (mayApply(RULE_OpndType))
+        {
+            fixOpndType(i, bb);
+            recordFix(RULE_OpndType);
+        }
 
-        fixSelCsel(i, bb);
+        if (mayApply(RULE_SelCsel))
+        {
+            fixSelCsel(i, bb);
+            // only clears the condMod's flag base, which the snapshot doesn't track
+            numRuleFixes[RULE_SelCsel]++;
+        }
 
-        fixPredCtrl(i, bb);
+        if (mayApply(RULE_PredCtrl))
+        {
+            fixPredCtrl(i, bb);
+            recordFix(RULE_PredCtrl);
+        }
 
-        if (inst->getExecSize() > builder.getNativeExecSize())
+        if (mayApply(RULE_HFMathSplit) && inst->getExecSize() > builder.getNativeExecSize())
         {
             if (inst->opcode() == G4_math               &&
                 inst->getDst()->getType() == Type_HF    &&
@@ -6014,9 +6277,15 @@ void HWConformity::conformBB(G4_BB* bb)
             {
                 // split pure HF math to simd8
                 evenlySplitInst(i, bb);
+                recordFix(RULE_HFMathSplit);
             }
         }
-        fix3SrcInst(i, bb);
+
+        if (mayApply(RULE_ThreeSrc))
+        {
+            fix3SrcInst(i, bb);
+            recordFix(RULE_ThreeSrc);
+        }
 
         G4_Operand *dst = inst->getDst();
 
@@ -6024,7 +6293,7 @@ void HWConformity::conformBB(G4_BB* bb)
         verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
 #endif
 
-        if (inst->isMath())
+        if (mayApply(RULE_Math) && inst->isMath())
         {
             if( fixMathInst( i, bb ) )
             {
@@ -6032,6 +6301,7 @@ void HWConformity::conformBB(G4_BB* bb)
                 next_iter = i;
                 next_iter++;
             }
+            recordFix(RULE_Math);
         }
 
         inst = *i;
@@ -6040,7 +6310,7 @@ void HWConformity::conformBB(G4_BB* bb)
         verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
 #endif
 
-        if( inst->opcode() == G4_mul )
+        if (mayApply(RULE_Mul) && inst->opcode() == G4_mul )
         {
             if(fixMULInst( i, bb ) )
             {
@@ -6049,15 +6319,17 @@ void HWConformity::conformBB(G4_BB* bb)
                 next_iter = i;
                 next_iter++;
             }
+            recordFix(RULE_Mul);
         }
 
 #ifdef _DEBUG
         verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
 #endif
 
-        if( inst->opcode() == G4_mulh )
+        if (mayApply(RULE_Mulh) && inst->opcode() == G4_mulh )
         {
             fixMULHInst( i, bb );
+            numRuleFixes[RULE_Mulh]++;
             // inserted mul before
             // check the newly added MUL inst
             i--;
@@ -6070,7 +6342,11 @@ void HWConformity::conformBB(G4_BB* bb)
 #endif
 
         // HW check #6: indirect operand spilling
-        fixIndirectOpnd( i, bb );
+        if (mayApply(RULE_IndirectOpnd))
+        {
+            fixIndirectOpnd( i, bb );
+            recordFix(RULE_IndirectOpnd);
+        }
 
 #ifdef _DEBUG
         verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
@@ -6083,7 +6359,7 @@ void HWConformity::conformBB(G4_BB* bb)
         inst = *i;
         opcode = inst->opcode();
 
-        if (opcode == G4_cmp || opcode == G4_cmpn)
+        if (mayApply(RULE_Compare) && (opcode == G4_cmp || opcode == G4_cmpn))
         {
             dst = inst->getDst();
             int dst_elsize = 0;
@@ -6095,22 +6371,28 @@ void HWConformity::conformBB(G4_BB* bb)
             int extypesize;
             G4_Type extype = inst->getOpExecType( extypesize );
             fixCompareInst( i, bb, extype, dst_elsize );
+            recordFix(RULE_Compare);
         }
         dst = inst->getDst();
 
 #ifdef _DEBUG
         verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
 #endif
-        if (fixAcc(i, bb))
+        if (mayApply(RULE_Acc))
         {
-            next_iter = i;
-            next_iter++;
+            if (fixAcc(i, bb))
+            {
+                next_iter = i;
+                next_iter++;
+            }
+            recordFix(RULE_Acc);
         }
 
 #ifdef _DEBUG
         verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
 #endif
 
+        if (mayApply(RULE_DstHstride))
         {
             dst = inst->getDst();
             G4_Type extype = inst->getExecType2();
@@ -6129,6 +6411,7 @@ void HWConformity::conformBB(G4_BB* bb)
                 !inst->isSend())
             {
                 fixDstHstride( i, extypesize );
+                recordFix(RULE_DstHstride);
             }
         }
 
@@ -6136,37 +6419,102 @@ void HWConformity::conformBB(G4_BB* bb)
         verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
 #endif
 
-        bool planeDeleted = fixPlaneInst(i, bb);
-        if (planeDeleted)
+        if (mayApply(RULE_Plane))
         {
-            continue;
+            bool planeDeleted = fixPlaneInst(i, bb);
+            if (planeDeleted)
+            {
+                numRuleFixes[RULE_Plane]++;
+                continue;
+            }
+            recordFix(RULE_Plane);
         }
 
-        fixLine(i, bb);
-        fixRotate(i, bb);
+        if (mayApply(RULE_Line))
+        {
+            fixLine(i, bb);
+            recordFix(RULE_Line);
+        }
+        if (mayApply(RULE_Rotate))
+        {
+            fixRotate(i, bb);
+            recordFix(RULE_Rotate);
+        }
 
-        if (!builder.hasVxHFloat64b())
+        if (mayApply(RULE_VxHFloat64b))
         {
             fixVxHFloat64b(i, bb);
+            recordFix(RULE_VxHFloat64b);
         }
 
         // CHV/BXT specific checks for 64b datatypes
-        fix64bInst( i, bb);
+        if (mayApply(RULE_Inst64b))
+        {
+            fix64bInst( i, bb);
+            recordFix(RULE_Inst64b);
+        }
 
 #ifdef _DEBUG
         verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
 #endif
-        fixImm64( i, bb ); // fixed immediates for DF4 in fixImm64()
+        if (mayApply(RULE_Imm64))
+        {
+            fixImm64( i, bb ); // fixed immediates for DF4 in fixImm64()
+            recordFix(RULE_Imm64);
+        }
 
 
         // FIXME: may be better to call fixDstAlign instead
-        if (getGenxPlatform() == GENX_BDW)
+        if (mayApply(RULE_PackedHF))
         {
             fixPackedHFConversions(i, bb);
+            recordFix(RULE_PackedHF);
         }
     }
 }
 
+// Reports how often each conformBB() rule fired, to the opt report when it is
+// enabled and to the compiler stats when they are being collected.
+void HWConformity::reportRuleStats()
+{
+    static const char* ruleNames[NUM_CONFORMITY_RULES] =
+    {
+#define DEFINE_CONFORMITY_RULE_NAME(name) #name,
+        HW_CONFORMITY_RULES(DEFINE_CONFORMITY_RULE_NAME)
+#undef DEFINE_CONFORMITY_RULE_NAME
+    };
+
+    if (builder.getOption(vISA_DumpCompilerStats))
+    {
+        CompilerStats &stats = builder.getcompilerStats();
+        int simd = kernel.getSimdSize();
+        stats.SetI64("HWConf.InstsClassified", numInstsClassified, simd);
+        stats.SetI64("HWConf.InstsSkipped", numInstsSkipped, simd);
+        for (int rule = 0; rule < NUM_CONFORMITY_RULES; rule++)
+        {
+            stats.SetI64(std::string("HWConf.") + ruleNames[rule] + "Fixed", numRuleFixes[rule], simd);
+        }
+    }
+
+    if (kernel.getOption(vISA_OptReport))
+    {
+        std::ofstream optreport;
+        getOptReportStream(optreport, kernel.getOptions());
+        optreport << "===== HW Conformity =====" << std::endl;
+        optreport << "Number of instructions classified: " << numInstsClassified << std::endl;
+        optreport << "Number of instructions with no applicable rule: " << numInstsSkipped << std::endl;
+        for (int rule = 0; rule < NUM_CONFORMITY_RULES; rule++)
+        {
+            if (numRuleFixes[rule] > 0)
+            {
+                optreport << "    " << ruleNames[rule] << ": " << numRuleFixes[rule] << std::endl;
+            }
+        }
+        optreport << std::endl;
+        closeOptReportStream(optreport);
+    }
+}
+
 //
 // SIMD16 addc/subb are illegal on GEN, since they write to acc and there are only 8 acc
 // channels for D/UD type.  In vISA IR we should get something like
@@ -6337,6 +6685,8 @@ void HWConformity::chkHWConformity()
         verifyG4Kernel(kernel, Optimizer::PI_HWConformityChk, false);
 #endif
     }
+
+    reportRuleStats();
 }
 
 bool HWConformity::hasBadRegion( G4_INST *inst )
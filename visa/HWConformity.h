@@ -46,6 +46,47 @@ namespace vISA
         int numAccSubDef = 0;
         int numAccSubUse = 0;
 
+        // Per-instruction rules applied by conformBB(), in the order they are
+        // checked. classifyInst() computes the subset whose precondition holds
+        // for an instruction so that conformBB() only dispatches to those fixers.
+#define HW_CONFORMITY_RULES(DO) \
+        DO(SrcRegion)   \
+        DO(Mov)         \
+        DO(OpndType)    \
+        DO(SelCsel)     \
+        DO(PredCtrl)    \
+        DO(HFMathSplit) \
+        DO(ThreeSrc)    \
+        DO(Math)        \
+        DO(Mul)         \
+        DO(Mulh)        \
+        DO(IndirectOpnd)\
+        DO(Compare)     \
+        DO(Acc)         \
+        DO(DstHstride)  \
+        DO(Plane)       \
+        DO(Line)        \
+        DO(Rotate)      \
+        DO(VxHFloat64b) \
+        DO(Inst64b)     \
+        DO(Imm64)       \
+        DO(PackedHF)
+
+        enum ConformityRule
+        {
+#define DEFINE_CONFORMITY_RULE(name) RULE_##name,
+            HW_CONFORMITY_RULES(DEFINE_CONFORMITY_RULE)
+#undef DEFINE_CONFORMITY_RULE
+            NUM_CONFORMITY_RULES
+        };
+        static_assert(NUM_CONFORMITY_RULES <= 32, "rule set must fit in a uint32_t");
+
+        // number of times each rule changed an instruction in conformBB()
+        unsigned numRuleFixes[NUM_CONFORMITY_RULES] = {};
+        // number of instructions for which no rule applies
+        unsigned numInstsSkipped = 0;
+        unsigned numInstsClassified = 0;
+
 
         // This is added for data layout optimization.
         // Currently it only targets packed-byte pattern.
@@ -110,7 +151,9 @@ namespace vISA
         void fixDstHstride(INST_LIST_ITER i, int extypesize);
         void fixMADInst(G4_BB* bb);
         void fixSrcRegion(G4_INST *inst);
+        uint32_t classifyInst(G4_INST* inst) const;
         void conformBB(G4_BB* bb);
+        void reportRuleStats();
         void fixSADA2Inst(G4_BB* bb);
         void fixMixedHFInst(G4_BB* bb);
         void fixSendInst(G4_BB* bb);
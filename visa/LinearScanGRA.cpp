@@ -0,0 +1,329 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "BuildIR.h"
+#include "FlowGraph.h"
+#include "GraphColor.h"
+#include "PhyRegUsage.h"
+#include "Timer.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <vector>
+
+using namespace vISA;
+
+//
+// Fast-compile GRF allocation: a global linear scan over live intervals that
+// replaces interference graph construction and simplify/select coloring.
+//
+// Every candidate gets a single conservative interval [start, end] in lexical
+// instruction order, built from its references and the live-in/live-out sets
+// of the existing liveness. SIMD control flow is laid out lexically, so one
+// interval also covers the divergent regions that augmentation handles for
+// graph coloring. Intervals are inclusive at both ends, which keeps a dst away
+// from any src that dies at the same instruction and so subsumes the send and
+// dst/src overlap restrictions.
+//
+// Candidates are visited by increasing start and assigned with the same
+// PhyRegUsage first-fit search used by coloring, against the active intervals
+// and any overlapping pre-assigned range. When nothing fits, active ranges that
+// end after the current one are evicted furthest-end first (second chance for
+// the current range); otherwise the current range is spilled. Spilled ranges
+// are handed to SpillManagerGRF as usual, with spill-everywhere semantics.
+//
+bool GraphColor::linearScanRegAlloc(bool reserveSpillReg, unsigned& spillRegSize, unsigned& indrSpillRegSize)
+{
+    MUST_BE_TRUE(liveAnalysis.livenessClass(G4_GRF), "linear scan RA only handles GRF");
+
+    if (builder.getOption(vISA_RATrace))
+    {
+        std::cout << "\t--# variables: " << liveAnalysis.getNumSelectedVar() << "\n";
+        std::cout << "\t--linear scan\n";
+    }
+
+    unsigned reserveSpillSize = 0;
+    if (reserveSpillReg)
+    {
+        gra.determineSpillRegSize(spillRegSize, indrSpillRegSize);
+        reserveSpillSize = spillRegSize + indrSpillRegSize;
+        MUST_BE_TRUE(reserveSpillSize < kernel.getNumCalleeSaveRegs(), "Invalid reserveSpillSize in fail-safe RA!");
+        totalGRFRegCount -= reserveSpillSize;
+    }
+
+    gra.copyMissingAlignment();
+    createLiveRanges(reserveSpillSize);
+
+    std::vector<unsigned> fixedIds;
+    for (unsigned i = 0; i < numVar; i++)
+    {
+        if (lrs[i]->getVar()->getPhyReg())
+        {
+            lrs[i]->setPhyReg(lrs[i]->getVar()->getPhyReg(), lrs[i]->getVar()->getPhyRegOff());
+            fixedIds.push_back(i);
+        }
+    }
+
+    // no edges are computed; SpillManagerGRF only needs the matrix to exist
+    intf.init(mem);
+
+    startTimer(TIMER_COLORING);
+
+    //
+    // compute live intervals. Each BB gets an entry and an exit position around
+    // its instructions so that live-through ranges of empty BBs are kept.
+    //
+    std::vector<unsigned> start(numVar, UINT_MAX);
+    std::vector<unsigned> end(numVar, 0);
+    auto extend = [&start, &end](unsigned id, unsigned pos)
+    {
+        start[id] = std::min(start[id], pos);
+        end[id] = std::max(end[id], pos);
+    };
+    auto extendLiveSet = [&](const BitSet& live, unsigned pos)
+    {
+        for (unsigned elt = 0, numElts = (numVar + NUM_BITS_PER_ELT - 1) / NUM_BITS_PER_ELT; elt < numElts; elt++)
+        {
+            BITSET_ARRAY_TYPE bits = live.getElt(elt);
+            for (unsigned bit = 0; bits != 0; bit++, bits >>= 1)
+            {
+                if (bits & 1)
+                {
+                    extend(elt * NUM_BITS_PER_ELT + bit, pos);
+                }
+            }
+        }
+    };
+
+    bool considerLoops = kernel.getOption(vISA_ConsiderLoopInfoInRA);
+    unsigned numRegTotal = kernel.getNumRegTotal();
+    unsigned pos = 0;
+    BitSet live(numVar, false);
+    for (auto bb : kernel.fg)
+    {
+        unsigned refCount = GlobalRA::getRefCount(considerLoops ? bb->getNestLevel() : 0);
+
+        live = liveAnalysis.use_in[bb->getId()];
+        live &= liveAnalysis.def_in[bb->getId()];
+        extendLiveSet(live, pos++);
+
+        for (auto inst : *bb)
+        {
+            G4_DstRegRegion* dst = inst->getDst();
+            if (dst && dst->getBase()->isRegAllocPartaker())
+            {
+                unsigned id = dst->getBase()->asRegVar()->getId();
+                extend(id, pos);
+                if (!inst->isPseudoKill() && !inst->isLifeTimeEnd())
+                {
+                    lrs[id]->setRefCount(lrs[id]->getRefCount() + refCount);
+                }
+                //r127 must not be used for return address when there is a src and dest overlap in send instruction.
+                if ((inst->isSend() || inst->isFillIntrinsic()) && builder.needsToReserveR127() &&
+                    !dst->getBase()->asRegVar()->isPhyRegAssigned())
+                {
+                    lrs[id]->markForbidden(numRegTotal - 1, 1);
+                }
+            }
+
+            for (unsigned j = 0; j < G4_MAX_SRCS; j++)
+            {
+                G4_Operand* src = inst->getSrc(j);
+                if (!src || !src->isSrcRegRegion() || !src->asSrcRegRegion()->getBase()->isRegAllocPartaker())
+                {
+                    continue;
+                }
+                unsigned id = src->asSrcRegRegion()->getBase()->asRegVar()->getId();
+                extend(id, pos);
+                lrs[id]->setRefCount(lrs[id]->getRefCount() + refCount);
+                if (inst->isEOT())
+                {
+                    lrs[id]->setEOTSrc();
+                    if (builder.hasEOTGRFBinding())
+                    {
+                        lrs[id]->markForbidden(0, numRegTotal - 16);
+                    }
+                }
+                if (inst->isReturn())
+                {
+                    lrs[id]->setRetIp();
+                }
+            }
+            pos++;
+        }
+
+        live = liveAnalysis.use_out[bb->getId()];
+        live &= liveAnalysis.def_out[bb->getId()];
+        extendLiveSet(live, pos++);
+    }
+
+    //
+    // indirectly accessed and output ranges are kept live for the whole kernel;
+    // unreferenced ones still get a register, as they would with coloring
+    //
+    unsigned lastPos = pos == 0 ? 0 : pos - 1;
+    std::vector<unsigned> order;
+    order.reserve(numVar);
+    for (unsigned i = 0; i < numVar; i++)
+    {
+        G4_Declare* dcl = lrs[i]->getDcl();
+        if (liveAnalysis.isAddressSensitive(i) || dcl->isOutput())
+        {
+            start[i] = 0;
+            end[i] = lastPos;
+        }
+        else if (start[i] == UINT_MAX)
+        {
+            start[i] = end[i] = 0;
+        }
+        if (!lrs[i]->getIsPartialDcl())
+        {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&start](unsigned a, unsigned b)
+    {
+        return start[a] < start[b] || (start[a] == start[b] && a < b);
+    });
+
+    computeSpillCosts(false);
+    setSubRegAlignments();
+
+    //
+    // scan
+    //
+    unsigned startARFReg = 0, startFLAGReg = 0, startGRFReg = 0;
+    unsigned bank1_start = 0, bank1_end = 0;
+    unsigned bank2_start = totalGRFRegCount - 1, bank2_end = totalGRFRegCount - 1;
+    bool* availableGregs = (bool *)mem.alloc(sizeof(bool)* numRegTotal);
+    uint32_t* availableSubRegs = (uint32_t *)mem.alloc(sizeof(uint32_t)* numRegTotal);
+    bool* availableAddrs = (bool *)mem.alloc(sizeof(bool)* getNumAddrRegisters());
+    bool* availableFlags = (bool *)mem.alloc(sizeof(bool)* builder.getNumFlagRegisters());
+    uint8_t* weakEdgeUsage = (uint8_t*)mem.alloc(sizeof(uint8_t)* numRegTotal);
+    PhyRegUsageParms parms(gra, lrs, G4_GRF, totalGRFRegCount, startARFReg, startFLAGReg, startGRFReg,
+        bank1_start, bank1_end, bank2_start, bank2_end, false, availableGregs, availableSubRegs,
+        availableAddrs, availableFlags, weakEdgeUsage);
+
+    std::vector<unsigned> active;
+    auto isFixed = [this](unsigned id) { return lrs[id]->getVar()->getPhyReg() != nullptr; };
+    auto tryAssign = [&](unsigned id)
+    {
+        LiveRange* lr = lrs[id];
+        G4_Declare* dcl = lr->getDcl();
+        if (dcl->getNumRows() > numRegTotal)
+        {
+            return false;
+        }
+
+        PhyRegUsage regUsage(parms);
+        for (auto a : active)
+        {
+            regUsage.updateRegUsage(lrs[a]);
+        }
+        for (auto f : fixedIds)
+        {
+            if (start[f] <= end[id] && end[f] >= start[id])
+            {
+                regUsage.updateRegUsage(lrs[f]);
+            }
+        }
+
+        startGRFReg = lr->hasAllocHint() ? lr->getAllocHint() : 0;
+        BankAlign align = gra.isEvenAligned(dcl) ? BankAlign::Even : BankAlign::Either;
+        return regUsage.assignRegs(false, lr, lr->getForbidden(), align, gra.getSubRegAlign(dcl),
+            FIRST_FIT, lr->getSpillCost(), lr->hasAllocHint());
+    };
+
+    for (auto id : order)
+    {
+        LiveRange* lr = lrs[id];
+        if (lr->getVar()->isSpilled())
+        {
+            continue;
+        }
+
+        active.erase(std::remove_if(active.begin(), active.end(),
+            [&](unsigned a) { return end[a] < start[id]; }), active.end());
+
+        if (lr->getPhyReg())
+        {
+            // pre-assigned
+            active.push_back(id);
+            continue;
+        }
+
+        bool assigned = tryAssign(id);
+        while (!assigned)
+        {
+            // evict the spillable active range that ends furthest away
+            auto victim = active.end();
+            for (auto it = active.begin(), itEnd = active.end(); it != itEnd; ++it)
+            {
+                LiveRange* candidate = lrs[*it];
+                if (isFixed(*it) || candidate->getSpillCost() == MAXSPILLCOST ||
+                    kernel.fg.isPseudoDcl(candidate->getDcl()))
+                {
+                    continue;
+                }
+                if (victim == active.end() || end[*it] > end[*victim] ||
+                    (end[*it] == end[*victim] && candidate->getSpillCost() < lrs[*victim]->getSpillCost()))
+                {
+                    victim = it;
+                }
+            }
+
+            if (victim == active.end() ||
+                (lr->getSpillCost() != MAXSPILLCOST && end[*victim] <= end[id]))
+            {
+                if (!kernel.fg.isPseudoDcl(lr->getDcl()))
+                {
+                    spilledLRs.push_back(lr);
+                }
+                break;
+            }
+
+            lrs[*victim]->resetPhyReg();
+            spilledLRs.push_back(lrs[*victim]);
+            active.erase(victim);
+            assigned = tryAssign(id);
+        }
+
+        if (assigned)
+        {
+            active.push_back(id);
+        }
+    }
+
+    kernel.setRAType(RA_Type::LINEAR_SCAN_RA);
+
+    if (builder.getOption(vISA_RATrace))
+    {
+        std::cout << "\t--# intervals: " << order.size() << ", spilled: " << spilledLRs.size() << "\n";
+    }
+
+    stopTimer(TIMER_COLORING);
+    return !requireSpillCode();
+}
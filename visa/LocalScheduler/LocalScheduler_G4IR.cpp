@@ -31,6 +31,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Dependencies_G4IR.h"
 #include "../G4_Opcode.h"
 #include "../Timer.h"
+#include "../ParallelBB.h"
 #include "visa_wa.h"
 #include <queue>
 
@@ -51,6 +52,12 @@ void LocalScheduler::localScheduling()
     const Options *m_options = fg.builder->getOptions();
     LatencyTable LT(fg.builder);
 
+    // BBs scheduled as a whole, with the bbInfo slot each one fills in. These
+    // only touch their own BB and a BB-local Mem_Manager, so they may be
+    // scheduled in parallel; windowed BBs create temporary BBs in fg and are
+    // always handled here on the calling thread.
+    std::vector<std::pair<G4_BB*, int>> wholeBBs;
+
     for (; ib != bend; ++ib)
     {
         unsigned instCountBefore = (uint32_t)(*ib)->size();
@@ -60,10 +67,10 @@ void LocalScheduler::localScheduling()
             continue;
         }
 
-        Mem_Manager bbMem(4096);
         unsigned schedulerWindowSize = m_options->getuInt32Option(vISA_SchedulerWindowSize);
         if (schedulerWindowSize > 0 && instCountBefore > schedulerWindowSize)
         {
+            Mem_Manager bbMem(4096);
             // If BB has a lot of instructions then when recursively
             // traversing DAG in list scheduler, stack overflow occurs.
             // So artificially breakup inst list here to reduce size
@@ -100,15 +107,32 @@ void LocalScheduler::localScheduling()
         }
         else
         {
-            G4_BB_Schedule schedule(fg.getKernel(), bbMem, *ib, LT);
-            bbInfo[i].id = (*ib)->getId();
-            bbInfo[i].staticCycle = schedule.sequentialCycle;
-            bbInfo[i].sendStallCycle = schedule.sendStallCycle;
-            bbInfo[i].loopNestLevel = (*ib)->getNestLevel();
+            wholeBBs.push_back(std::make_pair(*ib, i));
         }
 
         i++;
     }
+
+    // thread start-up is not worth it for a handful of BBs
+    static const unsigned parallelSchThreshold = 16;
+    unsigned numThreads = 1;
+    if (m_options->getOption(vISA_ParallelLocalPasses) && wholeBBs.size() >= parallelSchThreshold)
+    {
+        numThreads = getLocalPassThreads(m_options->getuInt32Option(vISA_LocalPassThreads));
+    }
+
+    parallelFor(wholeBBs.size(), numThreads, [&](size_t n)
+    {
+        G4_BB* bb = wholeBBs[n].first;
+        VISA_BB_INFO& info = bbInfo[wholeBBs[n].second];
+        Mem_Manager bbMem(4096);
+        G4_BB_Schedule schedule(fg.getKernel(), bbMem, bb, LT);
+        info.id = bb->getId();
+        info.staticCycle = schedule.sequentialCycle;
+        info.sendStallCycle = schedule.sendStallCycle;
+        info.loopNestLevel = bb->getNestLevel();
+    });
+
     FINALIZER_INFO* jitInfo = fg.builder->getJitInfo();
     jitInfo->BBInfo = bbInfo;
     jitInfo->BBNum = i;
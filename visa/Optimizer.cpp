@@ -29,10 +29,12 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sstream>
 #include "G4_Opcode.h"
 #include "Timer.h"
+#include "CompileTrace.h"
 #include "G4Verifier.h"
 #include <map>
 #include <algorithm>
 #include "LVN.h"
+#include "GVN.h"
 #include "ifcvt.h"
 #include <random>
 #include <chrono>
@@ -78,6 +80,30 @@ void Optimizer::LVN()
     }
 }
 
+void Optimizer::GVN()
+{
+    // Global value numbering over the dominator tree. This catches the
+    // address computations and constant loads that LVN misses because
+    // they are repeated in different BBs.
+    ::GVN gvn(kernel, builder);
+    gvn.doGVN();
+
+    if (kernel.getOption(vISA_OptReport))
+    {
+        std::ofstream optreport;
+        getOptReportStream(optreport, kernel.getOptions());
+        optreport << "===== GVN =====" << std::endl;
+        optreport << "Number of instructions removed: " << gvn.getNumInstsRemoved() << std::endl;
+        optreport << "Number of instructions removed across BBs: " << gvn.getNumCrossBBInstsRemoved() << std::endl << std::endl;
+        closeOptReportStream(optreport);
+    }
+
+    if (builder.getOption(vISA_DumpCompilerStats))
+    {
+        builder.getcompilerStats().SetI64("GVNInstsRemoved", gvn.getNumInstsRemoved(), kernel.getSimdSize());
+    }
+}
+
 // helper functions
 
 static int getDstSubReg( G4_DstRegRegion *dst )
@@ -225,100 +251,100 @@ void Optimizer::regAlloc()
     }
 }
 
-void Optimizer::countBankConflicts()
+// Return the GRF read by a source operand after RA, or -1 if the operand is not
+// a directly addressed GRF region.
+static int getSrcGRFNum(G4_Operand* opnd)
 {
-    std::list<G4_INST*> conflicts;
-    unsigned int numLocals = 0, numGlobals = 0;
-    bool isSKLPlus = ( getGenxPlatform() >= GENX_SKL ? true : false );
-
-    for (auto curBB : kernel.fg)
+    if (opnd == nullptr || !opnd->isSrcRegRegion() ||
+        opnd->asSrcRegRegion()->getRegAccess() != Direct ||
+        !opnd->getBase()->isRegVar())
     {
-        for(INST_LIST_ITER inst_it = curBB->begin();
-            inst_it != curBB->end();
-            inst_it++)
-        {
-            G4_INST* curInst = (*inst_it);
-            G4_Operand* src0 = curInst->getSrc(0);
-            G4_Operand* src1 = curInst->getSrc(1);
-            G4_Operand* src2 = curInst->getSrc(2);
-
-            if( ( isSKLPlus && src0 == NULL ) || src1 == NULL || src2 == NULL)
-                continue;
+        return -1;
+    }
+    G4_VarBase* phyReg = opnd->getBase()->asRegVar()->getPhyReg();
+    if (phyReg == nullptr || !phyReg->isGreg())
+    {
+        return -1;
+    }
+    return phyReg->asGreg()->getRegNum() + opnd->asSrcRegRegion()->getRegOff();
+}
 
-            if( ( isSKLPlus && !src0->isSrcRegRegion() ) || !src1->isSrcRegRegion() || !src2->isSrcRegRegion())
-                continue;
+// Read port partition of a GRF: even/odd bank in the lower or upper half.
+static unsigned getGRFPartition(int grf)
+{
+    return (grf < 64 ? 0 : 2) + (grf % 2);
+}
 
-            if( (isSKLPlus && !src0->asSrcRegRegion()->getBase()->asRegVar()->getPhyReg()->isGreg()) ||
-                !src1->asSrcRegRegion()->getBase()->asRegVar()->getPhyReg()->isGreg() ||
-                !src1->asSrcRegRegion()->getBase()->asRegVar()->getPhyReg()->isGreg())
-                continue;
+// Check if a 3-source instruction reads all of its GRF sources from the same
+// partition.
+static bool isInternalBankConflict(G4_INST* inst, bool isSKLPlus)
+{
+    int src0grf = getSrcGRFNum(inst->getSrc(0));
+    int src1grf = getSrcGRFNum(inst->getSrc(1));
+    int src2grf = getSrcGRFNum(inst->getSrc(2));
 
-            // We have a 3 src instruction with each src operand a GRF register region
-            unsigned int src0grf = 0, src1grf = 0, src2grf = 0;
+    if ((isSKLPlus && src0grf < 0) || src1grf < 0 || src2grf < 0)
+        return false;
 
-            if( isSKLPlus )
-            {
-                src0grf = src0->getBase()->asRegVar()->getPhyReg()->asGreg()->getRegNum() +
-                    src0->asSrcRegRegion()->getRegOff();
-            }
-            src1grf = src1->getBase()->asRegVar()->getPhyReg()->asGreg()->getRegNum() +
-                src1->asSrcRegRegion()->getRegOff();
-            src2grf = src2->getBase()->asRegVar()->getPhyReg()->asGreg()->getRegNum() +
-                src2->asSrcRegRegion()->getRegOff();
+    if (inst->getExecSize() == 16)
+        return true;
 
-            bool isConflict = false;
+    return (!isSKLPlus || getGRFPartition(src0grf) == getGRFPartition(src1grf)) &&
+        getGRFPartition(src1grf) == getGRFPartition(src2grf);
+}
 
-            unsigned int src0partition = 0, src1partition = 0, src2partition = 0;
+// Check if src0 of a 3-source instruction conflicts with src1/src2 of the
+// instruction before it. This is the model BankConflictPass::setupBankForSrc0
+// steers RA with on platforms with cross-instruction conflicts.
+static bool isCrossInstBankConflict(G4_INST* prevInst, G4_INST* inst)
+{
+    if (prevInst->isSend() || prevInst->isMath() ||
+        inst->getNumSrc() != 3 || inst->isSend())
+    {
+        return false;
+    }
 
-            if( isSKLPlus )
-            {
-                if(src0grf < 64)
-                {
-                    src0partition = 1;
-                    if(src0grf%2 == 0)
-                        src0partition = 0;
-                }
-                else
-                {
-                    src0partition = 3;
-                    if(src0grf%2 == 0)
-                        src0partition = 2;
-                }
-            }
+    int src0grf = getSrcGRFNum(inst->getSrc(0));
+    if (src0grf < 0)
+    {
+        return false;
+    }
 
-            if(src1grf < 64)
-            {
-                src1partition = 1;
-                if(src1grf%2 == 0)
-                    src1partition = 0;
-            }
-            else
-            {
-                src1partition = 3;
-                if(src1grf%2 == 0)
-                    src1partition = 2;
-            }
+    int prevBank[3];
+    for (int i = 1; i < 3; i++)
+    {
+        G4_Operand* src = prevInst->getSrc(i);
+        int grf = getSrcGRFNum(src);
+        if (grf < 0)
+        {
+            return false;
+        }
+        prevBank[i] = grf % 2;
+        // a two-GRF operand finishes its read in the other bank
+        if (src->getLinearizedEnd() - src->getLinearizedStart() + 1 > 32)
+        {
+            prevBank[i] ^= 1;
+        }
+    }
 
-            if(src2grf < 64)
-            {
-                src2partition = 1;
-                if(src2grf%2 == 0)
-                    src2partition = 0;
-            }
-            else
-            {
-                src2partition = 3;
-                if(src2grf%2 == 0)
-                    src2partition = 2;
-            }
+    return prevBank[1] == prevBank[2] && prevBank[1] == src0grf % 2;
+}
 
-            if( ( !isSKLPlus || src0partition == src1partition ) && src1partition == src2partition)
-                isConflict = true;
+void Optimizer::countBankConflicts()
+{
+    std::list<G4_INST*> conflicts;
+    unsigned int numLocals = 0, numGlobals = 0;
+    bool isSKLPlus = ( getGenxPlatform() >= GENX_SKL ? true : false );
 
-            if(curInst->getExecSize() == 16)
-                isConflict = true;
+    for (auto curBB : kernel.fg)
+    {
+        for(INST_LIST_ITER inst_it = curBB->begin();
+            inst_it != curBB->end();
+            inst_it++)
+        {
+            G4_INST* curInst = (*inst_it);
 
-            if(isConflict == true)
+            if(isInternalBankConflict(curInst, isSKLPlus))
             {
                 conflicts.push_back(curInst);
                 numBankConflicts++;
@@ -378,6 +404,128 @@ void Optimizer::countBankConflicts()
     }
 }
 
+// Check if two adjacent instructions can trade places after RA. Accesses to
+// cr0/sr0/n0/tm0/tdr and atomics are barriers, as in the local scheduler:
+// their dependencies, e.g. of a mad on the cr0 rounding mode, are implicit.
+bool Optimizer::canSwapAdjacentInsts(G4_INST* first, G4_INST* second)
+{
+    auto isMovable = [](G4_INST* inst)
+    {
+        return !inst->isLabel() && !inst->isFlowControl() && !inst->isSend() &&
+            !inst->isIntrinsic() && !inst->isWait() && !inst->isYieldInst() &&
+            inst->opcode() != G4_nop && !inst->isSWSBSync() &&
+            !inst->isOptBarrier() && !inst->isAtomicInst() &&
+            !inst->hasACCOpnd() && !inst->getImplAccSrc() && !inst->getImplAccDst() &&
+            inst->getDst() && inst->getDst()->getRegAccess() == Direct;
+    };
+
+    return isMovable(first) && isMovable(second) &&
+        !second->isRAWdep(first) && !second->isWARdep(first) && !second->isWAWdep(first);
+}
+
+// Post-RA bank conflict reduction. On platforms where src0 of a 3-source
+// instruction competes with src1/src2 of the previous instruction, swap a
+// conflicting 3-source instruction with an independent successor whenever that
+// lowers the conflict count of the affected window. Internal conflicts depend
+// only on the registers RA picked, and src1/src2 of mad enter the model
+// symmetrically, so operand swaps cannot improve them here.
+void Optimizer::reduceBankConflicts()
+{
+    bool isSKLPlus = getGenxPlatform() >= GENX_SKL;
+    bool doReorder = builder.hasCrossInstructionConflict() && !builder.lowHighBundle() &&
+        GetStepping() == Step_A;
+    bool reportConflicts = builder.getOption(vISA_DumpCompilerStats) || builder.getOption(vISA_OptReport);
+
+    // Without reordering the conflicts are only counted for the reports.
+    if (!doReorder && !reportConflicts)
+    {
+        return;
+    }
+
+    auto countConflicts = [&]()
+    {
+        unsigned int numConflicts = 0;
+        for (auto bb : kernel.fg)
+        {
+            G4_INST* prevInst = nullptr;
+            for (auto inst : *bb)
+            {
+                if (isInternalBankConflict(inst, isSKLPlus))
+                    numConflicts++;
+                if (doReorder && prevInst && isCrossInstBankConflict(prevInst, inst))
+                    numConflicts++;
+                prevInst = inst;
+            }
+        }
+        return numConflicts;
+    };
+
+    unsigned int numBefore = countConflicts();
+    unsigned int numSwaps = 0;
+
+    if (doReorder && numBefore > 0)
+    {
+        auto crossCost = [](G4_INST* a, G4_INST* b)
+        {
+            return (a && b && isCrossInstBankConflict(a, b)) ? 1 : 0;
+        };
+
+        for (auto bb : kernel.fg)
+        {
+            if (bb->size() < 3)
+                continue;
+
+            for (INST_LIST_ITER it = std::next(bb->begin()), end = bb->end(); it != end; ++it)
+            {
+                INST_LIST_ITER nextIt = std::next(it);
+                if (nextIt == end)
+                    break;
+
+                G4_INST* prevInst = *std::prev(it);
+                G4_INST* inst = *it;
+                G4_INST* nextInst = *nextIt;
+                if (!isCrossInstBankConflict(prevInst, inst) ||
+                    !canSwapAdjacentInsts(inst, nextInst))
+                {
+                    continue;
+                }
+
+                INST_LIST_ITER afterIt = std::next(nextIt);
+                G4_INST* afterInst = afterIt != end ? *afterIt : nullptr;
+                int oldCost = crossCost(prevInst, inst) + crossCost(inst, nextInst) + crossCost(nextInst, afterInst);
+                int newCost = crossCost(prevInst, nextInst) + crossCost(nextInst, inst) + crossCost(inst, afterInst);
+                if (newCost < oldCost)
+                {
+                    // keep 'it' on the instruction now in this slot
+                    bb->erase(nextIt);
+                    it = bb->insert(it, nextInst);
+                    numSwaps++;
+                }
+            }
+        }
+    }
+
+    unsigned int numAfter = numSwaps ? countConflicts() : numBefore;
+
+    if (builder.getOption(vISA_DumpCompilerStats))
+    {
+        CompilerStats &stats = builder.getcompilerStats();
+        int simd = kernel.getSimdSize();
+        stats.SetI64("BankConflictsBefore", numBefore, simd);
+        stats.SetI64("BankConflictsAfter", numAfter, simd);
+    }
+
+    if (builder.getOption(vISA_OptReport) && numBefore > 0)
+    {
+        std::ofstream optreport;
+        getOptReportStream(optreport, builder.getOptions());
+        optreport << std::endl << "===== Bank conflict reduction =====" << std::endl;
+        optreport << "Kernel " << kernel.getName() << ": " << numBefore << " -> " << numAfter <<
+            " conflicts (" << numSwaps << " instructions reordered)" << std::endl;
+        closeOptReportStream(optreport);
+    }
+}
+
 void Optimizer::insertDummyCompactInst()
 {
     // Only for SKL+ and compaction is enabled.
@@ -502,6 +650,16 @@ void Optimizer::removeLifetimeOps()
     }
 }
 
+size_t Optimizer::countInsts() const
+{
+    size_t numInsts = 0;
+    for (auto bb : kernel.fg)
+    {
+        numInsts += bb->size();
+    }
+    return numInsts;
+}
+
 void Optimizer::runPass(PassIndex Index)
 {
     const PassInfo &PI = Passes[Index];
@@ -515,14 +673,43 @@ void Optimizer::runPass(PassIndex Index)
     if (builder.getOption(vISA_DumpDotAll))
         kernel.dumpDotFile(("before." + Name).c_str());
 
-    if (PI.Timer != TIMER_NUM_TIMERS)
-        startTimer(PI.Timer);
+    // Record IR size and arena growth around the pass.
+    bool collectPassStats = builder.getOption(vISA_DumpCompilerStats);
+    size_t instBefore = 0, dclBefore = 0, arenaBefore = 0;
+    if (collectPassStats)
+    {
+        instBefore = countInsts();
+        dclBefore = kernel.Declares.size();
+        arenaBefore = ArenaStats::liveBytes();
+        ArenaStats::resetPeak();
+    }
 
-    // Execute pass.
-    (this->*(PI.Pass))();
+    {
+        // startTimer()/stopTimer() already trace passes that have a timer;
+        // trace only the others here so each pass is recorded once.
+        CompileTrace::Scope tracePass("vISA", PI.Timer == TIMER_NUM_TIMERS ? PI.Name : nullptr);
+
+        if (PI.Timer != TIMER_NUM_TIMERS)
+            startTimer(PI.Timer);
 
-    if (PI.Timer != TIMER_NUM_TIMERS)
-        stopTimer(PI.Timer);
+        // Execute pass.
+        (this->*(PI.Pass))();
+
+        if (PI.Timer != TIMER_NUM_TIMERS)
+            stopTimer(PI.Timer);
+    }
+
+    if (collectPassStats)
+    {
+        CompilerStats &stats = builder.getcompilerStats();
+        int simd = kernel.getSimdSize();
+        stats.SetI64(Name + ".InstBefore", instBefore, simd);
+        stats.SetI64(Name + ".InstAfter", countInsts(), simd);
+        stats.SetI64(Name + ".DclBefore", dclBefore, simd);
+        stats.SetI64(Name + ".DclAfter", kernel.Declares.size(), simd);
+        stats.MaxI64(Name + ".ArenaPeak", ArenaStats::peakBytes() - arenaBefore, simd);
+        stats.MaxI64("ArenaPeakBytes", ArenaStats::peakBytes(), simd);
+    }
 
     if (builder.getOption(vISA_DumpDotAll))
         kernel.dumpDotFile(("after." + Name).c_str());
@@ -563,6 +750,7 @@ void Optimizer::initOptimizations()
     INITIALIZE_PASS(regAlloc,                vISA_EnableAlways,            TIMER_TOTAL_RA);
     INITIALIZE_PASS(removeLifetimeOps,       vISA_EnableAlways,            TIMER_MISC_OPTS);
     INITIALIZE_PASS(countBankConflicts,      vISA_OptReport,               TIMER_MISC_OPTS);
+    INITIALIZE_PASS(reduceBankConflicts,     vISA_ReduceBankConflicts,     TIMER_MISC_OPTS);
     INITIALIZE_PASS(removeRedundMov,         vISA_EnableAlways,            TIMER_MISC_OPTS);
     INITIALIZE_PASS(removeEmptyBlocks,       vISA_EnableAlways,            TIMER_MISC_OPTS);
     INITIALIZE_PASS(insertFallThroughJump,   vISA_EnableAlways,            TIMER_MISC_OPTS);
@@ -580,6 +768,7 @@ void Optimizer::initOptimizations()
     INITIALIZE_PASS(mergeScalarInst,         vISA_MergeScalar,             TIMER_OPTIMIZER);
     INITIALIZE_PASS(lowerMadSequence,        vISA_EnableMACOpt,            TIMER_OPTIMIZER);
     INITIALIZE_PASS(LVN,                     vISA_LVN,                     TIMER_OPTIMIZER);
+    INITIALIZE_PASS(GVN,                     vISA_GVN,                     TIMER_OPTIMIZER);
     INITIALIZE_PASS(ifCvt,                   vISA_ifCvt,                   TIMER_OPTIMIZER);
     INITIALIZE_PASS(dumpPayload,             vISA_dumpPayload,             TIMER_MISC_OPTS);
     INITIALIZE_PASS(normalizeRegion,         vISA_EnableAlways,            TIMER_MISC_OPTS);
@@ -1096,6 +1285,9 @@ int Optimizer::optimization()
     // Local Value Numbering
     runPass(PI_LVN);
 
+    // Global Value Numbering
+    runPass(PI_GVN);
+
     runPass(PI_split4GRFVars);
 
     runPass(PI_insertFenceBeforeEOT);
@@ -1155,6 +1347,9 @@ int Optimizer::optimization()
 
     runPass(PI_localSchedule);
 
+    // Post-RA bank conflict reduction, after scheduling so it is not undone
+    runPass(PI_reduceBankConflicts);
+
     runPass(PI_accSubPostSchedule);
 
     runPass(PI_changeMoveType);
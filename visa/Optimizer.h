@@ -192,6 +192,8 @@ class Optimizer
 
     void LVN();
 
+    void GVN();
+
     void ifCvt();
 
     void ifCvtFCCall();
@@ -229,6 +231,7 @@ private:
 
     void countBankConflicts();
     unsigned int numBankConflicts;
+    void reduceBankConflicts();
 
     bool chkFwdOutputHazard(INST_LIST_ITER &, INST_LIST_ITER&);
     bool chkFwdOutputHazard(G4_INST*, INST_LIST_ITER);
@@ -326,6 +329,7 @@ public:
         PI_FoldAddrImmediate,
         PI_chkRegBoundary,
         PI_localSchedule,
+        PI_reduceBankConflicts,
         PI_HWWorkaround,               // always
         PI_NoSrcDepSet,                // always
         PI_insertInstLabels,           // always
@@ -334,6 +338,7 @@ public:
         PI_mergeScalarInst,
         PI_lowerMadSequence,
         PI_LVN,
+        PI_GVN,
         PI_ifCvt,
         PI_normalizeRegion,            // always
         PI_dumpPayload,
@@ -370,6 +375,9 @@ private:
     /// Common interface to execute a pass.
     void runPass(PassIndex Index);
 
+    /// Total number of instructions in the kernel, used for per-pass stats.
+    size_t countInsts() const;
+
     bool isCopyPropProfitable(G4_INST* movInst) const;
 
 public:
@@ -381,6 +389,8 @@ public:
     }
     int optimization();
 
+    /// Check if two adjacent instructions can trade places after RA.
+    static bool canSwapAdjacentInsts(G4_INST* first, G4_INST* second);
 };
 
 }
@@ -0,0 +1,96 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#ifndef _PARALLEL_BB_H_
+#define _PARALLEL_BB_H_
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace vISA
+{
+    //
+    // Runs func(i) for every i in [0, numItems) on up to numThreads threads,
+    // the calling thread included. Items are handed out in order through a
+    // shared counter. func must only touch state owned by item i (typically a
+    // single BB and its own Mem_Manager) so that the result does not depend on
+    // the number of threads or on how items end up being interleaved.
+    //
+    // Passes that allocate through the IR_Builder (declares, operands, new
+    // instructions) must not use this: the builder's Mem_Manager and ID
+    // counters are shared by the whole kernel.
+    //
+    template <typename Func>
+    void parallelFor(size_t numItems, unsigned numThreads, Func func)
+    {
+        if (numThreads <= 1 || numItems <= 1)
+        {
+            for (size_t i = 0; i < numItems; i++)
+            {
+                func(i);
+            }
+            return;
+        }
+
+        numThreads = (unsigned) std::min<size_t>(numThreads, numItems);
+        std::atomic<size_t> nextItem(0);
+        auto worker = [&]()
+        {
+            for (size_t i = nextItem++; i < numItems; i = nextItem++)
+            {
+                func(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads - 1);
+        for (unsigned t = 1; t < numThreads; t++)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    // Number of threads to use for BB-local passes given the -localPassThreads
+    // option value; 0 means one per hardware thread.
+    inline unsigned getLocalPassThreads(unsigned optionValue)
+    {
+        if (optionValue == 0)
+        {
+            unsigned hwThreads = std::thread::hardware_concurrency();
+            return hwThreads == 0 ? 1 : hwThreads;
+        }
+        return optionValue;
+    }
+}
+
+#endif // _PARALLEL_BB_H_
@@ -2794,6 +2794,22 @@ bool LivenessAnalysis::isLiveAtExit(G4_BB* bb, unsigned var_id) const
     return use_out[bb->getId()].isSet( var_id ) && def_out[bb->getId()].isSet( var_id );
 }
 
+//
+// return the number of bytes held by the data flow bitsets
+//
+size_t LivenessAnalysis::getBitsetSizeInBytes() const
+{
+    size_t numBits = 0;
+    for (auto sets : { &def_in, &def_out, &use_in, &use_out, &use_gen, &use_kill, &indr_use, &maydef })
+    {
+        for (auto &bs : *sets)
+        {
+            numBits += bs.getSize();
+        }
+    }
+    return (numBits + 7) / 8;
+}
+
 
 void GlobalRA::markBlockLocalVar(G4_RegVar* var, unsigned bbId)
 {
@@ -3694,6 +3710,10 @@ static void recordRAStats(IR_Builder& builder,
         case RA_Type::GRAPH_COLORING_SPILL_FF_BC_RA:
             Stats.SetFlag("IsGlobalRA", SimdSize);
             break;
+        case RA_Type::LINEAR_SCAN_RA:
+        case RA_Type::LINEAR_SCAN_SPILL_RA:
+            Stats.SetFlag("IsLinearScanRA", SimdSize);
+            break;
         case RA_Type::UNKNOWN_RA:
             break;
         default:
@@ -478,6 +478,7 @@ public:
     unsigned getNumSplitVar() const {return numSplitVar;}
     unsigned getNumSplitStartID() const {return numSplitStartID;}
     unsigned getNumUnassignedVar() const {return numUnassignedVarId;}
+    size_t getBitsetSizeInBytes() const;
     void dump() const;
 
     bool writeWholeRegion(G4_BB* bb, G4_INST* prd, G4_DstRegRegion* dst, const Options *opt) const;
@@ -47,7 +47,7 @@ namespace vISA
         std::set<G4_Declare*> addrTakenSpillFillDcl;
         RPE& rpe;
 
-        // Set window size to coalesce
+        // Set window size to coalesce (-spillCoalesceWindow)
         const unsigned int cWindowSize = 10;
         const unsigned int cMaxFillPayloadSize = 4;
         const unsigned int cMaxSpillPayloadSize = 4;
@@ -104,7 +104,9 @@ namespace vISA
     public:
         CoalesceSpillFills(G4_Kernel& k, LivenessAnalysis& l, GraphColor& g,
             SpillManagerGRF& s, unsigned int iterationNo, RPE& r, GlobalRA& gr) :
-            kernel(k), liveness(l), graphColor(g), gra(gr), spill(s), rpe(r)
+            kernel(k), liveness(l), graphColor(g), gra(gr), spill(s), rpe(r),
+            cWindowSize(std::max(4u, k.getOptions()->getuInt32Option(vISA_SpillCoalesceWindow))),
+            cSpillFillCleanupWindowSize(cWindowSize)
         {
             unsigned int numGRFs = k.getNumRegTotal();
             auto scale = [=](unsigned threshold) -> unsigned {
@@ -32,6 +32,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "BuildIR.h"
 #include "DebugInfo.h"
 
+#include <algorithm>
 #include <math.h>
 #include <sstream>
 #include <fstream>
@@ -148,6 +149,7 @@ SpillManagerGRF::SpillManagerGRF(
     , prevIntfEdges_(prevIntfEdges)
     , spilledLRs_(spilledLRs)
     , nextSpillOffset_(spillAreaOffset)
+    , uncompressedSpillSize_(0)
     , iterationNo_(iterationNo)
     , bbId_(UINT_MAX)
     , inSIMDCFContext_(false)
@@ -226,6 +228,46 @@ SpillManagerGRF::computeSpillIntf (
     }
 }
 
+// Assign scratch slots to the ranges spilled in this iteration before any
+// spill code is inserted. With spill space compression the slots are colored
+// largest range first against the spilled-range interference graph, so that
+// big ranges get packed at low offsets and smaller ones fill the holes left
+// between non-overlapping ranges. Without compression the slots are handed
+// out lazily in program order as before.
+
+void
+SpillManagerGRF::assignSpillSlots (
+)
+{
+    std::vector<G4_RegVar*> newSlots;
+    for (auto lr : spilledLRs_)
+    {
+        G4_RegVar* regVar = lr->getVar();
+        if (!regVar->isSpilled() || regVar->isRegVarTransient() ||
+            regVar->getDisp() != UINT_MAX)
+        {
+            continue;
+        }
+        uncompressedSpillSize_ += ROUND(getByteSize(regVar), G4_GRF_REG_NBYTES);
+        newSlots.push_back(regVar);
+    }
+
+    if (!doSpillSpaceCompression)
+    {
+        return;
+    }
+
+    std::stable_sort(newSlots.begin(), newSlots.end(),
+        [this](G4_RegVar* a, G4_RegVar* b)
+    {
+        return getByteSize(a) > getByteSize(b);
+    });
+    for (auto regVar : newSlots)
+    {
+        regVar->setDisp(calculateSpillDisp(regVar));
+    }
+}
+
 // Get the base regvar for the source or destination region.
 
 template <class REGION_TYPE>
@@ -532,12 +574,15 @@ SpillManagerGRF::calculateSpillDisp (
 
     for (unsigned i = 0; i < varIdCount_; i++) {
 
+        // Only ranges that already own a slot can block one, so check that
+        // before the (much more expensive) interference query.
+        G4_RegVar * intfRegVar = getRegVar (i);
+        if (intfRegVar->isRegVarTransient ()) continue;
+        unsigned iDisp = intfRegVar->getDisp ();
+        if (iDisp == UINT_MAX) continue;
+
         if (spillMemLifetimeInterfere (lrId, i)) {
-            G4_RegVar * intfRegVar = getRegVar (i);
-            assert (getRegVar (i)->isAliased () == false);
-            if (intfRegVar->isRegVarTransient ()) continue;
-            unsigned iDisp = intfRegVar->getDisp ();
-            if (iDisp == UINT_MAX) continue;
+            assert (intfRegVar->isAliased () == false);
             LocList::iterator loc;
             for (loc = locList.begin ();
                  loc != locList.end () && (*loc)->getDisp () < iDisp;
@@ -3625,6 +3670,8 @@ SpillManagerGRF::insertSpillFillCode (
         return false;
     }
 
+    assignSpillSlots();
+
     // Insert spill/fill code for all basic blocks.
 
     FlowGraph& fg = kernel->fg;
@@ -108,6 +108,9 @@ public:
     // private variables placed by IGC (marked by spill_mem_offset)
     // this should only be called after insertSpillFillCode()
     uint32_t getNextOffset() const { return nextSpillOffset_; }
+    // return the scratch bytes the ranges spilled in this iteration would have
+    // taken had each of them been given its own GRF-aligned slot.
+    uint32_t getUncompressedSpillSize() const { return uncompressedSpillSize_; }
     // return the cumulative scratch space offset for the next spilled variable.
     // This adjusts for scratch space reserved for file scope vars and IGC/GT-pin
     uint32_t getNextScratchOffset() const
@@ -141,6 +144,10 @@ private:
     computeSpillIntf (
     );
 
+    void
+    assignSpillSlots (
+    );
+
     unsigned
     getMaxExecSize (
         G4_Operand * operand
@@ -743,6 +750,7 @@ private:
     unsigned *               msgSpillRangeCount_;
     unsigned *               msgFillRangeCount_;
     unsigned                 nextSpillOffset_;
+    unsigned                 uncompressedSpillSize_;
     unsigned                 iterationNo_;
     unsigned                 bbId_;
     unsigned                 spillAreaOffset_;
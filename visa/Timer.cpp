@@ -26,6 +26,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "Option.h"
 #include "Timer.h"
+#include "CompileTrace.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -151,6 +152,19 @@ void resetPerKernel()
 void setKernelName(const char *name)
 {
     SNPRINTF(kernelAsmName, 256, "%s", name);
+    CompileTrace::setKernel(name);
+}
+
+// Timer names are indented for the jit_time.txt report; trace spans nest on
+// their own.
+static const char* traceName(int timer)
+{
+    const char* name = timerNames[timer];
+    while (*name == '\t' || *name == ' ')
+    {
+        name++;
+    }
+    return name;
 }
 
 int createNewTimer(const char* name)
@@ -161,6 +175,10 @@ int createNewTimer(const char* name)
 
 void startTimer(int timer)
 {
+    if (CompileTrace::isEnabled() && timer < TIMER_NUM_TIMERS)
+    {
+        CompileTrace::begin("vISA", traceName(timer));
+    }
 #ifdef MEASURE_COMPILATION_TIME
     if (timer < TIMER_NUM_TIMERS)
     {
@@ -192,6 +210,10 @@ void startTimer(int timer)
 
 void stopTimer(int timer)
 {
+    if (CompileTrace::isEnabled() && timer < TIMER_NUM_TIMERS)
+    {
+        CompileTrace::end(traceName(timer));
+    }
 #ifdef MEASURE_COMPILATION_TIME
     if (timer < TIMER_NUM_TIMERS)
     {
@@ -26,6 +26,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #ifndef VISA_KERNEL_H
 #define VISA_KERNEL_H
+#include <unordered_map>
+
 #include "VISABuilderAPIDefinition.h"
 #include "DebugInfo.h"
 #include "visa_wa.h"
@@ -128,6 +130,13 @@ public:
 
         // Initialize first level scope of the map
         m_GenNamedVarMap.push_back(GenDeclNameToVarMap());
+
+        m_inlineAsmMode = false;
+        m_defaultNamedVarCount = 0;
+        m_defaultNamedAddrCount = 0;
+        m_defaultNamedPredCount = 0;
+        m_defaultNamedSurfaceCount = 0;
+        m_defaultNamedSamplerCount = 0;
     }
 
     void* alloc(size_t sz) { return m_mem.alloc(sz); }
@@ -219,6 +228,8 @@ public:
     bool setNameIndexMap(const std::string &name, CISA_GEN_VAR *, bool unique = false);
     void pushIndexMapScopeLevel();
     void popIndexMapScopeLevel();
+    void beginInlineAsm();
+    void endInlineAsm();
 
     unsigned int getIndexFromLabelName(const std::string &label_name);
     VISA_LabelOpnd * getLabelOpndFromLabelName(const std::string &label_name);
@@ -960,12 +971,26 @@ private:
     // maps a variable name to the var pointer
     // unique vars are unique to the entire program
     // general vars must be unique within the same scope, but can be redefined across scopes
-    typedef std::map<std::string, CISA_GEN_VAR *> GenDeclNameToVarMap;
+    // the text parser looks every operand up here, so these are hashed
+    typedef std::unordered_map<std::string, CISA_GEN_VAR *> GenDeclNameToVarMap;
     std::vector<GenDeclNameToVarMap> m_GenNamedVarMap;
     GenDeclNameToVarMap m_UniqueNamedVarMap;
 
-    std::map<std::string, VISA_LabelOpnd *> m_label_name_to_index_map;
-    std::map<std::string, VISA_LabelOpnd *> m_funcName_to_labelID_map;
+    // While an inline asm fragment is parsed, variables created through the
+    // builder API can also be referred to by the names getVarName() prints for
+    // them. The map is extended lazily with the variables created since the
+    // last lookup.
+    bool m_inlineAsmMode;
+    GenDeclNameToVarMap m_DefaultNamedVarMap;
+    size_t m_defaultNamedVarCount;
+    size_t m_defaultNamedAddrCount;
+    size_t m_defaultNamedPredCount;
+    size_t m_defaultNamedSurfaceCount;
+    size_t m_defaultNamedSamplerCount;
+    void updateDefaultNamedVarMap();
+
+    std::unordered_map<std::string, VISA_LabelOpnd *> m_label_name_to_index_map;
+    std::unordered_map<std::string, VISA_LabelOpnd *> m_funcName_to_labelID_map;
 
     char errorMessage[MAX_ERROR_MSG_LEN];
 
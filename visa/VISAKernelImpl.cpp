@@ -34,6 +34,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "JitterDataStruct.h"
 #include "VISAKernel.h"
 #include "Timer.h"
+#include "CompileTrace.h"
 #include "FlowGraph.h"
 #include "BuildIR.h"
 #include "BuildCISAIR.h"
@@ -124,6 +125,9 @@ int VISAKernelImpl::calculateTotalInputSize()
 
 int VISAKernelImpl::compileFastPath()
 {
+    CompileTrace::setKernel(getName());
+    CompileTrace::Scope traceCompile("vISA", "Compile");
+
     int status = VISA_SUCCESS;
     if (getIsKernel())
     {
@@ -521,6 +525,7 @@ void VISAKernelImpl::initCompilerStats()
     m_compilerStats.Init("IsLocalRA", CompilerStats::type_bool);
     m_compilerStats.Init("IsHybridRA", CompilerStats::type_bool);
     m_compilerStats.Init("IsGlobalRA", CompilerStats::type_bool);
+    m_compilerStats.Init("IsLinearScanRA", CompilerStats::type_bool);
 #endif // COMPILER_STATS_ENABLE
 }
 
@@ -7603,8 +7608,7 @@ unsigned long VISAKernelImpl::writeInToCisaBinaryBuffer(const void * value, int
 
 VISA_LabelOpnd* VISAKernelImpl::getLabelOperandFromFunctionName(std::string name)
 {
-    std::map<std::string, VISA_LabelOpnd *>::iterator it;
-    it = m_funcName_to_labelID_map.find(name);
+    auto it = m_funcName_to_labelID_map.find(name);
     if(m_funcName_to_labelID_map.end() == it)
     {
         return NULL;
@@ -7615,8 +7619,7 @@ VISA_LabelOpnd* VISAKernelImpl::getLabelOperandFromFunctionName(std::string name
 }
 unsigned int VISAKernelImpl::getLabelIdFromFunctionName(std::string name)
 {
-    std::map<std::string, VISA_LabelOpnd *>::iterator it;
-    it = m_funcName_to_labelID_map.find(name);
+    auto it = m_funcName_to_labelID_map.find(name);
     if(m_funcName_to_labelID_map.end() == it)
     {
         return INVALID_LABEL_ID;
@@ -7644,6 +7647,16 @@ CISA_GEN_VAR * VISAKernelImpl::getDeclFromName(const std::string &name)
             return it->second;
         }
     }
+
+    if (m_inlineAsmMode)
+    {
+        updateDefaultNamedVarMap();
+        auto it = m_DefaultNamedVarMap.find(name);
+        if (it != m_DefaultNamedVarMap.end())
+        {
+            return it->second;
+        }
+    }
     return NULL;
 }
 
@@ -7685,10 +7698,61 @@ void VISAKernelImpl::popIndexMapScopeLevel()
     m_GenNamedVarMap.pop_back();
 }
 
+/// beginInlineAsm() - prepares the kernel for parsing an inline asm fragment
+/// into it. Variables declared by the fragment are scoped to it.
+void VISAKernelImpl::beginInlineAsm()
+{
+    MUST_BE_TRUE(IS_VISA_BOTH_PATH, "inline asm needs the vISA variable lists");
+    m_inlineAsmMode = true;
+    pushIndexMapScopeLevel();
+}
+
+void VISAKernelImpl::endInlineAsm()
+{
+    popIndexMapScopeLevel();
+    m_inlineAsmMode = false;
+}
+
+void VISAKernelImpl::updateDefaultNamedVarMap()
+{
+    for (; m_defaultNamedVarCount < m_var_info_list.size(); ++m_defaultNamedVarCount)
+    {
+        CISA_GEN_VAR* decl = m_var_info_list[m_defaultNamedVarCount];
+        m_DefaultNamedVarMap[getVarName((VISA_GenVar*)decl)] = decl;
+        if (m_defaultNamedVarCount < m_num_pred_vars)
+        {
+            auto predefId = mapExternalToInternalPreDefVar((int)m_defaultNamedVarCount);
+            if (predefId != PreDefinedVarsInternal::VAR_LAST)
+            {
+                m_DefaultNamedVarMap[getPredefinedVarString(predefId)] = decl;
+            }
+        }
+    }
+    for (; m_defaultNamedAddrCount < m_addr_info_list.size(); ++m_defaultNamedAddrCount)
+    {
+        CISA_GEN_VAR* decl = m_addr_info_list[m_defaultNamedAddrCount];
+        m_DefaultNamedVarMap[getVarName((VISA_AddrVar*)decl)] = decl;
+    }
+    for (; m_defaultNamedPredCount < m_pred_info_list.size(); ++m_defaultNamedPredCount)
+    {
+        CISA_GEN_VAR* decl = m_pred_info_list[m_defaultNamedPredCount];
+        m_DefaultNamedVarMap[getVarName((VISA_PredVar*)decl)] = decl;
+    }
+    for (; m_defaultNamedSurfaceCount < m_surface_info_list.size(); ++m_defaultNamedSurfaceCount)
+    {
+        CISA_GEN_VAR* decl = m_surface_info_list[m_defaultNamedSurfaceCount];
+        m_DefaultNamedVarMap[getVarName((VISA_SurfaceVar*)decl)] = decl;
+    }
+    for (; m_defaultNamedSamplerCount < m_sampler_info_list.size(); ++m_defaultNamedSamplerCount)
+    {
+        CISA_GEN_VAR* decl = m_sampler_info_list[m_defaultNamedSamplerCount];
+        m_DefaultNamedVarMap[getVarName((VISA_SamplerVar*)decl)] = decl;
+    }
+}
+
 unsigned int VISAKernelImpl::getIndexFromLabelName(const std::string &name)
 {
-    std::map<std::string, VISA_LabelOpnd *>::iterator it;
-    it = m_label_name_to_index_map.find(name);
+    auto it = m_label_name_to_index_map.find(name);
     if(m_label_name_to_index_map.end() == it)
     {
         return CISA_INVALID_VAR_ID;
@@ -7700,8 +7764,7 @@ unsigned int VISAKernelImpl::getIndexFromLabelName(const std::string &name)
 
 VISA_LabelOpnd* VISAKernelImpl::getLabelOpndFromLabelName(const std::string &name)
 {
-    std::map<std::string, VISA_LabelOpnd *>::iterator it;
-    it = m_label_name_to_index_map.find(name);
+    auto it = m_label_name_to_index_map.find(name);
     if(m_label_name_to_index_map.end() == it)
     {
         return NULL;
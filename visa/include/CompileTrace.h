@@ -0,0 +1,115 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#ifndef _COMPILE_TRACE_H_
+#define _COMPILE_TRACE_H_
+
+#include <atomic>
+
+// Hierarchical compile-time trace shared by IGC and vISA.
+//
+// Every span records its begin time, duration, nesting depth, thread and the
+// kernel/SIMD/retry context active on that thread. Spans are buffered per
+// thread and written either as Chrome trace JSON (load it in chrome://tracing
+// or Perfetto) or as a compact binary log.
+//
+// Tracing is off unless enable() has been called; all entry points check
+// isEnabled() first so a disabled trace costs a single load and branch.
+//
+//   CompileTrace::Scope S("vISA", "Optimizer");
+//
+// Span names must nest per thread; end() closes the innermost open span with
+// a matching name.
+namespace CompileTrace
+{
+    enum Format
+    {
+        FORMAT_CHROME_JSON = 0,
+        FORMAT_BINARY      = 1,
+    };
+
+    // Set once by enable(); read concurrently by every compiling thread.
+    extern std::atomic<bool> g_traceEnabled;
+
+    inline bool isEnabled() { return g_traceEnabled.load(std::memory_order_acquire); }
+
+    // Opens path for writing and turns tracing on for the whole process.
+    void enable(const char* path, Format format);
+
+    // Per-thread context attached to the spans that begin afterwards.
+    void setKernel(const char* name);
+    void setSimd(unsigned simdSize);
+    void setRetry(unsigned retryId);
+
+    void begin(const char* category, const char* name);
+    void end(const char* name);
+
+    // Writes out the spans completed so far on the calling thread.
+    void flush();
+
+    // Traces the enclosing block; a null name makes it a no-op.
+    class Scope
+    {
+    public:
+        Scope(const char* category, const char* name) :
+            m_name(isEnabled() ? name : nullptr)
+        {
+            if (m_name)
+            {
+                begin(category, m_name);
+            }
+        }
+        ~Scope()
+        {
+            if (m_name)
+            {
+                end(m_name);
+            }
+        }
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        const char* m_name;
+    };
+
+    // Sets the kernel context for the lifetime of the object and restores
+    // the previous one afterwards.
+    class KernelScope
+    {
+    public:
+        KernelScope(const char* name, unsigned simdSize, unsigned retryId);
+        ~KernelScope();
+    private:
+        KernelScope(const KernelScope&) = delete;
+        KernelScope& operator=(const KernelScope&) = delete;
+        bool m_active;
+        const char* m_prevKernel;
+        unsigned m_prevSimd;
+        unsigned m_prevRetry;
+    };
+}
+
+#endif
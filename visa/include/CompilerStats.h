@@ -135,6 +135,9 @@ public:
     // Increase value of floating point statistic.
     inline void IncreaseF64(const std::string& name, double value, int simd=0);
 
+    // Raise value of integer statistic to the given one if it is larger.
+    inline void MaxI64(const std::string& name, int64_t value, int simd=0);
+
     // Get value of a flag. Returns false if not found.
     inline bool GetFlag(const std::string& name, int simd=0) const;
 
@@ -176,6 +179,10 @@ void CompilerStats::Link(CompilerStats& sharedData)
 void CompilerStats::MergeStats(CompilerStats& from, int simd)
 {
 #if COMPILER_STATS_ENABLE
+    if (!IsEnabled() || !from.IsEnabled())
+    {
+        return;
+    }
     for (auto elem : from.m_pState->m_Stats)
     {
         auto name = elem.first;
@@ -364,6 +371,35 @@ void CompilerStats::IncreaseF64(const std::string& name, double value, int simd)
 #endif // COMPILER_STATS_ENABLE
 }
 
+// Raise value of integer statistic to the given one if it is larger.
+// If statistic does not exist, create new one.
+void CompilerStats::MaxI64(const std::string& name, int64_t value, int simd)
+{
+#if COMPILER_STATS_ENABLE
+    if (IsEnabled())
+    {
+        auto f = m_pState->m_Stats.find(name);
+        if (f == m_pState->m_Stats.end())
+        {
+            if (!m_pState->m_CollectOnlyInitialized)
+            {
+                Statistic& s = PrivateInit(name, Statistic::type_int64, simd);
+                s[simd].int64_value = value;
+            }
+        }
+        else
+        {
+            Statistic& s = f->second;
+            assert(s.type == Statistic::type_int64);
+            if (value > s[simd].int64_value)
+            {
+                s[simd].int64_value = value;
+            }
+        }
+    }
+#endif // COMPILER_STATS_ENABLE
+}
+
 // Get value of a flag. Returns false if not found.
 bool CompilerStats::GetFlag(const std::string& name, int simd) const
 {
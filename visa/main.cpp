@@ -454,8 +454,6 @@ void* allocCodeBlock(size_t sz)
 
 #ifndef DLL_MODE
 
-extern int CISAparse();
-
 void parseWrapper(const char *fileName, int argc, const char *argv[], Options &opt)
 {
     vISA::Mem_Manager cisaBinaryMem(4194304);
@@ -516,15 +514,6 @@ void parseWrapper(const char *fileName, int argc, const char *argv[], Options &o
         {
             files_parsed[file_names.front()] = true;
         }
-        //
-        // parser takes pBuilder to create G4_INST inst list
-        //
-        if (!cisa_builder->openCISAParsingFile( file_names.front().c_str(),"r"))
-        {
-            printf("ERROR: Can not open file %s!\n", file_names.front().c_str());
-            exit(1);                        // make the tool quit in error case
-        }
-
         std::string::size_type testNameEnd = file_names.front().find_last_of(".");
         std::string::size_type testNameStart = file_names.front().find_last_of("\\");
 
@@ -539,16 +528,22 @@ void parseWrapper(const char *fileName, int argc, const char *argv[], Options &o
             testName = file_names.front();
 
         CISAdebug = 0;
-        int fail;
-        // remove new programming rule option
-
-        fail = CISAparse();
-        cisa_builder->closeCISAParsingFile();
-        if (fail)
+        FILE* isaasmFile = fopen(file_names.front().c_str(), "r");
+        if (!isaasmFile)
         {
-            printf("Error during parsing: CISAparse() exited with exit code %d\n", fail);
+            printf("ERROR: Could not open file %s!\n", file_names.front().c_str());
             exit(1);
         }
+        fclose(isaasmFile);
+
+        //
+        // parser takes pBuilder to create G4_INST inst list
+        //
+        if (cisa_builder->ParseVISAText(file_names.front()) != VISA_SUCCESS)
+        {
+            printf("ERROR: Failed to parse file %s!\n", file_names.front().c_str());
+            exit(1);                        // make the tool quit in error case
+        }
 
         file_names.pop_front();
     }
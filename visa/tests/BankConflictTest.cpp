@@ -0,0 +1,109 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Checks which adjacent instructions the post-RA bank conflict reduction may
+// reorder. A mad depends on the cr0 rounding and denorm modes without naming
+// cr0, so it must not trade places with a cr0 write; independent mads may.
+
+#include <cstdio>
+
+#include "visaBuilder_interface.h"
+#include "Common_ISA.h"
+#include "Common_ISA_util.h"
+#include "Common_ISA_framework.h"
+#include "VISAKernel.h"
+#include "BuildIR.h"
+#include "Optimizer.h"
+
+using namespace vISA;
+
+static G4_INST* createMad(IR_Builder* builder, G4_Declare* dst, G4_Declare* src0,
+    G4_Declare* src1, G4_Declare* src2)
+{
+    auto src = [builder](G4_Declare* dcl)
+    {
+        return builder->createSrcRegRegion(Mod_src_undef, Direct, dcl->getRegVar(), 0, 0,
+            builder->getRegionStride1(), Type_F);
+    };
+    return builder->createInternalInst(nullptr, G4_mad, nullptr, false, 8,
+        builder->createDst(dst->getRegVar(), 0, 0, 1, Type_F), src(src0), src(src1), src(src2),
+        InstOpt_NoOpt);
+}
+
+static int check(const char* what, bool actual, bool expected)
+{
+    if (actual != expected)
+    {
+        printf("FAIL: %s\n", what);
+        return 1;
+    }
+    return 0;
+}
+
+int main()
+{
+    VISABuilder* visaBuilder = nullptr;
+    VISA_WA_TABLE waTable;
+    if (CreateVISABuilder(visaBuilder, vISA_3D, VISA_BUILDER_GEN, GENX_SKL, 0, nullptr, &waTable) != VISA_SUCCESS)
+    {
+        printf("FAIL: could not create the builder\n");
+        return 1;
+    }
+    VISAKernel* kernel = nullptr;
+    visaBuilder->AddKernel(kernel, "bank_conflict");
+    IR_Builder* builder = static_cast<VISAKernelImpl*>(kernel)->getIRBuilder();
+
+    G4_Declare* vars[8];
+    for (auto& var : vars)
+    {
+        var = builder->createTempVar(8, Type_F, Any);
+    }
+    G4_INST* mad = createMad(builder, vars[0], vars[1], vars[2], vars[3]);
+    G4_INST* otherMad = createMad(builder, vars[4], vars[5], vars[6], vars[7]);
+    G4_INST* dependentMad = createMad(builder, vars[4], vars[0], vars[6], vars[7]);
+
+    // mov (1) cr0.0<1>:ud 0x30:ud {NoMask}
+    G4_DstRegRegion* cr0 = builder->createDst(builder->phyregpool.getCr0Reg(), 0, 0, 1, Type_UD);
+    G4_INST* setMode = builder->createMov(1, cr0, builder->createImm(0x30, Type_UD),
+        InstOpt_WriteEnable, false);
+
+    int failures = 0;
+    failures += check("mad moved after a cr0 write",
+        Optimizer::canSwapAdjacentInsts(mad, setMode), false);
+    failures += check("mad moved before a cr0 write",
+        Optimizer::canSwapAdjacentInsts(setMode, mad), false);
+    failures += check("dependent mads reordered",
+        Optimizer::canSwapAdjacentInsts(mad, dependentMad), false);
+    failures += check("independent mads not reordered",
+        Optimizer::canSwapAdjacentInsts(mad, otherMad), true);
+
+    DestroyVISABuilder(visaBuilder);
+    if (failures == 0)
+    {
+        printf("PASS\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
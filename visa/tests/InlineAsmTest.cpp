@@ -0,0 +1,71 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Compiles a kernel whose body is a single-line inline asm fragment. The
+// fragment has no trailing newline, as inline asm strings usually don't.
+
+#include <cstdio>
+#include <string>
+
+#include "visaBuilder_interface.h"
+#include "common.h"
+
+int main()
+{
+    VISABuilder* builder = nullptr;
+    VISA_WA_TABLE waTable;
+    if (CreateVISABuilder(builder, vISA_3D, VISA_BUILDER_BOTH, GENX_SKL, 0, nullptr, &waTable) != VISA_SUCCESS)
+    {
+        printf("FAIL: could not create the builder\n");
+        return 1;
+    }
+
+    VISAKernel* kernel = nullptr;
+    VISA_GenVar* dst = nullptr;
+    builder->AddKernel(kernel, "inline_asm");
+    kernel->CreateVISAGenVar(dst, "dst", 16, ISA_TYPE_UD, ALIGN_GRF);
+
+    std::string asmText = "mov (M1, 16) " + kernel->getVarName(dst) + "(0,0)<1> 0x1:ud";
+    int failures = 0;
+    if (builder->ParseVISAInlineAsm(kernel, asmText) != VISA_SUCCESS)
+    {
+        printf("FAIL: parsing \"%s\"\n", asmText.c_str());
+        ++failures;
+    }
+    kernel->AppendVISACFRetInst(nullptr, vISA_EMASK_M1, EXEC_SIZE_1);
+    if (failures == 0 && builder->Compile("") != VISA_SUCCESS)
+    {
+        printf("FAIL: compiling the kernel\n");
+        ++failures;
+    }
+
+    DestroyVISABuilder(builder);
+    if (failures == 0)
+    {
+        printf("PASS\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Parses vISA text on two threads at once. Each thread reads back the text of
+// its own kernel with its own builders, so any parser state shared between
+// the threads shows up as a failed parse or compile.
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "visaBuilder_interface.h"
+#include "common.h"
+
+static const int numIterations = 50;
+
+// Builds a kernel that writes `value` through the builder API and returns its
+// vISA text.
+static bool writeKernelText(const std::string& name, unsigned value,
+    std::string& header, std::string& body)
+{
+    VISABuilder* builder = nullptr;
+    VISA_WA_TABLE waTable;
+    if (CreateVISABuilder(builder, vISA_ASM_WRITER, VISA_BUILDER_BOTH, GENX_SKL, 0, nullptr, &waTable) != VISA_SUCCESS)
+    {
+        return false;
+    }
+
+    VISAKernel* kernel = nullptr;
+    VISA_GenVar* dst = nullptr;
+    VISA_VectorOpnd* dstOpnd = nullptr;
+    VISA_VectorOpnd* srcOpnd = nullptr;
+    builder->AddKernel(kernel, name.c_str());
+    kernel->CreateVISAGenVar(dst, "dst", 16, ISA_TYPE_UD, ALIGN_GRF);
+    kernel->CreateVISADstOperand(dstOpnd, dst, 1, 0, 0);
+    kernel->CreateVISAImmediate(srcOpnd, &value, ISA_TYPE_UD);
+    kernel->AppendVISADataMovementInst(ISA_MOV, nullptr, false, vISA_EMASK_M1, EXEC_SIZE_16, dstOpnd, srcOpnd);
+    kernel->AppendVISACFRetInst(nullptr, vISA_EMASK_M1, EXEC_SIZE_1);
+
+    bool ok = builder->WriteVISAHeader() == VISA_SUCCESS;
+    header = builder->GetAsmTextHeaderStream().str();
+    body = builder->GetAsmTextStream().str();
+    DestroyVISABuilder(builder);
+    return ok && !body.empty();
+}
+
+static void parseLoop(const std::string& header, const std::string& body,
+    std::atomic<int>& failures)
+{
+    for (int i = 0; i < numIterations; i++)
+    {
+        VISABuilder* builder = nullptr;
+        VISA_WA_TABLE waTable;
+        if (CreateVISABuilder(builder, vISA_ASM_READER, VISA_BUILDER_BOTH, GENX_SKL, 0, nullptr, &waTable) != VISA_SUCCESS)
+        {
+            ++failures;
+            return;
+        }
+        if (builder->ParseVISAText(header, body, "") != VISA_SUCCESS ||
+            builder->GetVISAKernel() == nullptr ||
+            builder->Compile("") != VISA_SUCCESS)
+        {
+            ++failures;
+        }
+        DestroyVISABuilder(builder);
+    }
+}
+
+int main()
+{
+    std::string header0, body0, header1, body1;
+    if (!writeKernelText("kernel0", 0x11, header0, body0) ||
+        !writeKernelText("kernel1", 0x22, header1, body1))
+    {
+        printf("FAIL: could not write the kernel text\n");
+        return 1;
+    }
+
+    std::atomic<int> failures(0);
+    std::thread t0(parseLoop, std::cref(header0), std::cref(body0), std::ref(failures));
+    std::thread t1(parseLoop, std::cref(header1), std::cref(body1), std::ref(failures));
+    t0.join();
+    t1.join();
+
+    if (failures != 0)
+    {
+        printf("FAIL: %d of %d parses failed\n", failures.load(), 2 * numIterations);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}